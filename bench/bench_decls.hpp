@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "bench_utils.hpp"
+
+namespace humpty::bench {
+
+bool run_split_bench(const BenchOptions& options, std::vector<Measurement>& results, std::string& error);
+bool run_join_bench(const BenchOptions& options, std::vector<Measurement>& results, std::string& error);
+bool run_hash_bench(const BenchOptions& options, std::vector<Measurement>& results, std::string& error);
+bool run_manifest_bench(const BenchOptions& options, std::vector<Measurement>& results, std::string& error);
+
+}  // namespace humpty::bench
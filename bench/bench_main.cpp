@@ -0,0 +1,164 @@
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "bench_decls.hpp"
+
+namespace {
+
+bool parse_size(std::string_view raw, std::uint64_t& out_size) {
+    std::uint64_t multiplier = 1;
+    if (!raw.empty()) {
+        const char suffix = static_cast<char>(std::toupper(static_cast<unsigned char>(raw.back())));
+        if (suffix == 'K' || suffix == 'M' || suffix == 'G') {
+            multiplier = suffix == 'K' ? 1024ULL : suffix == 'M' ? 1024ULL * 1024 : 1024ULL * 1024 * 1024;
+            raw.remove_suffix(1);
+        }
+    }
+    if (raw.empty()) {
+        return false;
+    }
+    std::uint64_t value = 0;
+    for (const char c : raw) {
+        if (!std::isdigit(static_cast<unsigned char>(c)) ||
+            value > (std::numeric_limits<std::uint64_t>::max() - 9) / 10) {
+            return false;
+        }
+        value = (value * 10) + static_cast<std::uint64_t>(c - '0');
+    }
+    if (value == 0 || value > std::numeric_limits<std::uint64_t>::max() / multiplier) {
+        return false;
+    }
+    out_size = value * multiplier;
+    return true;
+}
+
+// Comma-separated sizes, each in bytes or with a K/M/G suffix.
+bool parse_list(std::string_view raw, std::vector<std::uint64_t>& out_values) {
+    std::vector<std::uint64_t> values;
+    while (!raw.empty()) {
+        const auto comma = raw.find(',');
+        std::uint64_t value = 0;
+        if (!parse_size(raw.substr(0, comma), value)) {
+            return false;
+        }
+        values.push_back(value);
+        raw = comma == std::string_view::npos ? std::string_view{} : raw.substr(comma + 1);
+    }
+    if (values.empty()) {
+        return false;
+    }
+    out_values = std::move(values);
+    return true;
+}
+
+bool run_case(std::string_view name,
+              const humpty::bench::BenchOptions& options,
+              std::vector<humpty::bench::Measurement>& results,
+              std::string& error) {
+    if (name == "split") {
+        return humpty::bench::run_split_bench(options, results, error);
+    }
+    if (name == "join") {
+        return humpty::bench::run_join_bench(options, results, error);
+    }
+    if (name == "hash") {
+        return humpty::bench::run_hash_bench(options, results, error);
+    }
+    if (name == "manifest") {
+        return humpty::bench::run_manifest_bench(options, results, error);
+    }
+    if (name == "all") {
+        return humpty::bench::run_split_bench(options, results, error) &&
+               humpty::bench::run_join_bench(options, results, error) &&
+               humpty::bench::run_hash_bench(options, results, error) &&
+               humpty::bench::run_manifest_bench(options, results, error);
+    }
+    error = "Unknown bench case: " + std::string(name);
+    return false;
+}
+
+constexpr const char* kUsage =
+    "Usage: humpty_bench [--case|-c <all|split|join|hash|manifest>] [--sizes <list>] [--chunk-sizes <list>]\n"
+    "        [--threads <list>] [--chunk-counts <list>] [--iterations <n>] [--dir <dir>] [--output|-o <file>]\n"
+    "Lists are comma-separated, sizes in bytes or with a K/M/G suffix.\n"
+    "defaults: sizes 64M,256M; chunk sizes 1M,16M; threads 1,4; chunk counts 1000,100000; iterations 5;\n"
+    "          dir <temp>/humpty-bench; JSON results go to stdout\n";
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    humpty::bench::BenchOptions options;
+    options.work_dir = std::filesystem::temp_directory_path() / "humpty-bench";
+    std::string case_name = "all";
+    std::string output_path;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view token = argv[i];
+        const bool has_value = (i + 1) < argc;
+        if ((token == "--case" || token == "-c") && has_value) {
+            case_name = argv[++i];
+            continue;
+        }
+        if (token == "--sizes" && has_value && parse_list(argv[++i], options.file_sizes)) {
+            continue;
+        }
+        if (token == "--chunk-sizes" && has_value && parse_list(argv[++i], options.chunk_sizes)) {
+            continue;
+        }
+        if (token == "--threads" && has_value && parse_list(argv[++i], options.thread_counts)) {
+            continue;
+        }
+        if (token == "--chunk-counts" && has_value && parse_list(argv[++i], options.chunk_counts)) {
+            continue;
+        }
+        std::uint64_t iterations = 0;
+        if (token == "--iterations" && has_value && parse_size(argv[++i], iterations)) {
+            options.iterations = static_cast<std::size_t>(iterations);
+            continue;
+        }
+        if (token == "--dir" && has_value) {
+            options.work_dir = argv[++i];
+            continue;
+        }
+        if ((token == "--output" || token == "-o") && has_value) {
+            output_path = argv[++i];
+            continue;
+        }
+        if (token == "--help" || token == "-h") {
+            std::cout << kUsage;
+            return 0;
+        }
+        std::cerr << "Invalid or incomplete argument: " << token << "\n" << kUsage;
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.work_dir, ec);
+    if (ec) {
+        std::cerr << "Failed to create " << options.work_dir.string() << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    std::vector<humpty::bench::Measurement> results;
+    std::string error;
+    if (!run_case(case_name, options, results, error)) {
+        std::cerr << case_name << "_bench failed: " << error << "\n";
+        return 1;
+    }
+
+    if (output_path.empty()) {
+        humpty::bench::write_json(std::cout, options, results);
+        return 0;
+    }
+    std::ofstream out(output_path, std::ios::trunc);
+    humpty::bench::write_json(out, options, results);
+    if (!out.good()) {
+        std::cerr << "Failed writing " << output_path << "\n";
+        return 1;
+    }
+    return 0;
+}
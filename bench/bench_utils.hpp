@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "test_utils.hpp"
+
+namespace humpty::bench {
+
+struct BenchOptions {
+    std::vector<std::uint64_t> file_sizes = {64ULL * 1024 * 1024, 256ULL * 1024 * 1024};
+    std::vector<std::uint64_t> chunk_sizes = {1024ULL * 1024, 16ULL * 1024 * 1024};
+    std::vector<std::uint64_t> thread_counts = {1, 4};
+    // Entries in the manifests the manifest benchmark writes and reads.
+    std::vector<std::uint64_t> chunk_counts = {1000, 100000};
+    std::size_t iterations = 5;
+    std::filesystem::path work_dir;
+};
+
+// One benchmarked configuration. Every iteration processes `bytes` bytes in
+// `chunks` chunks; `params` holds JSON values keyed by parameter name.
+struct Measurement {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> params;
+    std::uint64_t bytes = 0;
+    std::uint64_t chunks = 0;
+    std::vector<double> seconds;
+};
+
+inline std::string json_string(std::string_view text) {
+    std::string out = "\"";
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+}
+
+// Runs `body` once untimed to warm the page cache, then `iterations` timed
+// times. `setup` runs before each call of `body`, outside the timing.
+inline bool time_iterations(std::size_t iterations,
+                            const std::function<bool(std::string& error)>& setup,
+                            const std::function<bool(std::string& error)>& body,
+                            std::vector<double>& seconds,
+                            std::string& error) {
+    seconds.clear();
+    for (std::size_t i = 0; i <= iterations; ++i) {
+        if (setup && !setup(error)) {
+            return false;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        if (!body(error)) {
+            return false;
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (i != 0) {
+            seconds.push_back(elapsed.count());
+        }
+    }
+    return true;
+}
+
+// Nearest-rank percentile of sorted samples.
+inline double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+// Writes the measurements as one JSON document. Throughput uses the mean
+// iteration time; latencies are per iteration, in milliseconds.
+inline void write_json(std::ostream& out, const BenchOptions& options, const std::vector<Measurement>& results) {
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"iterations\": " << options.iterations << ",\n  \"results\": [";
+    for (std::size_t r = 0; r < results.size(); ++r) {
+        const auto& result = results[r];
+        auto sorted = result.seconds;
+        std::sort(sorted.begin(), sorted.end());
+        const double mean =
+            sorted.empty() ? 0.0 : std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size());
+        const double per_second = mean > 0.0 ? 1.0 / mean : 0.0;
+
+        out << (r == 0 ? "\n" : ",\n") << "    {\"name\": " << json_string(result.name) << ", \"params\": {";
+        for (std::size_t p = 0; p < result.params.size(); ++p) {
+            out << (p == 0 ? "" : ", ") << json_string(result.params[p].first) << ": " << result.params[p].second;
+        }
+        out << "},\n     \"bytes\": " << result.bytes << ", \"chunks\": " << result.chunks
+            << ", \"gb_per_s\": " << static_cast<double>(result.bytes) * per_second / 1e9
+            << ", \"chunks_per_s\": " << static_cast<double>(result.chunks) * per_second << ",\n"
+            << "     \"latency_ms\": {\"min\": " << percentile(sorted, 0.0) * 1e3
+            << ", \"p50\": " << percentile(sorted, 0.50) * 1e3 << ", \"p90\": " << percentile(sorted, 0.90) * 1e3
+            << ", \"p99\": " << percentile(sorted, 0.99) * 1e3 << ", \"max\": " << percentile(sorted, 1.0) * 1e3
+            << ", \"mean\": " << mean * 1e3 << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Writes the deterministic test input of `size` bytes to `path` unless a
+// file of that size is already there.
+inline bool prepare_input(const std::filesystem::path& path, std::uint64_t size, std::string& error) {
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) == size && !ec) {
+        return true;
+    }
+    return humpty::tests::write_bytes(path, humpty::tests::make_test_data(static_cast<std::size_t>(size)), error);
+}
+
+}  // namespace humpty::bench
@@ -0,0 +1,53 @@
+#include "bench_decls.hpp"
+
+#include <span>
+#include <string>
+
+#include "models/manifest.hpp"
+#include "services/checksums.hpp"
+
+namespace humpty::bench {
+
+// Hashes an in-memory buffer of each file size, so the numbers exclude I/O.
+// fnv1a64() is called directly; the others go through Hasher as splits do.
+bool run_hash_bench(const BenchOptions& options, std::vector<Measurement>& results, std::string& error) {
+    constexpr models::ChecksumAlgorithm kAlgorithms[] = {
+        models::ChecksumAlgorithm::Fnv1a64,
+        models::ChecksumAlgorithm::Crc32c,
+        models::ChecksumAlgorithm::Xxh64,
+    };
+
+    for (const auto size : options.file_sizes) {
+        const auto data = humpty::tests::make_test_data(static_cast<std::size_t>(size));
+        const auto view = std::span<const std::byte>(data);
+        for (const auto algorithm : kAlgorithms) {
+            Measurement measurement{"hash",
+                                    {{"size", std::to_string(size)},
+                                     {"algorithm", json_string(models::checksum_algorithm_name(algorithm))}},
+                                    size,
+                                    1,
+                                    {}};
+            // Keeps the result live so the hashing is not optimized out.
+            volatile std::uint64_t sink = 0;
+            if (!time_iterations(
+                    options.iterations, {},
+                    [&](std::string&) {
+                        if (algorithm == models::ChecksumAlgorithm::Fnv1a64) {
+                            sink = sink + services::fnv1a64(view);
+                        } else {
+                            services::Hasher hasher(algorithm);
+                            hasher.update(view);
+                            sink = sink + hasher.hex().size();
+                        }
+                        return true;
+                    },
+                    measurement.seconds, error)) {
+                return false;
+            }
+            results.push_back(std::move(measurement));
+        }
+    }
+    return true;
+}
+
+}  // namespace humpty::bench
@@ -0,0 +1,86 @@
+#include "bench_decls.hpp"
+
+#include <filesystem>
+#include <span>
+#include <string>
+
+#include "models/binary_manifest.hpp"
+#include "models/manifest.hpp"
+#include "services/checksums.hpp"
+
+namespace humpty::bench {
+namespace {
+
+constexpr std::uint64_t kManifestChunkSize = 4 * 1024 * 1024;
+
+// A complete manifest of `chunk_count` chunks with xxh64 digests, shaped
+// like one a split writes.
+models::Manifest make_manifest(std::uint64_t chunk_count, bool binary) {
+    models::Manifest manifest;
+    manifest.format_version = binary ? "2" : "1";
+    manifest.source_file_name = "bench.bin";
+    manifest.chunk_size = kManifestChunkSize;
+    manifest.checksum_algorithm = models::ChecksumAlgorithm::Xxh64;
+    manifest.chunks.reserve(static_cast<std::size_t>(chunk_count));
+    services::ChunkDigestCombiner combiner;
+    for (std::uint64_t i = 0; i < chunk_count; ++i) {
+        models::Chunk chunk;
+        chunk.index = static_cast<std::uint32_t>(i);
+        chunk.offset = i * kManifestChunkSize;
+        chunk.size = kManifestChunkSize;
+        chunk.file_name = models::make_chunk_filename(manifest.source_file_name, chunk.index);
+        services::Hasher hasher(manifest.checksum_algorithm);
+        hasher.update(std::as_bytes(std::span(&i, 1)));
+        chunk.checksum = hasher.hex();
+        combiner.add(chunk.offset, chunk.size, chunk.checksum);
+        manifest.chunks.push_back(std::move(chunk));
+    }
+    manifest.source_size = chunk_count * kManifestChunkSize;
+    manifest.source_checksum = combiner.hex();
+    return manifest;
+}
+
+}  // namespace
+
+bool run_manifest_bench(const BenchOptions& options, std::vector<Measurement>& results, std::string& error) {
+    const auto path = options.work_dir / "bench.manifest";
+    for (const auto chunk_count : options.chunk_counts) {
+        for (const bool binary : {false, true}) {
+            const auto manifest = make_manifest(chunk_count, binary);
+            const auto format = json_string(models::manifest_format_name(
+                binary ? models::ManifestFormat::Binary : models::ManifestFormat::Text));
+
+            Measurement write{"manifest_write", {{"chunks", std::to_string(chunk_count)}, {"format", format}}, 0,
+                              chunk_count, {}};
+            if (!time_iterations(
+                    options.iterations, {},
+                    [&](std::string& run_error) { return models::write_manifest(manifest, path, run_error); },
+                    write.seconds, error)) {
+                return false;
+            }
+            write.bytes = std::filesystem::file_size(path);
+
+            Measurement read{"manifest_read", write.params, write.bytes, chunk_count, {}};
+            if (!time_iterations(
+                    options.iterations, {},
+                    [&](std::string& run_error) {
+                        const auto loaded = models::read_manifest(path, run_error);
+                        if (loaded && loaded->chunks.size() != chunk_count) {
+                            run_error = "Manifest read back the wrong number of chunks.";
+                            return false;
+                        }
+                        return loaded.has_value();
+                    },
+                    read.seconds, error)) {
+                return false;
+            }
+            results.push_back(std::move(write));
+            results.push_back(std::move(read));
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return true;
+}
+
+}  // namespace humpty::bench
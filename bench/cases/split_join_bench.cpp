@@ -0,0 +1,111 @@
+#include "bench_decls.hpp"
+
+#include <filesystem>
+#include <string>
+
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+
+namespace humpty::bench {
+namespace {
+
+std::filesystem::path input_path(const BenchOptions& options, std::uint64_t size) {
+    return options.work_dir / ("input-" + std::to_string(size) + ".bin");
+}
+
+services::SplitRequest make_split_request(const std::filesystem::path& input,
+                                          const std::filesystem::path& output_dir,
+                                          std::uint64_t chunk_size,
+                                          std::uint64_t thread_count) {
+    services::SplitRequest request;
+    request.input_file = input;
+    request.output_dir = output_dir;
+    request.chunk_size_bytes = chunk_size;
+    request.thread_count = static_cast<std::size_t>(thread_count);
+    return request;
+}
+
+bool remove_path(const std::filesystem::path& path, std::string& error) {
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+    if (ec) {
+        error = "Failed to remove " + path.string() + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool run_split_bench(const BenchOptions& options, std::vector<Measurement>& results, std::string& error) {
+    for (const auto size : options.file_sizes) {
+        const auto input = input_path(options, size);
+        if (!prepare_input(input, size, error)) {
+            return false;
+        }
+        for (const auto chunk_size : options.chunk_sizes) {
+            for (const auto threads : options.thread_counts) {
+                const auto output_dir = options.work_dir / "split";
+                const auto request = make_split_request(input, output_dir, chunk_size, threads);
+                services::SplitResult split;
+                Measurement measurement{"split",
+                                        {{"size", std::to_string(size)},
+                                         {"chunk_size", std::to_string(chunk_size)},
+                                         {"threads", std::to_string(threads)}},
+                                        size,
+                                        (size + chunk_size - 1) / chunk_size,
+                                        {}};
+                if (!time_iterations(
+                        options.iterations, [&](std::string& setup_error) { return remove_path(output_dir, setup_error); },
+                        [&](std::string& run_error) { return services::split_file(request, split, run_error); },
+                        measurement.seconds, error)) {
+                    return false;
+                }
+                results.push_back(std::move(measurement));
+            }
+        }
+    }
+    return remove_path(options.work_dir / "split", error);
+}
+
+bool run_join_bench(const BenchOptions& options, std::vector<Measurement>& results, std::string& error) {
+    const auto output_dir = options.work_dir / "join-chunks";
+    const auto output_file = options.work_dir / "joined.bin";
+    for (const auto size : options.file_sizes) {
+        const auto input = input_path(options, size);
+        if (!prepare_input(input, size, error)) {
+            return false;
+        }
+        for (const auto chunk_size : options.chunk_sizes) {
+            services::SplitResult split;
+            if (!remove_path(output_dir, error) ||
+                !services::split_file(make_split_request(input, output_dir, chunk_size, 1), split, error)) {
+                return false;
+            }
+            for (const auto threads : options.thread_counts) {
+                services::JoinRequest request;
+                request.manifest_path = split.manifest_path;
+                request.output_file = output_file;
+                request.thread_count = static_cast<std::size_t>(threads);
+                services::JoinResult joined;
+                Measurement measurement{"join",
+                                        {{"size", std::to_string(size)},
+                                         {"chunk_size", std::to_string(chunk_size)},
+                                         {"threads", std::to_string(threads)}},
+                                        size,
+                                        split.chunk_count,
+                                        {}};
+                if (!time_iterations(
+                        options.iterations, [&](std::string& setup_error) { return remove_path(output_file, setup_error); },
+                        [&](std::string& run_error) { return services::join_file(request, joined, run_error); },
+                        measurement.seconds, error)) {
+                    return false;
+                }
+                results.push_back(std::move(measurement));
+            }
+        }
+    }
+    return remove_path(output_dir, error) && remove_path(output_file, error);
+}
+
+}  // namespace humpty::bench
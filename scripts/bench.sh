@@ -0,0 +1,5 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+xmake build humpty_bench
+xmake run humpty_bench "$@"
@@ -7,3 +7,17 @@ xmake run humpty_tests --case splitter
 xmake run humpty_tests --case joiner
 xmake run humpty_tests --case roundtrip
 xmake run humpty_tests --case urandom
+xmake run humpty_tests --case parallel
+xmake run humpty_tests --case checksums
+xmake run humpty_tests --case manifest
+xmake run humpty_tests --case resume
+xmake run humpty_tests --case incremental
+xmake run humpty_tests --case cdc
+xmake run humpty_tests --case store
+xmake run humpty_tests --case codec
+xmake run humpty_tests --case stdio
+xmake run humpty_tests --case range
+xmake run humpty_tests --case verify
+xmake run humpty_tests --case stats
+xmake run humpty_tests --case progress
+xmake run humpty_tests --case buffer
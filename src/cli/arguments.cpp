@@ -8,12 +8,57 @@ namespace humpty::cli {
 std::string usage_text(std::string_view program_name) {
     std::ostringstream out;
     out << "Usage:\n"
-        << "  " << program_name << " split <input-file> [--out|-o <dir>] --chunk-size|-c <size>\n"
-        << "  " << program_name << " join <manifest-file> --output|-o <file> [--no-verify|-n]\n"
+        << "  " << program_name << " split <input-file|-> [--out|-o <dir>] --chunk-size|-c <size> [--threads|-t <n>]\n"
+        << "        [--source-digest stream|combined] [--checksum fnv1a64|crc32c|xxh64] [--io stream|mmap|uring]\n"
+        << "        [--queue-depth <n>] [--pipeline] [--direct]\n"
+        << "        [--direct-buffer <size>] [--manifest-format text|binary] [--no-checksum] [--resume]\n"
+        << "        [--incremental] [--cdc] [--cdc-min <size>] [--cdc-max <size>] [--store <dir>]\n"
+        << "        [--codec none|lz4] [--name <name>] [--stats] [--progress]\n"
+        << "  " << program_name << " join <manifest-file> --output|-o <file|-> [--no-verify|-n] [--threads|-t <n>]\n"
+        << "        [--io stream|mmap|uring] [--queue-depth <n>] [--pipeline] [--direct] [--direct-buffer <size>]\n"
+        << "        [--resume] [--stats] [--progress]\n"
+        << "  " << program_name << " cat <manifest-file> [--range <offset>:<length>] [--verify]\n"
+        << "  " << program_name << " verify <manifest-file> [--threads|-t <n>] [--source]\n"
         << "  " << program_name << " --help\n"
         << "  " << program_name << " --version\n\n"
         << "split defaults:\n"
-        << "  out dir: ./<input-filename>-humpty\n\n"
+        << "  input -: read standard input until it ends (one thread; size recorded at the end)\n"
+        << "  name: the input's file name, or stdin (names the manifest and chunk files)\n"
+        << "  out dir: ./<name>-humpty\n"
+        << "  threads: 1, at most 1024 (chunks are written concurrently when > 1)\n"
+        << "  source digest: stream (parallel splits re-read the input in order; combined is built from chunk checksums)\n"
+        << "  checksum: fnv1a64 (crc32c and xxh64 hash faster and are recorded in the manifest)\n"
+        << "  io: stream (mmap maps the input in large windows; uring queues async reads and writes)\n"
+        << "  queue depth: 32, at most 4096 (in-flight requests with --io uring)\n"
+        << "  --pipeline: overlap reading, hashing and writing through a ring of buffers\n"
+        << "  --direct: bypass the page cache with O_DIRECT; direct buffer: 4M (multiple of 4K)\n"
+        << "  manifest format: text (binary writes a memory-mappable v2 manifest)\n"
+        << "  --no-checksum: skip hashing; chunks are copied inside the kernel\n"
+        << "  --resume: keep the chunks the partial manifest of an interrupted split records\n"
+        << "  --incremental: rewrite only the chunks that differ from the manifest in the out dir\n"
+        << "  --cdc: cut chunks where the content says so; --chunk-size is the average\n"
+        << "  cdc min / max: chunk size / 4 and chunk size * 4\n"
+        << "  --store: write chunks once, by digest, into a shared chunk store (uses xxh64)\n"
+        << "  codec: none (lz4 compresses each chunk file in 1M blocks; join decodes them)\n"
+        << "  --stats: print phase times and I/O counters as JSON on stderr\n"
+        << "  --progress: show bytes, throughput and time left on stderr, updated every second\n\n"
+        << "join defaults:\n"
+        << "  threads: 1, at most 1024 (chunks are copied to their offsets concurrently when > 1)\n"
+        << "  io: stream (mmap maps chunks and the output in large windows; uring queues async reads and writes)\n"
+        << "  queue depth: 32, at most 4096 (in-flight requests with --io uring)\n"
+        << "  --pipeline: overlap reading, verifying and writing, opening the next chunk early\n"
+        << "  --direct: bypass the page cache with O_DIRECT; direct buffer: 4M (multiple of 4K)\n"
+        << "  --no-verify: chunks are copied inside the kernel where supported\n"
+        << "  --resume: skip the chunks recorded in <output>.checkpoint by an interrupted join\n"
+        << "  output -: write to standard output in order; the summary goes to stderr\n"
+        << "  --stats: print phase times and I/O counters as JSON on stderr\n"
+        << "  --progress: show bytes, throughput and time left on stderr, updated every second\n\n"
+        << "cat defaults:\n"
+        << "  range: the whole source, written to stdout from the chunk files that cover it\n"
+        << "  --verify: check each touched chunk's checksum over the whole chunk first\n\n"
+        << "verify defaults:\n"
+        << "  threads: 1, at most 1024 (chunks are checked concurrently when > 1; every bad chunk is reported)\n"
+        << "  --source: also check the whole-file digest (a stream digest needs 1 thread)\n\n"
         << "Chunk size examples:\n"
         << "  1048576   (bytes)\n"
         << "  1M        (MiB)\n"
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
 
+#include "models/binary_manifest.hpp"
+#include "models/manifest.hpp"
+#include "services/direct_io.hpp"
+#include "services/file_io.hpp"
+
 namespace humpty::cli {
 
 enum class CommandType {
@@ -12,6 +18,8 @@ enum class CommandType {
     Version,
     Split,
     Join,
+    Cat,
+    Verify,
     Invalid,
 };
 
@@ -19,18 +27,63 @@ struct SplitArgs {
     std::string input_path;
     std::string output_dir;
     std::uint64_t chunk_size_bytes = 0;
+    std::string source_name;
+    std::size_t thread_count = 1;
+    humpty::models::SourceDigest source_digest = humpty::models::SourceDigest::Stream;
+    humpty::models::ChecksumAlgorithm checksum_algorithm = humpty::models::ChecksumAlgorithm::Fnv1a64;
+    services::IoEngine io_engine = services::IoEngine::Stream;
+    std::size_t queue_depth = 32;
+    bool pipelined = false;
+    bool direct_io = false;
+    std::size_t direct_buffer_size = services::kDefaultDirectBufferSize;
+    humpty::models::ManifestFormat manifest_format = humpty::models::ManifestFormat::Text;
+    bool compute_checksums = true;
+    bool resume = false;
+    bool incremental = false;
+    bool content_defined = false;
+    std::uint64_t cdc_min_bytes = 0;
+    std::uint64_t cdc_max_bytes = 0;
+    std::string chunk_store;
+    humpty::models::ChunkCodec codec = humpty::models::ChunkCodec::None;
+    bool print_stats = false;
+    bool show_progress = false;
 };
 
 struct JoinArgs {
     std::string manifest_path;
     std::string output_path;
     bool verify_checksums = true;
+    std::size_t thread_count = 1;
+    services::IoEngine io_engine = services::IoEngine::Stream;
+    std::size_t queue_depth = 32;
+    bool pipelined = false;
+    bool direct_io = false;
+    std::size_t direct_buffer_size = services::kDefaultDirectBufferSize;
+    bool resume = false;
+    bool print_stats = false;
+    bool show_progress = false;
+};
+
+struct CatArgs {
+    std::string manifest_path;
+    std::uint64_t offset = 0;
+    // Zero reads to the end of the source.
+    std::uint64_t length = 0;
+    bool verify_checksums = false;
+};
+
+struct VerifyArgs {
+    std::string manifest_path;
+    std::size_t thread_count = 1;
+    bool verify_source = false;
 };
 
 struct ParsedArgs {
     CommandType command = CommandType::Invalid;
     std::optional<SplitArgs> split;
     std::optional<JoinArgs> join;
+    std::optional<CatArgs> cat;
+    std::optional<VerifyArgs> verify;
     std::string error;
     bool show_usage = false;
 };
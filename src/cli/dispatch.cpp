@@ -1,25 +1,134 @@
+#include <algorithm>
+#include <array>
+#include <iomanip>
 #include <iostream>
+#include <span>
+#include <sstream>
+#include <vector>
 
 #include "dispatch.hpp"
 #include "arguments.hpp"
 #include "parsing.hpp"
 #include "services/joiner.hpp"
+#include "services/range_reader.hpp"
 #include "services/splitter.hpp"
+#include "services/verifier.hpp"
 
 namespace humpty::cli {
 namespace {
 
 constexpr const char* kVersion = "0.1.0";
 
+void print_stats(std::ostream& out, const services::TransferStats& stats) {
+    const auto flags = out.flags();
+    out << std::fixed << std::setprecision(6) << "{\"seconds\": {\"total\": " << stats.total_seconds
+        << ", \"setup\": " << stats.setup_seconds << ", \"data\": " << stats.data_seconds
+        << ", \"finish\": " << stats.finish_seconds << ", \"hash\": " << stats.hash_seconds
+        << ", \"manifest\": " << stats.manifest_seconds << "}, \"calls\": {\"read\": " << stats.read_calls
+        << ", \"write\": " << stats.write_calls << ", \"open\": " << stats.open_calls
+        << "}, \"bytes\": {\"read\": " << stats.bytes_read << ", \"written\": " << stats.bytes_written
+        << "}, \"peak_buffer_bytes\": " << stats.peak_buffer_bytes << "}\n";
+    out.flags(flags);
+}
+
+std::string format_bytes(double bytes) {
+    constexpr std::array<const char*, 5> kUnits{"B", "KiB", "MiB", "GiB", "TiB"};
+    std::size_t unit = 0;
+    while (bytes >= 1024.0 && unit + 1 < kUnits.size()) {
+        bytes /= 1024.0;
+        ++unit;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << bytes << ' ' << kUnits[unit];
+    return out.str();
+}
+
+// Redraws one status line on stderr while a split or join runs.
+class ProgressLine {
+public:
+    services::ProgressCallback callback() {
+        return [this](const services::Progress& progress) { draw(progress); };
+    }
+
+    // Ends a line a failed transfer left open, so the error starts on its own.
+    void end() {
+        if (open_) {
+            std::cerr << '\n';
+            open_ = false;
+        }
+    }
+
+private:
+    void draw(const services::Progress& progress) {
+        std::ostringstream line;
+        line << '\r';
+        if (progress.bytes_total != 0) {
+            line << std::fixed << std::setprecision(1)
+                 << 100.0 * static_cast<double>(progress.bytes_done) / static_cast<double>(progress.bytes_total)
+                 << "% " << format_bytes(static_cast<double>(progress.bytes_done)) << " / "
+                 << format_bytes(static_cast<double>(progress.bytes_total));
+        } else {
+            line << format_bytes(static_cast<double>(progress.bytes_done));
+        }
+        line << ", chunk " << progress.chunks_done;
+        if (progress.chunks_total != 0) {
+            line << " / " << progress.chunks_total;
+        }
+        const double rate = progress.finished ? progress.average_bytes_per_second : progress.current_bytes_per_second;
+        line << ", " << format_bytes(rate) << "/s";
+        if (progress.finished) {
+            line << std::fixed << std::setprecision(1) << " in " << progress.elapsed_seconds << "s";
+        } else if (progress.stalled_seconds >= 1.0) {
+            line << ", stalled " << static_cast<std::uint64_t>(progress.stalled_seconds) << "s";
+        } else if (progress.eta_seconds >= 0.0) {
+            line << ", eta " << static_cast<std::uint64_t>(progress.eta_seconds + 0.5) << "s";
+        }
+        // Clears what is left of a longer previous line.
+        line << "\x1b[K";
+        if (progress.finished) {
+            line << '\n';
+        }
+        std::cerr << line.str() << std::flush;
+        open_ = !progress.finished;
+    }
+
+    bool open_ = false;
+};
+
 int dispatch_split(const SplitArgs& args) {
     services::SplitRequest request;
     request.input_file = args.input_path;
     request.output_dir = args.output_dir;
     request.chunk_size_bytes = args.chunk_size_bytes;
+    request.source_name = args.source_name;
+    request.thread_count = args.thread_count;
+    request.source_digest = args.source_digest;
+    request.checksum_algorithm = args.checksum_algorithm;
+    request.io_engine = args.io_engine;
+    request.queue_depth = args.queue_depth;
+    request.pipelined = args.pipelined;
+    request.direct_io = args.direct_io;
+    request.direct_buffer_size = args.direct_buffer_size;
+    request.manifest_format = args.manifest_format;
+    request.compute_checksums = args.compute_checksums;
+    request.resume = args.resume;
+    request.incremental = args.incremental;
+    request.content_defined = args.content_defined;
+    request.cdc_min_bytes = args.cdc_min_bytes;
+    request.cdc_max_bytes = args.cdc_max_bytes;
+    request.chunk_store = args.chunk_store;
+    request.codec = args.codec;
+    request.collect_stats = args.print_stats;
+    ProgressLine progress;
+    if (args.show_progress) {
+        request.progress = progress.callback();
+    }
 
     services::SplitResult result;
     std::string error;
-    if (!services::split_file(request, result, error)) {
+    const bool ok = services::split_file(request, result, error);
+    progress.end();
+    if (!ok) {
         std::cerr << "split failed: " << error << "\n";
         return 2;
     }
@@ -28,6 +137,22 @@ int dispatch_split(const SplitArgs& args) {
               << "manifest: " << result.manifest_path.string() << "\n"
               << "chunks: " << result.chunk_count << "\n"
               << "bytes: " << result.total_bytes << "\n";
+    if (args.resume) {
+        std::cout << "resumed chunks: " << result.chunks_resumed << "\n";
+    }
+    if (args.incremental) {
+        std::cout << "changed chunks: " << result.chunks_changed << "\n";
+    }
+    if (!args.chunk_store.empty()) {
+        std::cout << "stored chunks: " << result.chunks_changed << "\n"
+                  << "reused chunks: " << result.chunk_count - result.chunks_changed << "\n";
+    }
+    if (args.codec != humpty::models::ChunkCodec::None) {
+        std::cout << "stored bytes: " << result.stored_bytes << "\n";
+    }
+    if (args.print_stats) {
+        print_stats(std::cerr, result.stats);
+    }
     return 0;
 }
 
@@ -36,16 +161,105 @@ int dispatch_join(const JoinArgs& args) {
     request.manifest_path = args.manifest_path;
     request.output_file = args.output_path;
     request.verify_checksums = args.verify_checksums;
+    request.thread_count = args.thread_count;
+    request.io_engine = args.io_engine;
+    request.queue_depth = args.queue_depth;
+    request.pipelined = args.pipelined;
+    request.direct_io = args.direct_io;
+    request.direct_buffer_size = args.direct_buffer_size;
+    request.resume = args.resume;
+    request.collect_stats = args.print_stats;
+    ProgressLine progress;
+    if (args.show_progress) {
+        request.progress = progress.callback();
+    }
 
     services::JoinResult result;
     std::string error;
-    if (!services::join_file(request, result, error)) {
+    const bool ok = services::join_file(request, result, error);
+    progress.end();
+    for (const auto& warning : result.warnings) {
+        std::cerr << "join warning: " << warning << "\n";
+    }
+    if (!ok) {
         std::cerr << "join failed: " << error << "\n";
         return 2;
     }
 
-    std::cout << "join complete\n"
-              << "bytes: " << result.total_bytes_written << "\n";
+    // The summary must not end up in the joined data.
+    auto& out = services::is_standard_stream(request.output_file) ? std::cerr : std::cout;
+    out << "join complete\n"
+        << "bytes: " << result.total_bytes_written << "\n";
+    if (args.resume) {
+        out << "resumed chunks: " << result.chunks_resumed << "\n";
+    }
+    if (args.print_stats) {
+        print_stats(std::cerr, result.stats);
+    }
+    return 0;
+}
+
+int dispatch_cat(const CatArgs& args) {
+    constexpr std::size_t kCatBufferSize = 1024 * 1024;
+
+    services::RangeReader reader;
+    std::string error;
+    if (!reader.open(args.manifest_path, args.verify_checksums, services::RangeReader::kDefaultOpenChunks, error)) {
+        std::cerr << "cat failed: " << error << "\n";
+        return 2;
+    }
+    if (args.offset > reader.size() || args.length > reader.size() - args.offset) {
+        std::cerr << "cat failed: Range exceeds the source size (" << reader.size() << " bytes).\n";
+        return 2;
+    }
+
+    services::FileHandle output;
+    if (!output.open_standard_output()) {
+        std::cerr << "cat failed: Failed to open standard output.\n";
+        return 2;
+    }
+    std::vector<std::byte> buffer(kCatBufferSize);
+    std::uint64_t offset = args.offset;
+    const std::uint64_t end = args.length == 0 ? reader.size() : args.offset + args.length;
+    while (offset < end) {
+        const auto view = std::span<std::byte>(
+            buffer.data(), static_cast<std::size_t>(std::min<std::uint64_t>(end - offset, buffer.size())));
+        if (!reader.read(offset, view, error)) {
+            std::cerr << "cat failed: " << error << "\n";
+            return 2;
+        }
+        if (!output.write_all(view)) {
+            std::cerr << "cat failed: Failed writing standard output.\n";
+            return 2;
+        }
+        offset += view.size();
+    }
+    return 0;
+}
+
+int dispatch_verify(const VerifyArgs& args) {
+    services::VerifyRequest request;
+    request.manifest_path = args.manifest_path;
+    request.thread_count = args.thread_count;
+    request.verify_source = args.verify_source;
+
+    services::VerifyResult result;
+    std::string error;
+    const bool ok = services::verify_chunk_set(request, result, error);
+    for (const auto& fault : result.faults) {
+        std::cerr << "bad chunk " << fault.index << " (" << fault.file_name << "): " << fault.reason << "\n";
+    }
+    if (!ok) {
+        std::cerr << "verify failed: " << error << "\n";
+        return 2;
+    }
+
+    std::cout << "verify complete\n"
+              << "chunks: " << result.chunks_checked << "\n"
+              << "bytes read: " << result.bytes_read << "\n";
+    if (args.verify_source) {
+        std::cout << "source: " << (result.source_verified ? "verified" : "no checksum recorded") << "\n";
+    }
     return 0;
 }
 
@@ -65,6 +279,10 @@ int run(int argc, char* argv[]) {
         return dispatch_split(*parsed.split);
     case CommandType::Join:
         return dispatch_join(*parsed.join);
+    case CommandType::Cat:
+        return dispatch_cat(*parsed.cat);
+    case CommandType::Verify:
+        return dispatch_verify(*parsed.verify);
     case CommandType::Invalid:
         std::cerr << "Error: " << parsed.error << "\n\n"
                   << usage_text(argc > 0 ? argv[0] : "humpty");
@@ -9,6 +9,12 @@
 namespace humpty::cli {
 namespace {
 
+// Far more workers than any machine has cores only adds threads and buffers
+// to thrash over.
+constexpr std::size_t kMaxThreadCount = 1024;
+// io_uring refuses rings with more entries than this.
+constexpr std::size_t kMaxQueueDepth = 4096;
+
 bool parse_size_bytes(std::string_view raw, std::uint64_t& out_size) {
     if (raw.empty()) {
         return false;
@@ -50,6 +56,43 @@ bool parse_size_bytes(std::string_view raw, std::uint64_t& out_size) {
     return true;
 }
 
+bool parse_count(std::string_view raw, std::size_t max_count, std::size_t& out_count) {
+    if (raw.empty()) {
+        return false;
+    }
+
+    std::size_t value = 0;
+    for (char c : raw) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) {
+            return false;
+        }
+        const std::size_t digit = static_cast<std::size_t>(c - '0');
+        if (value > (std::numeric_limits<std::size_t>::max() - digit) / 10) {
+            return false;
+        }
+        value = (value * 10) + digit;
+    }
+
+    if (value == 0 || value > max_count) {
+        return false;
+    }
+
+    out_count = value;
+    return true;
+}
+
+// "<offset>:<length>"; the offset may be zero, the length may not.
+bool parse_range(std::string_view raw, std::uint64_t& offset, std::uint64_t& length) {
+    const auto colon = raw.find(':');
+    if (colon == std::string_view::npos) {
+        return false;
+    }
+    const auto offset_text = raw.substr(0, colon);
+    offset = 0;
+    return (offset_text == "0" || parse_size_bytes(offset_text, offset)) &&
+           parse_size_bytes(raw.substr(colon + 1), length);
+}
+
 }  // namespace
 
 ParsedArgs parse_arguments(int argc, char* argv[]) {
@@ -77,6 +120,7 @@ ParsedArgs parse_arguments(int argc, char* argv[]) {
     if (command == "split") {
         SplitArgs split;
         bool saw_input_positional = false;
+        bool saw_checksum = false;
 
         for (int i = 2; i < argc; ++i) {
             const std::string_view token = argv[i];
@@ -104,7 +148,124 @@ ParsedArgs parse_arguments(int argc, char* argv[]) {
                 split.chunk_size_bytes = size;
                 continue;
             }
-            if (!token.empty() && token.front() != '-' && !saw_input_positional) {
+            if ((token == "--threads" || token == "-t") && (i + 1) < argc) {
+                if (!parse_count(argv[++i], kMaxThreadCount, split.thread_count)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --threads/-t. Use a positive integer up to 1024.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--source-digest" && (i + 1) < argc) {
+                if (!models::parse_source_digest(argv[++i], split.source_digest)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --source-digest. Use stream or combined.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--checksum" && (i + 1) < argc) {
+                saw_checksum = true;
+                if (!models::parse_checksum_algorithm(argv[++i], split.checksum_algorithm)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --checksum. Use fnv1a64, crc32c or xxh64.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--codec" && (i + 1) < argc) {
+                if (!models::parse_chunk_codec(argv[++i], split.codec)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --codec. Use none or lz4.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--io" && (i + 1) < argc) {
+                if (!services::parse_io_engine(argv[++i], split.io_engine)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --io. Use stream, mmap or uring.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--queue-depth" && (i + 1) < argc) {
+                if (!parse_count(argv[++i], kMaxQueueDepth, split.queue_depth)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --queue-depth. Use a positive integer up to 4096.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--pipeline") {
+                split.pipelined = true;
+                continue;
+            }
+            if (token == "--direct") {
+                split.direct_io = true;
+                continue;
+            }
+            if (token == "--direct-buffer" && (i + 1) < argc) {
+                std::uint64_t size = 0;
+                if (!parse_size_bytes(argv[++i], size) || size > std::numeric_limits<std::size_t>::max()) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --direct-buffer. Use a size in bytes, optionally with K/M/G suffix.";
+                    return parsed;
+                }
+                split.direct_buffer_size = static_cast<std::size_t>(size);
+                continue;
+            }
+            if (token == "--manifest-format" && (i + 1) < argc) {
+                if (!models::parse_manifest_format(argv[++i], split.manifest_format)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --manifest-format. Use text or binary.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--no-checksum") {
+                split.compute_checksums = false;
+                continue;
+            }
+            if (token == "--resume") {
+                split.resume = true;
+                continue;
+            }
+            if (token == "--stats") {
+                split.print_stats = true;
+                continue;
+            }
+            if (token == "--progress") {
+                split.show_progress = true;
+                continue;
+            }
+            if (token == "--incremental") {
+                split.incremental = true;
+                continue;
+            }
+            if (token == "--store" && (i + 1) < argc) {
+                split.chunk_store = argv[++i];
+                continue;
+            }
+            if (token == "--cdc") {
+                split.content_defined = true;
+                continue;
+            }
+            if ((token == "--cdc-min" || token == "--cdc-max") && (i + 1) < argc) {
+                std::uint64_t size = 0;
+                if (!parse_size_bytes(argv[++i], size)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid " + std::string(token) + ". Use a size in bytes, optionally with K/M/G suffix.";
+                    return parsed;
+                }
+                (token == "--cdc-min" ? split.cdc_min_bytes : split.cdc_max_bytes) = size;
+                continue;
+            }
+            if (token == "--name" && (i + 1) < argc) {
+                split.source_name = argv[++i];
+                continue;
+            }
+            if (!token.empty() && (token.front() != '-' || token == "-") && !saw_input_positional) {
                 split.input_path = std::string(token);
                 saw_input_positional = true;
                 continue;
@@ -120,8 +281,24 @@ ParsedArgs parse_arguments(int argc, char* argv[]) {
             parsed.error = "split requires <input-file> and --chunk-size/-c <bytes|K|M|G>.";
             return parsed;
         }
+        // The store names chunks by their xxh64 digest, so it picks that
+        // checksum unless another one was asked for.
+        if (!split.chunk_store.empty()) {
+            if (!saw_checksum) {
+                split.checksum_algorithm = models::ChecksumAlgorithm::Xxh64;
+            } else if (split.checksum_algorithm != models::ChecksumAlgorithm::Xxh64) {
+                parsed.command = CommandType::Invalid;
+                parsed.error = "--store names chunks by their xxh64 digest; use --checksum xxh64 or leave it out.";
+                return parsed;
+            }
+        }
         if (split.output_dir.empty()) {
-            const auto file_name = std::filesystem::path(split.input_path).filename().string();
+            auto file_name = std::filesystem::path(split.input_path).filename().string();
+            if (!split.source_name.empty()) {
+                file_name = split.source_name;
+            } else if (split.input_path == "-") {
+                file_name = "stdin";
+            }
             split.output_dir = "./" + file_name + "-humpty";
         }
 
@@ -149,6 +326,60 @@ ParsedArgs parse_arguments(int argc, char* argv[]) {
                 join.verify_checksums = false;
                 continue;
             }
+            if (token == "--pipeline") {
+                join.pipelined = true;
+                continue;
+            }
+            if (token == "--resume") {
+                join.resume = true;
+                continue;
+            }
+            if (token == "--stats") {
+                join.print_stats = true;
+                continue;
+            }
+            if (token == "--progress") {
+                join.show_progress = true;
+                continue;
+            }
+            if (token == "--direct") {
+                join.direct_io = true;
+                continue;
+            }
+            if (token == "--direct-buffer" && (i + 1) < argc) {
+                std::uint64_t size = 0;
+                if (!parse_size_bytes(argv[++i], size) || size > std::numeric_limits<std::size_t>::max()) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --direct-buffer. Use a size in bytes, optionally with K/M/G suffix.";
+                    return parsed;
+                }
+                join.direct_buffer_size = static_cast<std::size_t>(size);
+                continue;
+            }
+            if ((token == "--threads" || token == "-t") && (i + 1) < argc) {
+                if (!parse_count(argv[++i], kMaxThreadCount, join.thread_count)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --threads/-t. Use a positive integer up to 1024.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--io" && (i + 1) < argc) {
+                if (!services::parse_io_engine(argv[++i], join.io_engine)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --io. Use stream, mmap or uring.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--queue-depth" && (i + 1) < argc) {
+                if (!parse_count(argv[++i], kMaxQueueDepth, join.queue_depth)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --queue-depth. Use a positive integer up to 4096.";
+                    return parsed;
+                }
+                continue;
+            }
             if (!token.empty() && token.front() != '-' && !saw_manifest_positional) {
                 join.manifest_path = std::string(token);
                 saw_manifest_positional = true;
@@ -171,6 +402,96 @@ ParsedArgs parse_arguments(int argc, char* argv[]) {
         return parsed;
     }
 
+    if (command == "cat") {
+        CatArgs cat;
+        bool saw_manifest_positional = false;
+
+        for (int i = 2; i < argc; ++i) {
+            const std::string_view token = argv[i];
+            if (token == "--help" || token == "-h") {
+                parsed.command = CommandType::Help;
+                parsed.show_usage = true;
+                return parsed;
+            }
+            if (token == "--range" && (i + 1) < argc) {
+                if (!parse_range(argv[++i], cat.offset, cat.length)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --range. Use <offset>:<length>, each in bytes or with K/M/G suffix.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--verify") {
+                cat.verify_checksums = true;
+                continue;
+            }
+            if (!token.empty() && token.front() != '-' && !saw_manifest_positional) {
+                cat.manifest_path = std::string(token);
+                saw_manifest_positional = true;
+                continue;
+            }
+
+            parsed.command = CommandType::Invalid;
+            parsed.error = "Unknown or incomplete cat argument: " + std::string(token);
+            return parsed;
+        }
+
+        if (cat.manifest_path.empty()) {
+            parsed.command = CommandType::Invalid;
+            parsed.error = "cat requires <manifest-file>.";
+            return parsed;
+        }
+
+        parsed.command = CommandType::Cat;
+        parsed.cat = cat;
+        return parsed;
+    }
+
+    if (command == "verify") {
+        VerifyArgs verify;
+        bool saw_manifest_positional = false;
+
+        for (int i = 2; i < argc; ++i) {
+            const std::string_view token = argv[i];
+            if (token == "--help" || token == "-h") {
+                parsed.command = CommandType::Help;
+                parsed.show_usage = true;
+                return parsed;
+            }
+            if ((token == "--threads" || token == "-t") && (i + 1) < argc) {
+                if (!parse_count(argv[++i], kMaxThreadCount, verify.thread_count)) {
+                    parsed.command = CommandType::Invalid;
+                    parsed.error = "Invalid --threads/-t. Use a positive integer up to 1024.";
+                    return parsed;
+                }
+                continue;
+            }
+            if (token == "--source") {
+                verify.verify_source = true;
+                continue;
+            }
+            if (!token.empty() && token.front() != '-' && !saw_manifest_positional) {
+                verify.manifest_path = std::string(token);
+                saw_manifest_positional = true;
+                continue;
+            }
+
+            parsed.command = CommandType::Invalid;
+            parsed.error = "Unknown or incomplete verify argument: " + std::string(token);
+            return parsed;
+        }
+
+        if (verify.manifest_path.empty()) {
+            parsed.command = CommandType::Invalid;
+            parsed.error = "verify requires <manifest-file>.";
+            return parsed;
+        }
+
+        parsed.command = CommandType::Verify;
+        parsed.verify = verify;
+        return parsed;
+    }
+
     parsed.command = CommandType::Invalid;
     parsed.error = "Unknown command: " + std::string(command);
     return parsed;
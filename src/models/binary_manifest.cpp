@@ -0,0 +1,293 @@
+#include "models/binary_manifest.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace humpty::models {
+namespace {
+
+template <typename T>
+T load(const std::byte* data) {
+    T value{};
+    std::memcpy(&value, data, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+std::string format_hex_digest(std::uint64_t value, std::size_t digits) {
+    constexpr std::string_view kDigits = "0123456789abcdef";
+    std::string text(digits, '0');
+    for (std::size_t i = digits; i > 0; --i) {
+        text[i - 1] = kDigits[value & 0xF];
+        value >>= 4;
+    }
+    return text;
+}
+
+}  // namespace
+
+std::string_view manifest_format_name(ManifestFormat format) {
+    switch (format) {
+    case ManifestFormat::Text:
+        return "text";
+    case ManifestFormat::Binary:
+        return "binary";
+    }
+    return "text";
+}
+
+bool parse_manifest_format(std::string_view name, ManifestFormat& format) {
+    if (name == "text") {
+        format = ManifestFormat::Text;
+        return true;
+    }
+    if (name == "binary") {
+        format = ManifestFormat::Binary;
+        return true;
+    }
+    return false;
+}
+
+bool is_binary_manifest(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::array<char, kBinaryManifestMagic.size()> magic{};
+    in.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+    return in.gcount() == static_cast<std::streamsize>(magic.size()) &&
+           std::string_view(magic.data(), magic.size()) == kBinaryManifestMagic;
+}
+
+ManifestView::~ManifestView() {
+    close();
+}
+
+ManifestView::ManifestView(ManifestView&& other) noexcept {
+    *this = std::move(other);
+}
+
+ManifestView& ManifestView::operator=(ManifestView&& other) noexcept {
+    if (this != &other) {
+        close();
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mapping_length_ = std::exchange(other.mapping_length_, 0);
+        records_ = std::exchange(other.records_, nullptr);
+        strings_ = std::exchange(other.strings_, nullptr);
+        strings_size_ = std::exchange(other.strings_size_, 0);
+        chunk_count_ = std::exchange(other.chunk_count_, 0);
+        record_size_ = other.record_size_;
+        codec_ = other.codec_;
+        complete_ = other.complete_;
+        source_file_name_ = std::exchange(other.source_file_name_, {});
+        chunk_store_ = std::exchange(other.chunk_store_, {});
+        source_checksum_ = std::exchange(other.source_checksum_, {});
+        source_size_ = other.source_size_;
+        chunk_size_ = other.chunk_size_;
+        source_digest_ = other.source_digest_;
+        checksum_algorithm_ = other.checksum_algorithm_;
+    }
+    return *this;
+}
+
+bool ManifestView::open(const std::filesystem::path& path, std::string& error) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "Failed to open manifest: " + path.string();
+        return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(kBinaryManifestHeaderSize)) {
+        ::close(fd);
+        error = "Binary manifest is truncated: " + path.string();
+        return false;
+    }
+
+    const auto file_size = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "Failed to map manifest: " + path.string();
+        return false;
+    }
+    mapping_ = mapping;
+    mapping_length_ = file_size;
+
+    const auto* base = static_cast<const std::byte*>(mapping);
+    const bool header_ok = std::memcmp(base, kBinaryManifestMagic.data(), kBinaryManifestMagic.size()) == 0 &&
+                           load<std::uint32_t>(base + 8) == kBinaryManifestVersion &&
+                           load<std::uint32_t>(base + 12) == kBinaryManifestHeaderSize &&
+                           (load<std::uint32_t>(base + 16) == kBinaryManifestRecordSize ||
+                            load<std::uint32_t>(base + 16) == kBinaryManifestCodecRecordSize);
+    if (!header_ok) {
+        close();
+        error = "Unsupported binary manifest header: " + path.string();
+        return false;
+    }
+
+    const auto digest = load<std::uint8_t>(base + 20);
+    const auto algorithm = load<std::uint8_t>(base + 21);
+    const bool partial = (load<std::uint8_t>(base + 22) & kBinaryManifestPartial) != 0;
+    const auto codec = load<std::uint8_t>(base + 23);
+    const std::size_t record_size = load<std::uint32_t>(base + 16);
+    auto chunk_count = load<std::uint64_t>(base + 40);
+    const auto records_offset = load<std::uint64_t>(base + 48);
+    const auto strings_offset = load<std::uint64_t>(base + 56);
+    const auto strings_size = load<std::uint64_t>(base + 64);
+    const auto name_length = load<std::uint32_t>(base + 72);
+    const auto store_length = load<std::uint32_t>(base + 76);
+
+    const bool sections_ok =
+        digest <= static_cast<std::uint8_t>(SourceDigest::Combined) &&
+        algorithm <= static_cast<std::uint8_t>(ChecksumAlgorithm::Xxh64) &&
+        codec <= static_cast<std::uint8_t>(ChunkCodec::Lz4) &&
+        (codec == 0 || record_size == kBinaryManifestCodecRecordSize) &&
+        std::uint64_t{name_length} + store_length <= file_size - kBinaryManifestHeaderSize &&
+        records_offset >= kBinaryManifestHeaderSize + name_length + store_length && records_offset <= file_size &&
+        chunk_count <= (file_size - records_offset) / record_size && strings_offset <= file_size &&
+        strings_size <= file_size - strings_offset;
+    if (!sections_ok) {
+        close();
+        error = "Binary manifest sections exceed the file: " + path.string();
+        return false;
+    }
+
+    // Only whole records count; a torn final record is dropped.
+    if (partial) {
+        chunk_count = (file_size - records_offset) / record_size;
+    }
+
+    complete_ = !partial;
+    source_file_name_ = std::string_view(reinterpret_cast<const char*>(base + kBinaryManifestHeaderSize), name_length);
+    chunk_store_ = std::string_view(reinterpret_cast<const char*>(base + kBinaryManifestHeaderSize + name_length),
+                                    store_length);
+    records_ = base + records_offset;
+    strings_ = reinterpret_cast<const char*>(base + strings_offset);
+    strings_size_ = static_cast<std::size_t>(strings_size);
+    chunk_count_ = static_cast<std::size_t>(chunk_count);
+    record_size_ = record_size;
+    codec_ = static_cast<ChunkCodec>(codec);
+    source_digest_ = static_cast<SourceDigest>(digest);
+    checksum_algorithm_ = static_cast<ChecksumAlgorithm>(algorithm);
+    source_size_ = load<std::uint64_t>(base + 24);
+    chunk_size_ = load<std::uint64_t>(base + 32);
+
+    if (!string_at(load<std::uint32_t>(base + 80), load<std::uint32_t>(base + 84), source_checksum_)) {
+        close();
+        error = "Binary manifest string table is corrupt: " + path.string();
+        return false;
+    }
+
+    return true;
+}
+
+void ManifestView::close() {
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, mapping_length_);
+    }
+    mapping_ = nullptr;
+    mapping_length_ = 0;
+    records_ = nullptr;
+    strings_ = nullptr;
+    strings_size_ = 0;
+    chunk_count_ = 0;
+    source_file_name_ = {};
+    chunk_store_ = {};
+    source_checksum_ = {};
+}
+
+bool ManifestView::string_at(std::uint32_t offset, std::uint32_t length, std::string_view& out) const {
+    if (offset > strings_size_ || length > strings_size_ - offset) {
+        return false;
+    }
+    out = std::string_view(strings_ + offset, length);
+    return true;
+}
+
+bool ManifestView::chunk_at(std::size_t position, Chunk& chunk) const {
+    if (position >= chunk_count_) {
+        return false;
+    }
+
+    const std::byte* record = records_ + position * record_size_;
+    const auto flags = load<std::uint32_t>(record + 4);
+    const auto digest = load<std::uint64_t>(record + 24);
+    chunk.index = load<std::uint32_t>(record + 0);
+    chunk.offset = load<std::uint64_t>(record + 8);
+    chunk.size = load<std::uint64_t>(record + 16);
+    chunk.changed = (flags & kBinaryRecordChanged) != 0;
+    chunk.codec = ChunkCodec::None;
+    chunk.stored_size = 0;
+    if (record_size_ >= kBinaryManifestCodecRecordSize) {
+        const auto codec = static_cast<std::uint8_t>(flags >> 8);
+        if (codec > static_cast<std::uint8_t>(ChunkCodec::Lz4)) {
+            return false;
+        }
+        chunk.codec = static_cast<ChunkCodec>(codec);
+        chunk.stored_size = load<std::uint64_t>(record + 40);
+    }
+
+    if ((flags & kBinaryRecordRawDigest) != 0) {
+        chunk.checksum = format_hex_digest(digest, checksum_hex_digits(checksum_algorithm_));
+    } else if ((flags & kBinaryRecordStringChecksum) != 0) {
+        std::string_view checksum;
+        if (!string_at(static_cast<std::uint32_t>(digest), static_cast<std::uint32_t>(digest >> 32), checksum)) {
+            return false;
+        }
+        chunk.checksum.assign(checksum);
+    } else {
+        chunk.checksum.clear();
+    }
+
+    if ((flags & kBinaryRecordDerivedName) != 0) {
+        chunk.file_name = make_chunk_filename(source_file_name_, chunk.index);
+    } else if ((flags & kBinaryRecordStoreName) != 0) {
+        chunk.file_name = make_store_object_name(chunk.checksum, chunk.size);
+    } else {
+        std::string_view name;
+        if (!string_at(load<std::uint32_t>(record + 32), load<std::uint32_t>(record + 36), name)) {
+            return false;
+        }
+        chunk.file_name.assign(name);
+    }
+    return chunk.is_valid();
+}
+
+std::optional<Manifest> ManifestView::to_manifest(std::string& error) const {
+    Manifest manifest;
+    manifest.format_version = "2";
+    manifest.source_file_name.assign(source_file_name_);
+    manifest.chunk_store.assign(chunk_store_);
+    manifest.codec = codec_;
+    manifest.source_size = source_size_;
+    manifest.chunk_size = chunk_size_;
+    manifest.source_checksum.assign(source_checksum_);
+    manifest.source_digest = source_digest_;
+    manifest.checksum_algorithm = checksum_algorithm_;
+    manifest.complete = complete_;
+    manifest.chunks.resize(chunk_count_);
+
+    for (std::size_t i = 0; i < chunk_count_; ++i) {
+        if (!chunk_at(i, manifest.chunks[i])) {
+            error = "Invalid chunk entry in manifest.";
+            return std::nullopt;
+        }
+    }
+
+    if (!manifest.is_valid()) {
+        error = "Manifest failed validation.";
+        return std::nullopt;
+    }
+    return manifest;
+}
+
+}  // namespace humpty::models
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "models/chunk.hpp"
+#include "models/manifest.hpp"
+
+namespace humpty::models {
+
+// Version 2 manifests are little-endian binary files:
+//
+//   header   (kBinaryManifestHeaderSize bytes, starts with the magic)
+//   names    (the source file name, then any chunk store path, padded to
+//             8 bytes)
+//   records  (chunk_count fixed-size records, in manifest order)
+//   strings  (file names and any checksum that is not a plain hex digest,
+//             then the source checksum)
+//
+// A record holds the chunk index, offset, size, raw digest and a reference
+// into the string table. Chunk file names that follow make_chunk_filename()
+// are not stored at all, nor are chunk store names that follow
+// make_store_object_name(). A header flagged partial belongs to a split that
+// has not finished; its records run to the end of the file.
+constexpr std::string_view kBinaryManifestMagic = "HUMPTYM2";
+constexpr std::uint32_t kBinaryManifestVersion = 2;
+constexpr std::size_t kBinaryManifestHeaderSize = 96;
+constexpr std::size_t kBinaryManifestRecordSize = 40;
+// Manifests of encoded chunks use longer records that end with the chunk
+// file's stored size; the chunk's codec is kept in bits 8-15 of its flags.
+constexpr std::size_t kBinaryManifestCodecRecordSize = 48;
+
+constexpr std::uint8_t kBinaryManifestPartial = 1U << 0;
+constexpr std::uint32_t kBinaryRecordDerivedName = 1U << 0;
+constexpr std::uint32_t kBinaryRecordRawDigest = 1U << 1;
+constexpr std::uint32_t kBinaryRecordStringChecksum = 1U << 2;
+constexpr std::uint32_t kBinaryRecordChanged = 1U << 3;
+constexpr std::uint32_t kBinaryRecordStoreName = 1U << 4;
+
+enum class ManifestFormat {
+    Text,
+    Binary,
+};
+
+std::string_view manifest_format_name(ManifestFormat format);
+bool parse_manifest_format(std::string_view name, ManifestFormat& format);
+
+bool is_binary_manifest(const std::filesystem::path& path);
+
+// Read-only view of a memory-mapped version 2 manifest. Opening validates
+// the header and section bounds only; chunk_at() decodes a single record.
+class ManifestView {
+public:
+    ManifestView() = default;
+    ~ManifestView();
+
+    ManifestView(const ManifestView&) = delete;
+    ManifestView& operator=(const ManifestView&) = delete;
+    ManifestView(ManifestView&& other) noexcept;
+    ManifestView& operator=(ManifestView&& other) noexcept;
+
+    bool open(const std::filesystem::path& path, std::string& error);
+    void close();
+
+    [[nodiscard]] std::string_view source_file_name() const { return source_file_name_; }
+    [[nodiscard]] std::string_view chunk_store() const { return chunk_store_; }
+    [[nodiscard]] std::uint64_t source_size() const { return source_size_; }
+    [[nodiscard]] std::uint64_t chunk_size() const { return chunk_size_; }
+    [[nodiscard]] std::string_view source_checksum() const { return source_checksum_; }
+    [[nodiscard]] SourceDigest source_digest() const { return source_digest_; }
+    [[nodiscard]] ChecksumAlgorithm checksum_algorithm() const { return checksum_algorithm_; }
+    [[nodiscard]] ChunkCodec codec() const { return codec_; }
+    [[nodiscard]] std::size_t chunk_count() const { return chunk_count_; }
+    [[nodiscard]] bool complete() const { return complete_; }
+
+    // Returns false for an out-of-range position or a corrupt record.
+    bool chunk_at(std::size_t position, Chunk& chunk) const;
+
+    std::optional<Manifest> to_manifest(std::string& error) const;
+
+private:
+    bool string_at(std::uint32_t offset, std::uint32_t length, std::string_view& out) const;
+
+    void* mapping_ = nullptr;
+    std::size_t mapping_length_ = 0;
+    const std::byte* records_ = nullptr;
+    const char* strings_ = nullptr;
+    std::size_t strings_size_ = 0;
+    std::size_t chunk_count_ = 0;
+    std::size_t record_size_ = kBinaryManifestRecordSize;
+    std::string_view source_file_name_;
+    std::string_view chunk_store_;
+    std::string_view source_checksum_;
+    std::uint64_t source_size_ = 0;
+    std::uint64_t chunk_size_ = 0;
+    SourceDigest source_digest_ = SourceDigest::Stream;
+    ChecksumAlgorithm checksum_algorithm_ = ChecksumAlgorithm::Fnv1a64;
+    ChunkCodec codec_ = ChunkCodec::None;
+    bool complete_ = true;
+};
+
+}  // namespace humpty::models
@@ -1,18 +1,63 @@
 #include "models/chunk.hpp"
 
-#include <iomanip>
-#include <sstream>
+#include <array>
+#include <charconv>
 
 namespace humpty::models {
 
+std::string_view chunk_codec_name(ChunkCodec codec) {
+    switch (codec) {
+    case ChunkCodec::None:
+        return "none";
+    case ChunkCodec::Lz4:
+        return "lz4";
+    }
+    return "none";
+}
+
+bool parse_chunk_codec(std::string_view name, ChunkCodec& codec) {
+    if (name == "none") {
+        codec = ChunkCodec::None;
+        return true;
+    }
+    if (name == "lz4") {
+        codec = ChunkCodec::Lz4;
+        return true;
+    }
+    return false;
+}
+
 bool Chunk::is_valid() const {
     return !file_name.empty();
 }
 
 std::string make_chunk_filename(std::string_view base_name, std::uint32_t index, unsigned int width) {
-    std::ostringstream out;
-    out << base_name << ".part" << std::setw(static_cast<int>(width)) << std::setfill('0') << index;
-    return out.str();
+    std::array<char, 10> digits{};
+    const auto end = std::to_chars(digits.data(), digits.data() + digits.size(), index).ptr;
+    const auto digit_count = static_cast<std::size_t>(end - digits.data());
+    const std::size_t padding = (width > digit_count) ? width - digit_count : 0;
+
+    std::string name;
+    name.reserve(base_name.size() + 5 + padding + digit_count);
+    name.append(base_name);
+    name.append(".part");
+    name.append(padding, '0');
+    name.append(digits.data(), digit_count);
+    return name;
+}
+
+std::string make_store_object_name(std::string_view checksum, std::uint64_t size) {
+    std::array<char, 20> digits{};
+    const auto end = std::to_chars(digits.data(), digits.data() + digits.size(), size).ptr;
+
+    std::string name;
+    name.reserve(3 + checksum.size() + 1 + static_cast<std::size_t>(end - digits.data()));
+    name.append(checksum.substr(0, 2));
+    name.push_back('/');
+    name.append(checksum);
+    name.push_back('-');
+    name.append(digits.data(), end);
+    return name;
 }
 
 }  // namespace humpty::models
@@ -6,16 +6,37 @@
 
 namespace humpty::models {
 
+// How a chunk file is encoded. Lz4 files hold the chunk in independently
+// compressed blocks (see services/chunk_codec.hpp).
+enum class ChunkCodec : std::uint8_t {
+    None,
+    Lz4,
+};
+
+std::string_view chunk_codec_name(ChunkCodec codec);
+bool parse_chunk_codec(std::string_view name, ChunkCodec& codec);
+
 struct Chunk {
     std::uint32_t index = 0;
     std::uint64_t offset = 0;
     std::uint64_t size = 0;
     std::string file_name;
     std::string checksum;
+    // Set on chunks whose file an incremental or chunk-store split had to
+    // write; the others were already on disk.
+    bool changed = false;
+    ChunkCodec codec = ChunkCodec::None;
+    // Length of an encoded chunk file; `size` stays the length of the data.
+    std::uint64_t stored_size = 0;
 
     [[nodiscard]] bool is_valid() const;
+    // Expected length of the chunk file on disk.
+    [[nodiscard]] std::uint64_t file_size() const { return codec == ChunkCodec::None ? size : stored_size; }
 };
 
 std::string make_chunk_filename(std::string_view base_name, std::uint32_t index, unsigned int width = 4);
+// "<first two digest characters>/<digest>-<size>", the name of a chunk in a
+// content-addressed chunk store.
+std::string make_store_object_name(std::string_view checksum, std::uint64_t size);
 
 }  // namespace humpty::models
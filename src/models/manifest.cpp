@@ -1,201 +1,161 @@
 #include "models/manifest.hpp"
 
-#include <fstream>
-#include <iomanip>
-#include <limits>
-#include <set>
-#include <sstream>
+#include <algorithm>
 #include <string>
+#include <utility>
+
+#include "models/manifest_reader.hpp"
+#include "models/manifest_writer.hpp"
 
 namespace humpty::models {
-namespace {
 
-bool parse_u64(const std::string& token, std::uint64_t& value) {
-    if (token.empty()) {
-        return false;
+std::string_view source_digest_name(SourceDigest digest) {
+    switch (digest) {
+    case SourceDigest::Stream:
+        return "stream";
+    case SourceDigest::Combined:
+        return "combined";
     }
+    return "stream";
+}
 
-    std::uint64_t parsed = 0;
-    for (const char c : token) {
-        if (c < '0' || c > '9') {
-            return false;
-        }
-        const std::uint64_t digit = static_cast<std::uint64_t>(c - '0');
-        if (parsed > (std::numeric_limits<std::uint64_t>::max() - digit) / 10) {
-            return false;
-        }
-        parsed = (parsed * 10) + digit;
+bool parse_source_digest(std::string_view name, SourceDigest& digest) {
+    if (name == "stream") {
+        digest = SourceDigest::Stream;
+        return true;
     }
+    if (name == "combined") {
+        digest = SourceDigest::Combined;
+        return true;
+    }
+    return false;
+}
 
-    value = parsed;
-    return true;
+std::string_view checksum_algorithm_name(ChecksumAlgorithm algorithm) {
+    switch (algorithm) {
+    case ChecksumAlgorithm::Fnv1a64:
+        return "fnv1a64";
+    case ChecksumAlgorithm::Crc32c:
+        return "crc32c";
+    case ChecksumAlgorithm::Xxh64:
+        return "xxh64";
+    }
+    return "fnv1a64";
 }
 
-bool parse_u32(const std::string& token, std::uint32_t& value) {
-    std::uint64_t parsed = 0;
-    if (!parse_u64(token, parsed) || parsed > std::numeric_limits<std::uint32_t>::max()) {
-        return false;
+bool parse_checksum_algorithm(std::string_view name, ChecksumAlgorithm& algorithm) {
+    if (name == "fnv1a64") {
+        algorithm = ChecksumAlgorithm::Fnv1a64;
+        return true;
     }
-    value = static_cast<std::uint32_t>(parsed);
-    return true;
+    if (name == "crc32c") {
+        algorithm = ChecksumAlgorithm::Crc32c;
+        return true;
+    }
+    if (name == "xxh64") {
+        algorithm = ChecksumAlgorithm::Xxh64;
+        return true;
+    }
+    return false;
 }
 
-}  // namespace
+std::size_t checksum_hex_digits(ChecksumAlgorithm algorithm) {
+    return algorithm == ChecksumAlgorithm::Crc32c ? 8 : 16;
+}
 
 bool Manifest::is_valid() const {
     if (format_version.empty() || source_file_name.empty() || chunk_size == 0) {
         return false;
     }
 
+    // A partial manifest may not have recorded any chunk yet.
     if (chunks.empty()) {
-        return false;
+        return !complete;
     }
 
-    std::set<std::uint32_t> seen_indices;
+    std::uint32_t max_index = 0;
     for (const auto& chunk : chunks) {
         if (!chunk.is_valid()) {
             return false;
         }
-        if (!seen_indices.insert(chunk.index).second) {
-            return false;
+        max_index = std::max(max_index, chunk.index);
+    }
+
+    // Indices are normally dense, so a bitmap covers them in a few bits per
+    // chunk; sparse indices fall back to sorting a copy.
+    if (max_index / 4 < chunks.size()) {
+        std::vector<std::uint64_t> seen((static_cast<std::size_t>(max_index) / 64) + 1, 0);
+        for (const auto& chunk : chunks) {
+            const std::uint64_t bit = std::uint64_t{1} << (chunk.index % 64);
+            auto& word = seen[chunk.index / 64];
+            if ((word & bit) != 0) {
+                return false;
+            }
+            word |= bit;
         }
+        return true;
+    }
+
+    std::vector<std::uint32_t> indices;
+    indices.reserve(chunks.size());
+    for (const auto& chunk : chunks) {
+        indices.push_back(chunk.index);
     }
+    std::sort(indices.begin(), indices.end());
+    return std::adjacent_find(indices.begin(), indices.end()) == indices.end();
+}
 
-    return true;
+std::filesystem::path chunk_directory(const Manifest& manifest, const std::filesystem::path& manifest_path) {
+    const auto base_dir = manifest_path.parent_path();
+    if (manifest.chunk_store.empty()) {
+        return base_dir;
+    }
+    return base_dir / manifest.chunk_store;
 }
 
 bool write_manifest(const Manifest& manifest, const std::filesystem::path& path, std::string& error) {
-    if (!manifest.is_valid()) {
+    if (!manifest.is_valid() || !manifest.complete) {
         error = "Manifest is invalid.";
         return false;
     }
 
-    std::ofstream out(path);
-    if (!out.is_open()) {
-        error = "Failed to open manifest for writing: " + path.string();
+    ManifestStreamWriter writer;
+    if (!writer.open(path, manifest, error)) {
         return false;
     }
-
-    out << "version " << manifest.format_version << "\n";
-    out << "source_file " << std::quoted(manifest.source_file_name) << "\n";
-    out << "source_size " << manifest.source_size << "\n";
-    out << "chunk_size " << manifest.chunk_size << "\n";
-    out << "source_checksum " << std::quoted(manifest.source_checksum) << "\n";
-    out << "chunks " << manifest.chunks.size() << "\n";
-
     for (const auto& chunk : manifest.chunks) {
-        out << "chunk " << chunk.index << " " << chunk.offset << " " << chunk.size << " "
-            << std::quoted(chunk.file_name) << " " << std::quoted(chunk.checksum) << "\n";
-    }
-
-    if (!out.good()) {
-        error = "Failed while writing manifest: " + path.string();
-        return false;
+        if (!writer.append(chunk, error)) {
+            return false;
+        }
     }
-
-    return true;
+    return writer.finish(manifest.source_size, manifest.source_checksum, error);
 }
 
 std::optional<Manifest> read_manifest(const std::filesystem::path& path, std::string& error) {
-    std::ifstream in(path);
-    if (!in.is_open()) {
-        error = "Failed to open manifest: " + path.string();
+    ManifestReader reader;
+    if (!reader.open(path, error)) {
         return std::nullopt;
     }
 
-    Manifest manifest;
-    std::size_t declared_chunks = 0;
-    std::size_t parsed_chunks = 0;
-    std::string line;
-
-    while (std::getline(in, line)) {
-        if (line.empty()) {
-            continue;
-        }
-
-        std::istringstream iss(line);
-        std::string key;
-        iss >> key;
-
-        if (key == "version") {
-            iss >> manifest.format_version;
-            continue;
-        }
-        if (key == "source_file") {
-            iss >> std::quoted(manifest.source_file_name);
-            continue;
-        }
-        if (key == "source_size") {
-            std::string token;
-            iss >> token;
-            if (!parse_u64(token, manifest.source_size)) {
-                error = "Invalid source_size in manifest.";
-                return std::nullopt;
-            }
-            continue;
-        }
-        if (key == "chunk_size") {
-            std::string token;
-            iss >> token;
-            if (!parse_u64(token, manifest.chunk_size)) {
-                error = "Invalid chunk_size in manifest.";
-                return std::nullopt;
-            }
-            continue;
+    std::vector<Chunk> chunks;
+    for (;;) {
+        Chunk chunk;
+        bool done = false;
+        if (!reader.next(chunk, done, error)) {
+            return std::nullopt;
         }
-        if (key == "source_checksum") {
-            iss >> std::quoted(manifest.source_checksum);
-            continue;
+        if (done) {
+            break;
         }
-        if (key == "chunks") {
-            std::string token;
-            iss >> token;
-            std::uint64_t count = 0;
-            if (!parse_u64(token, count)) {
-                error = "Invalid chunks count in manifest.";
-                return std::nullopt;
-            }
-            declared_chunks = static_cast<std::size_t>(count);
-            continue;
-        }
-        if (key == "chunk") {
-            Chunk chunk;
-            std::string index_token;
-            std::string offset_token;
-            std::string size_token;
-
-            iss >> index_token >> offset_token >> size_token;
-            if (!parse_u32(index_token, chunk.index) || !parse_u64(offset_token, chunk.offset) ||
-                !parse_u64(size_token, chunk.size)) {
-                error = "Invalid chunk numeric fields in manifest.";
-                return std::nullopt;
-            }
-
-            iss >> std::quoted(chunk.file_name) >> std::quoted(chunk.checksum);
-            if (!chunk.is_valid()) {
-                error = "Invalid chunk entry in manifest.";
-                return std::nullopt;
-            }
-
-            manifest.chunks.push_back(std::move(chunk));
-            ++parsed_chunks;
-            continue;
-        }
-
-        error = "Unknown manifest line key: " + key;
-        return std::nullopt;
-    }
-
-    if (declared_chunks != 0 && declared_chunks != parsed_chunks) {
-        error = "Manifest chunk count does not match chunk entries.";
-        return std::nullopt;
+        chunks.push_back(std::move(chunk));
     }
 
+    Manifest manifest = reader.header();
+    manifest.chunks = std::move(chunks);
     if (!manifest.is_valid()) {
         error = "Manifest failed validation.";
         return std::nullopt;
     }
-
     return manifest;
 }
 
@@ -1,26 +1,61 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "models/chunk.hpp"
 
 namespace humpty::models {
 
+enum class SourceDigest {
+    Stream,
+    Combined,
+};
+
+enum class ChecksumAlgorithm {
+    Fnv1a64,
+    Crc32c,
+    Xxh64,
+};
+
+std::string_view source_digest_name(SourceDigest digest);
+bool parse_source_digest(std::string_view name, SourceDigest& digest);
+
+std::string_view checksum_algorithm_name(ChecksumAlgorithm algorithm);
+bool parse_checksum_algorithm(std::string_view name, ChecksumAlgorithm& algorithm);
+// Length of the lowercase hex digests produced for `algorithm`.
+std::size_t checksum_hex_digits(ChecksumAlgorithm algorithm);
+
 struct Manifest {
     std::string format_version = "1";
     std::string source_file_name;
     std::uint64_t source_size = 0;
     std::uint64_t chunk_size = 0;
     std::string source_checksum;
+    SourceDigest source_digest = SourceDigest::Stream;
+    ChecksumAlgorithm checksum_algorithm = ChecksumAlgorithm::Fnv1a64;
+    // Content-addressed store the chunk file names refer to, relative to the
+    // manifest's directory unless absolute. Empty when chunks sit next to
+    // the manifest.
+    std::string chunk_store;
+    // Codec the split encoded its chunk files with.
+    ChunkCodec codec = ChunkCodec::None;
     std::vector<Chunk> chunks;
+    // False for a manifest whose split was interrupted before its trailer
+    // (totals and source checksum) was written.
+    bool complete = true;
 
     [[nodiscard]] bool is_valid() const;
 };
 
+// Directory that chunk file names of `manifest` are relative to.
+std::filesystem::path chunk_directory(const Manifest& manifest, const std::filesystem::path& manifest_path);
+
 bool write_manifest(const Manifest& manifest, const std::filesystem::path& path, std::string& error);
 std::optional<Manifest> read_manifest(const std::filesystem::path& path, std::string& error);
 
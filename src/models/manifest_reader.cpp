@@ -0,0 +1,442 @@
+#include "models/manifest_reader.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+namespace humpty::models {
+namespace {
+
+constexpr std::size_t kReadBlockSize = 1024 * 1024;
+// The trailer is three short lines; this leaves room for long checksums.
+constexpr std::size_t kTrailerWindow = 4096;
+// Indices below this are tracked in a bitmap (at most 8 MiB); sparse ones
+// above it go to a hash set.
+constexpr std::uint32_t kDenseIndexLimit = std::uint32_t{1} << 26;
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+template <typename T>
+bool parse_number(std::string_view token, T& value) {
+    if (token.empty()) {
+        return false;
+    }
+    const auto [end, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return ec == std::errc{} && end == token.data() + token.size();
+}
+
+// Splits one manifest line into whitespace-separated tokens, matching what
+// `>>` and `>> std::quoted` would extract. Quoted tokens are unescaped in
+// place, which only ever shortens them, so no token owns memory.
+class LineTokenizer {
+public:
+    LineTokenizer(char* begin, char* end) : cursor_(begin), end_(end) {}
+
+    std::string_view word() {
+        skip_space();
+        char* start = cursor_;
+        while (cursor_ != end_ && !is_space(*cursor_)) {
+            ++cursor_;
+        }
+        return {start, static_cast<std::size_t>(cursor_ - start)};
+    }
+
+    std::string_view quoted() {
+        skip_space();
+        if (cursor_ == end_ || *cursor_ != '"') {
+            return word();
+        }
+
+        ++cursor_;
+        char* start = cursor_;
+        while (cursor_ != end_ && *cursor_ != '"' && *cursor_ != '\\') {
+            ++cursor_;
+        }
+        char* out = cursor_;
+        while (cursor_ != end_ && *cursor_ != '"') {
+            if (*cursor_ == '\\' && cursor_ + 1 != end_) {
+                ++cursor_;
+            }
+            *out++ = *cursor_++;
+        }
+        if (cursor_ != end_) {
+            ++cursor_;
+        }
+        return {start, static_cast<std::size_t>(out - start)};
+    }
+
+private:
+    void skip_space() {
+        while (cursor_ != end_ && is_space(*cursor_)) {
+            ++cursor_;
+        }
+    }
+
+    char* cursor_;
+    char* end_;
+};
+
+bool is_trailer_key(std::string_view key) {
+    return key == "source_size" || key == "source_checksum" || key == "chunks";
+}
+
+}  // namespace
+
+bool ManifestReader::open(const std::filesystem::path& path, std::string& error) {
+    *this = ManifestReader();
+    path_ = path;
+
+    if (is_binary_manifest(path)) {
+        if (!view_.open(path, error)) {
+            return false;
+        }
+        binary_ = true;
+        header_.format_version = "2";
+        header_.source_file_name.assign(view_.source_file_name());
+        header_.chunk_store.assign(view_.chunk_store());
+        header_.codec = view_.codec();
+        header_.source_size = view_.source_size();
+        header_.chunk_size = view_.chunk_size();
+        header_.source_checksum.assign(view_.source_checksum());
+        header_.source_digest = view_.source_digest();
+        header_.checksum_algorithm = view_.checksum_algorithm();
+        header_.complete = view_.complete();
+        declared_chunks_ = view_.chunk_count();
+    } else if (!open_text(error)) {
+        return false;
+    }
+
+    if (header_.format_version.empty() || header_.source_file_name.empty() || header_.chunk_size == 0) {
+        error = "Manifest failed validation.";
+        return false;
+    }
+    return true;
+}
+
+bool ManifestReader::open_text(std::string& error) {
+    in_.open(path_, std::ios::binary);
+    if (!in_.is_open()) {
+        error = "Failed to open manifest: " + path_.string();
+        return false;
+    }
+
+    // Header lines run up to the first chunk record, which is held back for
+    // the first next().
+    for (;;) {
+        char* begin = nullptr;
+        char* end = nullptr;
+        bool have_line = false;
+        if (!read_line(begin, end, have_line, error)) {
+            return false;
+        }
+        if (!have_line) {
+            break;
+        }
+
+        Chunk chunk;
+        bool is_chunk = false;
+        if (!parse_line(begin, end, chunk, is_chunk, error)) {
+            return false;
+        }
+        if (is_chunk) {
+            first_chunk_ = std::move(chunk);
+            break;
+        }
+    }
+
+    sized_header_ = saw_source_size_;
+    if (!saw_chunks_ && !sized_header_ && !read_text_trailer(error)) {
+        return false;
+    }
+    header_.complete = saw_chunks_ || sized_header_;
+    return true;
+}
+
+// Parses the totals that follow the last chunk record. They are parsed again
+// when next() reaches them, to the same values.
+bool ManifestReader::read_text_trailer(std::string& error) {
+    std::ifstream tail(path_, std::ios::binary);
+    tail.seekg(0, std::ios::end);
+    const auto size = static_cast<std::uint64_t>(tail.tellg());
+    const std::uint64_t start = (size > kTrailerWindow) ? size - kTrailerWindow : 0;
+    std::string text(static_cast<std::size_t>(size - start), '\0');
+    tail.seekg(static_cast<std::streamoff>(start));
+    tail.read(text.data(), static_cast<std::streamsize>(text.size()));
+    if (tail.gcount() != static_cast<std::streamsize>(text.size())) {
+        error = "Failed to read manifest: " + path_.string();
+        return false;
+    }
+
+    // An unterminated last line means the writer stopped mid-record.
+    if (text.empty() || text.back() != '\n') {
+        return true;
+    }
+
+    std::size_t trailer_begin = text.size();
+    while (trailer_begin > 0) {
+        const auto line_end = trailer_begin - 1;
+        const auto previous = (line_end == 0) ? std::string::npos : text.rfind('\n', line_end - 1);
+        const auto line_begin = (previous == std::string::npos) ? 0 : previous + 1;
+        if (previous == std::string::npos && start != 0) {
+            break;
+        }
+        LineTokenizer tokens(text.data() + line_begin, text.data() + line_end);
+        if (!is_trailer_key(tokens.word())) {
+            break;
+        }
+        trailer_begin = line_begin;
+    }
+
+    char* cursor = text.data() + trailer_begin;
+    char* const text_end = text.data() + text.size();
+    while (cursor != text_end) {
+        auto* newline = static_cast<char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(text_end - cursor)));
+        Chunk unused;
+        bool is_chunk = false;
+        if (!parse_line(cursor, newline, unused, is_chunk, error)) {
+            return false;
+        }
+        cursor = newline + 1;
+    }
+    return true;
+}
+
+bool ManifestReader::read_line(char*& begin, char*& end, bool& have_line, std::string& error) {
+    for (;;) {
+        char* const start = buffer_.data() + buffer_position_;
+        const std::size_t available = buffer_.size() - buffer_position_;
+        auto* newline = static_cast<char*>(std::memchr(start, '\n', available));
+        if (newline != nullptr) {
+            begin = start;
+            end = newline;
+            buffer_position_ += static_cast<std::size_t>(newline - start) + 1;
+            have_line = true;
+            return true;
+        }
+
+        if (at_eof_) {
+            // An unterminated last line is only trusted once the `chunks`
+            // line or a sized header shows the writer finished; otherwise it
+            // may be a torn record from a split that was interrupted.
+            begin = start;
+            end = start + available;
+            buffer_position_ = buffer_.size();
+            have_line = available != 0 && (saw_chunks_ || sized_header_);
+            return true;
+        }
+
+        buffer_.erase(0, buffer_position_);
+        buffer_position_ = 0;
+        const std::size_t kept = buffer_.size();
+        buffer_.resize(kept + kReadBlockSize);
+        in_.read(buffer_.data() + kept, static_cast<std::streamsize>(kReadBlockSize));
+        const auto got = static_cast<std::size_t>(in_.gcount());
+        buffer_.resize(kept + got);
+        if (in_.bad()) {
+            error = "Failed to read manifest: " + path_.string();
+            return false;
+        }
+        at_eof_ = got < kReadBlockSize;
+    }
+}
+
+bool ManifestReader::parse_line(char* begin, char* end, Chunk& chunk, bool& is_chunk, std::string& error) {
+    is_chunk = false;
+    if (begin == end) {
+        return true;
+    }
+
+    LineTokenizer tokens(begin, end);
+    const std::string_view key = tokens.word();
+
+    if (key == "chunk") {
+        if (!parse_number(tokens.word(), chunk.index) || !parse_number(tokens.word(), chunk.offset) ||
+            !parse_number(tokens.word(), chunk.size)) {
+            error = "Invalid chunk numeric fields in manifest.";
+            return false;
+        }
+        chunk.file_name.assign(tokens.quoted());
+        chunk.checksum.assign(tokens.quoted());
+        chunk.changed = false;
+        chunk.codec = ChunkCodec::None;
+        chunk.stored_size = 0;
+        for (auto token = tokens.word(); !token.empty(); token = tokens.word()) {
+            if (token == "changed") {
+                chunk.changed = true;
+            } else if (parse_chunk_codec(token, chunk.codec) && !parse_number(tokens.word(), chunk.stored_size)) {
+                error = "Invalid chunk stored size in manifest.";
+                return false;
+            }
+        }
+        if (!chunk.is_valid()) {
+            error = "Invalid chunk entry in manifest.";
+            return false;
+        }
+        is_chunk = true;
+        return true;
+    }
+    if (key == "version") {
+        header_.format_version.assign(tokens.word());
+        return true;
+    }
+    if (key == "source_file") {
+        header_.source_file_name.assign(tokens.quoted());
+        return true;
+    }
+    if (key == "source_size") {
+        if (!parse_number(tokens.word(), header_.source_size)) {
+            error = "Invalid source_size in manifest.";
+            return false;
+        }
+        saw_source_size_ = true;
+        return true;
+    }
+    if (key == "chunk_size") {
+        if (!parse_number(tokens.word(), header_.chunk_size)) {
+            error = "Invalid chunk_size in manifest.";
+            return false;
+        }
+        return true;
+    }
+    if (key == "source_checksum") {
+        header_.source_checksum.assign(tokens.quoted());
+        return true;
+    }
+    if (key == "source_digest") {
+        const auto token = tokens.word();
+        if (!parse_source_digest(token, header_.source_digest)) {
+            error = "Unknown source_digest in manifest: " + std::string(token);
+            return false;
+        }
+        return true;
+    }
+    if (key == "checksum_algorithm") {
+        const auto token = tokens.word();
+        if (!parse_checksum_algorithm(token, header_.checksum_algorithm)) {
+            error = "Unknown checksum_algorithm in manifest: " + std::string(token);
+            return false;
+        }
+        return true;
+    }
+    if (key == "codec") {
+        const auto token = tokens.word();
+        if (!parse_chunk_codec(token, header_.codec)) {
+            error = "Unknown codec in manifest: " + std::string(token);
+            return false;
+        }
+        return true;
+    }
+    if (key == "chunk_store") {
+        header_.chunk_store.assign(tokens.quoted());
+        return true;
+    }
+    if (key == "chunks") {
+        std::uint64_t count = 0;
+        if (!parse_number(tokens.word(), count)) {
+            error = "Invalid chunks count in manifest.";
+            return false;
+        }
+        declared_chunks_ = static_cast<std::size_t>(count);
+        saw_chunks_ = true;
+        return true;
+    }
+
+    error = "Unknown manifest line key: " + std::string(key);
+    return false;
+}
+
+bool ManifestReader::next_text_chunk(Chunk& chunk, bool& have_chunk, std::string& error) {
+    if (first_chunk_.has_value()) {
+        chunk = std::move(*first_chunk_);
+        first_chunk_.reset();
+        have_chunk = true;
+        return true;
+    }
+
+    for (;;) {
+        char* begin = nullptr;
+        char* end = nullptr;
+        bool have_line = false;
+        if (!read_line(begin, end, have_line, error)) {
+            return false;
+        }
+        if (!have_line) {
+            have_chunk = false;
+            return true;
+        }
+        if (!parse_line(begin, end, chunk, have_chunk, error)) {
+            return false;
+        }
+        if (have_chunk) {
+            return true;
+        }
+    }
+}
+
+bool ManifestReader::next(Chunk& chunk, bool& done, std::string& error) {
+    done = false;
+    if (binary_) {
+        if (position_ == view_.chunk_count()) {
+            return finish(done, error);
+        }
+        if (!view_.chunk_at(position_, chunk)) {
+            error = "Invalid chunk entry in manifest.";
+            return false;
+        }
+        ++position_;
+        return accept(chunk, error);
+    }
+
+    bool have_chunk = false;
+    if (!next_text_chunk(chunk, have_chunk, error)) {
+        return false;
+    }
+    if (!have_chunk) {
+        return finish(done, error);
+    }
+    return accept(chunk, error);
+}
+
+bool ManifestReader::accept(const Chunk& chunk, std::string& error) {
+    bool duplicate = false;
+    if (chunk.index < kDenseIndexLimit) {
+        const std::size_t word = chunk.index / 64;
+        if (word >= seen_dense_.size()) {
+            seen_dense_.resize(std::max(word + 1, seen_dense_.size() * 2), 0);
+        }
+        const std::uint64_t bit = std::uint64_t{1} << (chunk.index % 64);
+        duplicate = (seen_dense_[word] & bit) != 0;
+        seen_dense_[word] |= bit;
+    } else {
+        duplicate = !seen_sparse_.insert(chunk.index).second;
+    }
+    if (duplicate) {
+        error = "Manifest failed validation.";
+        return false;
+    }
+
+    ++parsed_chunks_;
+    return true;
+}
+
+bool ManifestReader::finish(bool& done, std::string& error) {
+    if (!binary_) {
+        header_.complete = saw_chunks_ || sized_header_;
+    }
+    if (declared_chunks_ != 0 && declared_chunks_ != parsed_chunks_) {
+        error = "Manifest chunk count does not match chunk entries.";
+        return false;
+    }
+    if (header_.complete && parsed_chunks_ == 0) {
+        error = "Manifest failed validation.";
+        return false;
+    }
+    done = true;
+    return true;
+}
+
+}  // namespace humpty::models
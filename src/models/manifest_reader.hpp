@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "models/binary_manifest.hpp"
+#include "models/chunk.hpp"
+#include "models/manifest.hpp"
+
+namespace humpty::models {
+
+// Reads a manifest one chunk record at a time, so a caller can act on the
+// first records before the rest are parsed. open() reads the header fields;
+// for a text manifest whose totals are in its trailer it also peeks at the
+// end of the file, so header() carries source_size, source_checksum and
+// `complete` from the start. next() yields records in manifest order and runs
+// the whole-manifest checks (declared count, duplicate indices) when it
+// reaches the end.
+class ManifestReader {
+public:
+    bool open(const std::filesystem::path& path, std::string& error);
+
+    // Sets `done` instead of filling `chunk` once every record was returned.
+    bool next(Chunk& chunk, bool& done, std::string& error);
+
+    // The manifest without its chunk list.
+    [[nodiscard]] const Manifest& header() const { return header_; }
+    // Number of records the manifest declares; 0 when it does not say.
+    [[nodiscard]] std::size_t chunk_count() const { return declared_chunks_; }
+
+private:
+    bool open_text(std::string& error);
+    bool read_text_trailer(std::string& error);
+    bool read_line(char*& begin, char*& end, bool& have_line, std::string& error);
+    bool next_text_chunk(Chunk& chunk, bool& have_chunk, std::string& error);
+    bool parse_line(char* begin, char* end, Chunk& chunk, bool& is_chunk, std::string& error);
+    bool accept(const Chunk& chunk, std::string& error);
+    bool finish(bool& done, std::string& error);
+
+    std::filesystem::path path_;
+    Manifest header_;
+    bool binary_ = false;
+    ManifestView view_;
+    std::size_t position_ = 0;
+
+    std::ifstream in_;
+    std::string buffer_;
+    std::size_t buffer_position_ = 0;
+    bool at_eof_ = false;
+    std::optional<Chunk> first_chunk_;
+
+    bool saw_chunks_ = false;
+    bool saw_source_size_ = false;
+    // Set when source_size comes ahead of the records, as in manifests
+    // written in one go before splits streamed them; those are complete
+    // with or without a `chunks` line.
+    bool sized_header_ = false;
+    std::size_t declared_chunks_ = 0;
+    std::size_t parsed_chunks_ = 0;
+    std::vector<std::uint64_t> seen_dense_;
+    std::unordered_set<std::uint32_t> seen_sparse_;
+};
+
+}  // namespace humpty::models
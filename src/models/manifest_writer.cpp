@@ -0,0 +1,320 @@
+#include "models/manifest_writer.hpp"
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#include "models/binary_manifest.hpp"
+
+namespace humpty::models {
+namespace {
+
+constexpr std::size_t kFlushSize = 1024 * 1024;
+constexpr auto kFlushInterval = std::chrono::seconds(1);
+
+template <typename T>
+void store(char* data, T value) {
+    if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+        value = std::byteswap(value);
+    }
+    std::memcpy(data, &value, sizeof(T));
+}
+
+template <typename T>
+void append_number(std::string& out, T value) {
+    std::array<char, 24> digits{};
+    const auto end = std::to_chars(digits.data(), digits.data() + digits.size(), value).ptr;
+    out.append(digits.data(), static_cast<std::size_t>(end - digits.data()));
+}
+
+// Same escaping as `<< std::quoted(value)`.
+void append_quoted(std::string& out, std::string_view value) {
+    out.push_back('"');
+    for (const char c : value) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+// Accepts exactly the lowercase, zero-padded form the hashers produce, so a
+// digest always formats back to the same text.
+bool parse_hex_digest(std::string_view text, std::size_t digits, std::uint64_t& value) {
+    if (text.size() != digits) {
+        return false;
+    }
+    value = 0;
+    for (const char c : text) {
+        std::uint64_t nibble = 0;
+        if (c >= '0' && c <= '9') {
+            nibble = static_cast<std::uint64_t>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            nibble = static_cast<std::uint64_t>(c - 'a' + 10);
+        } else {
+            return false;
+        }
+        value = (value << 4) | nibble;
+    }
+    return true;
+}
+
+bool add_string(std::string& strings, std::string_view text, std::uint32_t& offset, std::uint32_t& length) {
+    if (text.size() > std::numeric_limits<std::uint32_t>::max() ||
+        strings.size() > std::numeric_limits<std::uint32_t>::max() - text.size()) {
+        return false;
+    }
+    offset = static_cast<std::uint32_t>(strings.size());
+    length = static_cast<std::uint32_t>(text.size());
+    strings.append(text);
+    return true;
+}
+
+std::uint64_t binary_records_offset(std::string_view source_file_name, std::string_view chunk_store) {
+    return (kBinaryManifestHeaderSize + source_file_name.size() + chunk_store.size() + 7) / 8 * 8;
+}
+
+std::size_t binary_record_size(const Manifest& header) {
+    return header.codec == ChunkCodec::None ? kBinaryManifestRecordSize : kBinaryManifestCodecRecordSize;
+}
+
+}  // namespace
+
+bool ManifestStreamWriter::open(const std::filesystem::path& path, const Manifest& header, std::string& error) {
+    if (header.source_file_name.empty() || header.chunk_size == 0) {
+        error = "Manifest is invalid.";
+        return false;
+    }
+
+    path_ = path;
+    header_ = header;
+    header_.chunks.clear();
+    binary_ = header.format_version == "2";
+    buffer_.clear();
+    strings_.clear();
+    chunk_count_ = 0;
+    last_flush_ = std::chrono::steady_clock::now();
+
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        error = "Failed to open manifest for writing: " + path.string();
+        return false;
+    }
+
+    if (binary_) {
+        if (header_.source_file_name.size() > std::numeric_limits<std::uint32_t>::max() ||
+            header_.chunk_store.size() > std::numeric_limits<std::uint32_t>::max()) {
+            error = "Manifest string table is too large.";
+            return false;
+        }
+        if (!write_binary_header(false, 0, error)) {
+            return false;
+        }
+        buffer_.append(header_.source_file_name).append(header_.chunk_store);
+        buffer_.resize(static_cast<std::size_t>(binary_records_offset(header_.source_file_name, header_.chunk_store)) -
+                           kBinaryManifestHeaderSize,
+                       '\0');
+    } else {
+        buffer_.append("version ").append(header_.format_version).push_back('\n');
+        buffer_.append("source_file ");
+        append_quoted(buffer_, header_.source_file_name);
+        buffer_.append("\nchunk_size ");
+        append_number(buffer_, header_.chunk_size);
+        buffer_.push_back('\n');
+        if (header_.source_digest != SourceDigest::Stream) {
+            buffer_.append("source_digest ").append(source_digest_name(header_.source_digest)).push_back('\n');
+        }
+        if (header_.checksum_algorithm != ChecksumAlgorithm::Fnv1a64) {
+            buffer_.append("checksum_algorithm ")
+                .append(checksum_algorithm_name(header_.checksum_algorithm))
+                .push_back('\n');
+        }
+        if (header_.codec != ChunkCodec::None) {
+            buffer_.append("codec ").append(chunk_codec_name(header_.codec)).push_back('\n');
+        }
+        if (!header_.chunk_store.empty()) {
+            buffer_.append("chunk_store ");
+            append_quoted(buffer_, header_.chunk_store);
+            buffer_.push_back('\n');
+        }
+    }
+    return flush(true, error);
+}
+
+bool ManifestStreamWriter::append(const Chunk& chunk, std::string& error) {
+    if (!chunk.is_valid()) {
+        error = "Invalid chunk entry for manifest: index " + std::to_string(chunk.index);
+        return false;
+    }
+
+    if (binary_) {
+        std::array<char, kBinaryManifestCodecRecordSize> record{};
+        std::uint32_t flags = 0;
+        std::uint64_t digest = 0;
+        std::uint32_t name_offset = 0;
+        std::uint32_t name_length = 0;
+
+        if (chunk.file_name == make_chunk_filename(header_.source_file_name, chunk.index)) {
+            flags |= kBinaryRecordDerivedName;
+        } else if (!header_.chunk_store.empty() &&
+                   chunk.file_name == make_store_object_name(chunk.checksum, chunk.size)) {
+            flags |= kBinaryRecordStoreName;
+        } else if (!add_string(strings_, chunk.file_name, name_offset, name_length)) {
+            error = "Manifest string table is too large.";
+            return false;
+        }
+
+        if (parse_hex_digest(chunk.checksum, checksum_hex_digits(header_.checksum_algorithm), digest)) {
+            flags |= kBinaryRecordRawDigest;
+        } else if (!chunk.checksum.empty()) {
+            std::uint32_t offset = 0;
+            std::uint32_t length = 0;
+            if (!add_string(strings_, chunk.checksum, offset, length)) {
+                error = "Manifest string table is too large.";
+                return false;
+            }
+            flags |= kBinaryRecordStringChecksum;
+            digest = (static_cast<std::uint64_t>(length) << 32) | offset;
+        }
+        if (chunk.changed) {
+            flags |= kBinaryRecordChanged;
+        }
+        flags |= static_cast<std::uint32_t>(chunk.codec) << 8;
+
+        store<std::uint32_t>(record.data() + 0, chunk.index);
+        store<std::uint32_t>(record.data() + 4, flags);
+        store<std::uint64_t>(record.data() + 8, chunk.offset);
+        store<std::uint64_t>(record.data() + 16, chunk.size);
+        store<std::uint64_t>(record.data() + 24, digest);
+        store<std::uint32_t>(record.data() + 32, name_offset);
+        store<std::uint32_t>(record.data() + 36, name_length);
+        store<std::uint64_t>(record.data() + 40, chunk.stored_size);
+        buffer_.append(record.data(), binary_record_size(header_));
+    } else {
+        buffer_.append("chunk ");
+        append_number(buffer_, chunk.index);
+        buffer_.push_back(' ');
+        append_number(buffer_, chunk.offset);
+        buffer_.push_back(' ');
+        append_number(buffer_, chunk.size);
+        buffer_.push_back(' ');
+        append_quoted(buffer_, chunk.file_name);
+        buffer_.push_back(' ');
+        append_quoted(buffer_, chunk.checksum);
+        if (chunk.codec != ChunkCodec::None) {
+            buffer_.push_back(' ');
+            buffer_.append(chunk_codec_name(chunk.codec));
+            buffer_.push_back(' ');
+            append_number(buffer_, chunk.stored_size);
+        }
+        if (chunk.changed) {
+            buffer_.append(" changed");
+        }
+        buffer_.push_back('\n');
+    }
+
+    ++chunk_count_;
+    return flush(false, error);
+}
+
+bool ManifestStreamWriter::finish(std::uint64_t source_size, std::string_view source_checksum, std::string& error) {
+    if (chunk_count_ == 0) {
+        error = "Manifest is invalid.";
+        return false;
+    }
+
+    if (binary_) {
+        header_.source_checksum.assign(source_checksum);
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+        if (!add_string(strings_, source_checksum, offset, length)) {
+            error = "Manifest string table is too large.";
+            return false;
+        }
+        buffer_.append(strings_);
+        if (!flush(true, error) || !write_binary_header(true, source_size, error)) {
+            return false;
+        }
+    } else {
+        buffer_.append("source_size ");
+        append_number(buffer_, source_size);
+        buffer_.append("\nsource_checksum ");
+        append_quoted(buffer_, source_checksum);
+        buffer_.append("\nchunks ");
+        append_number(buffer_, chunk_count_);
+        buffer_.push_back('\n');
+        if (!flush(true, error)) {
+            return false;
+        }
+    }
+
+    out_.close();
+    if (out_.fail()) {
+        error = "Failed while writing manifest: " + path_.string();
+        return false;
+    }
+    return true;
+}
+
+bool ManifestStreamWriter::flush(bool force, std::string& error) {
+    const auto now = std::chrono::steady_clock::now();
+    if (!force && buffer_.size() < kFlushSize && now - last_flush_ < kFlushInterval) {
+        return true;
+    }
+
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    out_.flush();
+    buffer_.clear();
+    last_flush_ = now;
+    if (!out_.good()) {
+        error = "Failed while writing manifest: " + path_.string();
+        return false;
+    }
+    return true;
+}
+
+// Written as partial on open() and rewritten with the totals on finish().
+bool ManifestStreamWriter::write_binary_header(bool complete, std::uint64_t source_size, std::string& error) {
+    std::array<char, kBinaryManifestHeaderSize> header{};
+    const std::uint64_t records_offset = binary_records_offset(header_.source_file_name, header_.chunk_store);
+    const std::uint64_t records_size = static_cast<std::uint64_t>(chunk_count_) * binary_record_size(header_);
+    const std::uint64_t strings_size = complete ? strings_.size() : 0;
+
+    std::memcpy(header.data(), kBinaryManifestMagic.data(), kBinaryManifestMagic.size());
+    store<std::uint32_t>(header.data() + 8, kBinaryManifestVersion);
+    store<std::uint32_t>(header.data() + 12, static_cast<std::uint32_t>(kBinaryManifestHeaderSize));
+    store<std::uint32_t>(header.data() + 16, static_cast<std::uint32_t>(binary_record_size(header_)));
+    store<std::uint8_t>(header.data() + 20, static_cast<std::uint8_t>(header_.source_digest));
+    store<std::uint8_t>(header.data() + 21, static_cast<std::uint8_t>(header_.checksum_algorithm));
+    store<std::uint8_t>(header.data() + 22, complete ? 0 : kBinaryManifestPartial);
+    store<std::uint8_t>(header.data() + 23, static_cast<std::uint8_t>(header_.codec));
+    store<std::uint64_t>(header.data() + 24, source_size);
+    store<std::uint64_t>(header.data() + 32, header_.chunk_size);
+    store<std::uint64_t>(header.data() + 40, complete ? chunk_count_ : 0);
+    store<std::uint64_t>(header.data() + 48, records_offset);
+    store<std::uint64_t>(header.data() + 56, complete ? records_offset + records_size : 0);
+    store<std::uint64_t>(header.data() + 64, strings_size);
+    store<std::uint32_t>(header.data() + 72, static_cast<std::uint32_t>(header_.source_file_name.size()));
+    store<std::uint32_t>(header.data() + 76, static_cast<std::uint32_t>(header_.chunk_store.size()));
+    if (complete) {
+        // The source checksum is always the last string in the table.
+        const auto checksum_length = static_cast<std::uint32_t>(header_.source_checksum.size());
+        store<std::uint32_t>(header.data() + 80, static_cast<std::uint32_t>(strings_size) - checksum_length);
+        store<std::uint32_t>(header.data() + 84, checksum_length);
+    }
+
+    out_.seekp(0);
+    out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out_.seekp(0, std::ios::end);
+    out_.flush();
+    if (!out_.good()) {
+        error = "Failed while writing manifest: " + path_.string();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace humpty::models
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "models/chunk.hpp"
+#include "models/manifest.hpp"
+
+namespace humpty::models {
+
+// Writes a manifest as the chunks are produced: the header fields known up
+// front on open(), one record per append(), and the totals (source size,
+// source checksum, chunk count) in a trailer on finish(). Records are
+// flushed at least once a second, so an interrupted split leaves a partial
+// manifest that reads back with `complete == false`.
+//
+// Memory stays constant: nothing per chunk is kept once it is buffered,
+// except binary-format strings that cannot be derived or stored inline.
+class ManifestStreamWriter {
+public:
+    ManifestStreamWriter() = default;
+    ~ManifestStreamWriter() = default;
+
+    ManifestStreamWriter(const ManifestStreamWriter&) = delete;
+    ManifestStreamWriter& operator=(const ManifestStreamWriter&) = delete;
+
+    // Uses format_version, source_file_name, chunk_size, source_digest,
+    // checksum_algorithm, chunk_store and codec from `header`; its chunks and
+    // totals are ignored.
+    bool open(const std::filesystem::path& path, const Manifest& header, std::string& error);
+    bool append(const Chunk& chunk, std::string& error);
+    bool finish(std::uint64_t source_size, std::string_view source_checksum, std::string& error);
+
+    // Writes out buffered records now when `force` is set, otherwise only
+    // once enough has piled up or the last write is a second old.
+    bool flush(bool force, std::string& error);
+
+    [[nodiscard]] std::size_t chunk_count() const { return chunk_count_; }
+
+private:
+    bool write_binary_header(bool complete, std::uint64_t source_size, std::string& error);
+
+    std::filesystem::path path_;
+    std::ofstream out_;
+    Manifest header_;
+    bool binary_ = false;
+    std::string buffer_;
+    std::string strings_;
+    std::size_t chunk_count_ = 0;
+    std::chrono::steady_clock::time_point last_flush_{};
+};
+
+}  // namespace humpty::models
@@ -0,0 +1,238 @@
+#include "services/async_copy.hpp"
+
+#include <cstring>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "services/transfer_stats.hpp"
+
+namespace humpty::services {
+namespace {
+
+enum class SlotState {
+    Free,
+    Reading,
+    Filled,
+    Writing,
+};
+
+struct Slot {
+    SlotState state = SlotState::Free;
+    std::size_t range = 0;
+    std::uint64_t range_offset = 0;
+    std::size_t length = 0;
+    std::size_t transferred = 0;
+};
+
+struct RangeProgress {
+    RangeCopy copy;
+    std::size_t outstanding = 0;
+    bool fully_issued = false;
+};
+
+std::string describe_errno(std::int64_t result) {
+    return std::strerror(static_cast<int>(-result));
+}
+
+}  // namespace
+
+bool async_copy_ranges(IoBackend& backend,
+                       std::size_t range_count,
+                       std::size_t queue_depth,
+                       std::size_t segment_size,
+                       const AsyncCopyCallbacks& callbacks,
+                       std::string& error) {
+    std::vector<std::byte> storage(queue_depth * segment_size);
+    const stats::BufferCharge buffer_charge(storage.size());
+    std::vector<std::span<std::byte>> buffers;
+    buffers.reserve(queue_depth);
+    for (std::size_t i = 0; i < queue_depth; ++i) {
+        buffers.emplace_back(storage.data() + (i * segment_size), segment_size);
+    }
+    backend.register_buffers(buffers);
+
+    std::vector<Slot> slots(queue_depth);
+    std::deque<std::size_t> hash_order;
+    std::map<std::size_t, RangeProgress> open_ranges;
+    std::vector<IoCompletion> completions;
+
+    std::size_t next_range = 0;
+    std::uint64_t next_range_offset = 0;
+    std::size_t busy = 0;
+    bool failed = false;
+
+    auto fail = [&](std::string message) {
+        if (!failed) {
+            failed = true;
+            error = std::move(message);
+        }
+    };
+
+    auto queue_io = [&](std::size_t slot_index) {
+        Slot& slot = slots[slot_index];
+        const RangeCopy& copy = open_ranges[slot.range].copy;
+        const bool reading = slot.state == SlotState::Reading;
+
+        IoRequest request;
+        request.operation = reading ? IoOperation::Read : IoOperation::Write;
+        request.fd = reading ? copy.source_fd : copy.target_fd;
+        request.offset = (reading ? copy.source_offset : copy.target_offset) + slot.range_offset + slot.transferred;
+        request.buffer = buffers[slot_index].subspan(slot.transferred, slot.length - slot.transferred);
+        request.buffer_index = static_cast<int>(slot_index);
+        request.tag = slot_index;
+        if (!backend.submit(request)) {
+            fail("Failed to queue I/O request on " + std::string(backend.name()) + " backend.");
+            return false;
+        }
+        return true;
+    };
+
+    auto finish_range_if_done = [&](std::size_t range_index) {
+        auto it = open_ranges.find(range_index);
+        if (it == open_ranges.end() || !it->second.fully_issued || it->second.outstanding != 0) {
+            return;
+        }
+        open_ranges.erase(it);
+        std::string range_error;
+        if (!failed && callbacks.on_range_done && !callbacks.on_range_done(range_index, range_error)) {
+            fail(range_error);
+        }
+    };
+
+    while (true) {
+        // Keep every free buffer busy with the next segment in source order.
+        for (std::size_t slot_index = 0; slot_index < slots.size() && !failed; ++slot_index) {
+            if (slots[slot_index].state != SlotState::Free) {
+                continue;
+            }
+
+            while (next_range < range_count && !open_ranges.contains(next_range) && !failed) {
+                RangeProgress progress;
+                std::string range_error;
+                if (!callbacks.open_range(next_range, progress.copy, range_error)) {
+                    fail(range_error);
+                    break;
+                }
+                if (progress.copy.length != 0) {
+                    open_ranges.emplace(next_range, progress);
+                    break;
+                }
+                progress.fully_issued = true;
+                open_ranges.emplace(next_range, progress);
+                finish_range_if_done(next_range);
+                ++next_range;
+                next_range_offset = 0;
+            }
+            if (failed || next_range >= range_count) {
+                break;
+            }
+
+            RangeProgress& progress = open_ranges[next_range];
+            const std::uint64_t remaining = progress.copy.length - next_range_offset;
+
+            Slot& slot = slots[slot_index];
+            slot.state = SlotState::Reading;
+            slot.range = next_range;
+            slot.range_offset = next_range_offset;
+            slot.length = static_cast<std::size_t>(remaining < segment_size ? remaining : segment_size);
+            slot.transferred = 0;
+            ++progress.outstanding;
+            ++busy;
+            hash_order.push_back(slot_index);
+
+            next_range_offset += slot.length;
+            if (next_range_offset == progress.copy.length) {
+                progress.fully_issued = true;
+                ++next_range;
+                next_range_offset = 0;
+            }
+
+            if (!queue_io(slot_index)) {
+                break;
+            }
+        }
+
+        if (busy == 0) {
+            break;
+        }
+
+        completions.clear();
+        if (!backend.wait(1, completions)) {
+            // Nothing can be reaped any more, so in-flight buffers cannot be
+            // reclaimed safely either; report the failure as fatal.
+            fail("Failed waiting for I/O completions on " + std::string(backend.name()) + " backend.");
+            return false;
+        }
+
+        for (const IoCompletion& completion : completions) {
+            Slot& slot = slots[completion.tag];
+            const bool reading = slot.state == SlotState::Reading;
+
+            if (completion.result <= 0) {
+                const RangeCopy& copy = open_ranges[slot.range].copy;
+                if (completion.result == 0 && reading) {
+                    fail("Unexpected end of file: " + copy.source_name);
+                } else if (reading) {
+                    fail("Failed reading " + copy.source_name + ": " + describe_errno(completion.result));
+                } else {
+                    fail("Failed writing " + copy.target_name + ": " +
+                         (completion.result == 0 ? std::string("no progress") : describe_errno(completion.result)));
+                }
+            } else {
+                slot.transferred += static_cast<std::size_t>(completion.result);
+            }
+
+            if (!failed && slot.transferred < slot.length) {
+                queue_io(completion.tag);
+                continue;
+            }
+
+            if (reading && !failed) {
+                slot.state = SlotState::Filled;
+                continue;
+            }
+
+            const std::size_t range_index = slot.range;
+            slot.state = SlotState::Free;
+            --busy;
+            --open_ranges[range_index].outstanding;
+            finish_range_if_done(range_index);
+        }
+
+        // Hand filled buffers to the caller strictly in source order, then
+        // queue their writes.
+        while (!failed && !hash_order.empty() && slots[hash_order.front()].state == SlotState::Filled) {
+            const std::size_t slot_index = hash_order.front();
+            hash_order.pop_front();
+
+            Slot& slot = slots[slot_index];
+            std::string data_error;
+            if (callbacks.on_data &&
+                !callbacks.on_data(slot.range, buffers[slot_index].subspan(0, slot.length), data_error)) {
+                fail(data_error);
+                break;
+            }
+
+            slot.state = SlotState::Writing;
+            slot.transferred = 0;
+            queue_io(slot_index);
+        }
+
+        if (failed) {
+            // Release buffers that are not owned by the kernel and drain the rest.
+            for (std::size_t slot_index = 0; slot_index < slots.size(); ++slot_index) {
+                Slot& slot = slots[slot_index];
+                if (slot.state == SlotState::Filled) {
+                    slot.state = SlotState::Free;
+                    --busy;
+                }
+            }
+            hash_order.clear();
+        }
+    }
+
+    return !failed;
+}
+
+}  // namespace humpty::services
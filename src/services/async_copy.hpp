@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+
+#include "services/io_backend.hpp"
+
+namespace humpty::services {
+
+struct RangeCopy {
+    int source_fd = -1;
+    std::uint64_t source_offset = 0;
+    int target_fd = -1;
+    std::uint64_t target_offset = 0;
+    std::uint64_t length = 0;
+    std::string source_name;
+    std::string target_name;
+};
+
+struct AsyncCopyCallbacks {
+    // Called once per range, in order, just before its first read is queued.
+    std::function<bool(std::size_t index, RangeCopy& range, std::string& error)> open_range;
+    // Called with every byte of every range in source order, between the read
+    // completing and the write being queued.
+    std::function<bool(std::size_t index, std::span<const std::byte> data, std::string& error)> on_data;
+    // Called once all writes of a range have completed.
+    std::function<bool(std::size_t index, std::string& error)> on_range_done;
+};
+
+// Copies `range_count` ranges through `queue_depth` registered buffers of
+// `segment_size` bytes, keeping reads and writes from several ranges in
+// flight on the backend at once.
+bool async_copy_ranges(IoBackend& backend,
+                       std::size_t range_count,
+                       std::size_t queue_depth,
+                       std::size_t segment_size,
+                       const AsyncCopyCallbacks& callbacks,
+                       std::string& error);
+
+}  // namespace humpty::services
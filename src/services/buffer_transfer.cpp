@@ -0,0 +1,248 @@
+#include "services/buffer_transfer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "models/chunk.hpp"
+#include "services/checksums.hpp"
+#include "services/chunk_codec.hpp"
+#include "services/content_chunking.hpp"
+#include "services/file_io.hpp"
+#include "services/workers.hpp"
+
+namespace humpty::services {
+namespace {
+
+std::string chunk_checksum(humpty::models::ChecksumAlgorithm algorithm, std::span<const std::byte> data) {
+    Hasher hasher(algorithm);
+    hasher.update(data);
+    return hasher.hex();
+}
+
+// Chunk entries without checksums, in offset order.
+bool plan_chunks(const BufferSplitRequest& request,
+                 std::span<const std::byte> source,
+                 std::vector<humpty::models::Chunk>& chunks,
+                 std::string& error) {
+    constexpr std::uint64_t kMaxChunks = static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max()) + 1;
+    chunks.clear();
+    const auto add_chunk = [&](std::uint64_t offset, std::uint64_t size) {
+        if (chunks.size() == kMaxChunks) {
+            error = "Too many chunks for chunk size.";
+            return false;
+        }
+        humpty::models::Chunk chunk;
+        chunk.index = static_cast<std::uint32_t>(chunks.size());
+        chunk.offset = offset;
+        chunk.size = size;
+        chunk.file_name = humpty::models::make_chunk_filename(request.source_name, chunk.index);
+        chunks.push_back(std::move(chunk));
+        return true;
+    };
+
+    if (!request.content_defined) {
+        for (std::uint64_t offset = 0; offset < source.size(); offset += request.chunk_size_bytes) {
+            if (!add_chunk(offset, std::min<std::uint64_t>(request.chunk_size_bytes, source.size() - offset))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const auto params = make_cdc_params(request.chunk_size_bytes, request.cdc_min_bytes, request.cdc_max_bytes);
+    if (!is_valid_cdc_params(params)) {
+        error = "Content-defined chunking needs 64 bytes <= minimum < chunk size < maximum <= 256 MiB.";
+        return false;
+    }
+    const GearChunker chunker(params);
+    std::size_t offset = 0;
+    while (offset < source.size()) {
+        const std::size_t window = std::min<std::size_t>(params.maximum, source.size() - offset);
+        const std::size_t cut = chunker.find_cut(source.subspan(offset, window));
+        if (!add_chunk(offset, cut)) {
+            return false;
+        }
+        offset += cut;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool DirectoryChunkSink::put(const humpty::models::Chunk& chunk,
+                             std::span<const std::byte> data,
+                             std::string& error) {
+    const auto chunk_path = directory_ / chunk.file_name;
+    FileHandle chunk_out;
+    if (!chunk_out.open_write(chunk_path)) {
+        error = "Failed to open chunk for writing: " + chunk_path.string();
+        return false;
+    }
+    if (!chunk_out.write_all(data)) {
+        error = "Failed writing chunk file: " + chunk_path.string();
+        return false;
+    }
+    return true;
+}
+
+bool DirectoryChunkSource::read(const humpty::models::Chunk& chunk, std::span<std::byte> out, std::string& error) {
+    const auto chunk_path = directory_ / chunk.file_name;
+    FileHandle chunk_in;
+    if (!chunk_in.open_read(chunk_path)) {
+        error = "Failed to open chunk file: " + chunk_path.string();
+        return false;
+    }
+    std::uint64_t file_size = 0;
+    if (!chunk_in.size(file_size) || file_size != chunk.file_size()) {
+        error = "Chunk file size does not match manifest: " + chunk_path.string();
+        return false;
+    }
+    if (chunk.codec == humpty::models::ChunkCodec::None) {
+        if (!chunk_in.read_exact(out)) {
+            error = "Unexpected end of chunk: " + chunk_path.string();
+            return false;
+        }
+        return true;
+    }
+    std::size_t done = 0;
+    return decode_chunk_file(
+        chunk_in, chunk,
+        [&](std::span<const std::byte> block, std::string& block_error) {
+            if (block.size() > out.size() - done) {
+                block_error = "Chunk decodes past its size: " + chunk_path.string();
+                return false;
+            }
+            std::memcpy(out.data() + done, block.data(), block.size());
+            done += block.size();
+            return true;
+        },
+        error);
+}
+
+bool split_buffer(const BufferSplitRequest& request,
+                  std::span<const std::byte> source,
+                  ChunkSink& sink,
+                  humpty::models::Manifest& manifest,
+                  std::string& error) {
+    error.clear();
+    if (request.chunk_size_bytes == 0) {
+        error = "Chunk size must be greater than zero.";
+        return false;
+    }
+    if (request.source_name.empty()) {
+        error = "A buffer split needs a source name.";
+        return false;
+    }
+    if (source.empty()) {
+        error = "Source buffer is empty.";
+        return false;
+    }
+
+    humpty::models::Manifest result;
+    result.source_file_name = request.source_name;
+    result.source_size = source.size();
+    result.chunk_size = request.chunk_size_bytes;
+    result.source_digest = request.source_digest;
+    result.checksum_algorithm = request.checksum_algorithm;
+    if (!plan_chunks(request, source, result.chunks, error)) {
+        return false;
+    }
+
+    auto& chunks = result.chunks;
+    const bool ok = parallel_for_each_index(
+        chunks.size(), request.thread_count,
+        [&](std::size_t index, std::string& task_error) {
+            auto& chunk = chunks[index];
+            const auto data = source.subspan(static_cast<std::size_t>(chunk.offset), static_cast<std::size_t>(chunk.size));
+            chunk.checksum = chunk_checksum(request.checksum_algorithm, data);
+            return sink.put(chunk, data, task_error);
+        },
+        error);
+    if (!ok) {
+        return false;
+    }
+
+    if (request.source_digest == humpty::models::SourceDigest::Combined) {
+        ChunkDigestCombiner combiner;
+        for (const auto& chunk : chunks) {
+            combiner.add(chunk.offset, chunk.size, chunk.checksum);
+        }
+        result.source_checksum = combiner.hex();
+    } else {
+        result.source_checksum = chunk_checksum(request.checksum_algorithm, source);
+    }
+    manifest = std::move(result);
+    return true;
+}
+
+bool join_buffer(const BufferJoinRequest& request,
+                 const humpty::models::Manifest& manifest,
+                 ChunkSource& source,
+                 std::span<std::byte> output,
+                 std::string& error) {
+    error.clear();
+    if (!manifest.complete) {
+        error = "Manifest is incomplete; the split that wrote it did not finish.";
+        return false;
+    }
+    if (output.size() != manifest.source_size) {
+        error = "Output size does not match manifest source_size.";
+        return false;
+    }
+    std::uint64_t covered = 0;
+    for (const auto& chunk : manifest.chunks) {
+        if (chunk.offset != covered || chunk.size > manifest.source_size - covered) {
+            error = "Manifest chunks do not cover the source without gaps.";
+            return false;
+        }
+        covered += chunk.size;
+    }
+    if (covered != manifest.source_size) {
+        error = "Manifest chunks do not cover the source without gaps.";
+        return false;
+    }
+
+    const bool ok = parallel_for_each_index(
+        manifest.chunks.size(), request.thread_count,
+        [&](std::size_t index, std::string& task_error) {
+            const auto& chunk = manifest.chunks[index];
+            const auto out = output.subspan(static_cast<std::size_t>(chunk.offset), static_cast<std::size_t>(chunk.size));
+            if (!source.read(chunk, out, task_error)) {
+                return false;
+            }
+            if (request.verify_checksums && !chunk.checksum.empty() &&
+                chunk_checksum(manifest.checksum_algorithm, out) != chunk.checksum) {
+                task_error = "Chunk checksum mismatch for " + chunk.file_name;
+                return false;
+            }
+            return true;
+        },
+        error);
+    if (!ok) {
+        return false;
+    }
+
+    if (!request.verify_checksums || manifest.source_checksum.empty()) {
+        return true;
+    }
+    std::string source_checksum;
+    if (manifest.source_digest == humpty::models::SourceDigest::Combined) {
+        ChunkDigestCombiner combiner;
+        for (const auto& chunk : manifest.chunks) {
+            combiner.add(chunk.offset, chunk.size, chunk.checksum);
+        }
+        source_checksum = combiner.hex();
+    } else {
+        source_checksum = chunk_checksum(manifest.checksum_algorithm, output);
+    }
+    if (source_checksum != manifest.source_checksum) {
+        error = "Source checksum mismatch after join.";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <utility>
+
+#include "models/manifest.hpp"
+
+namespace humpty::services {
+
+// Takes the chunks of a buffer split. `data` views the caller's source
+// buffer and is only valid during the call; nothing is copied before it.
+// With more than one thread, put() is called concurrently for different
+// chunks and in no particular order.
+class ChunkSink {
+public:
+    virtual ~ChunkSink() = default;
+    virtual bool put(const humpty::models::Chunk& chunk, std::span<const std::byte> data, std::string& error) = 0;
+};
+
+// Supplies the chunks of a buffer join. `out` is the chunk's slice of the
+// caller's output buffer, exactly `chunk.size` bytes, to be filled with the
+// chunk's decoded data. With more than one thread, read() is called
+// concurrently for different chunks.
+class ChunkSource {
+public:
+    virtual ~ChunkSource() = default;
+    virtual bool read(const humpty::models::Chunk& chunk, std::span<std::byte> out, std::string& error) = 0;
+};
+
+// Writes each chunk to `<directory>/<chunk.file_name>`, as split_file lays
+// chunks out.
+class DirectoryChunkSink : public ChunkSink {
+public:
+    explicit DirectoryChunkSink(std::filesystem::path directory) : directory_(std::move(directory)) {}
+    bool put(const humpty::models::Chunk& chunk, std::span<const std::byte> data, std::string& error) override;
+
+private:
+    std::filesystem::path directory_;
+};
+
+// Reads chunk files from a directory, such as chunk_directory() of a
+// manifest, decoding compressed ones straight into the output.
+class DirectoryChunkSource : public ChunkSource {
+public:
+    explicit DirectoryChunkSource(std::filesystem::path directory) : directory_(std::move(directory)) {}
+    bool read(const humpty::models::Chunk& chunk, std::span<std::byte> out, std::string& error) override;
+
+private:
+    std::filesystem::path directory_;
+};
+
+struct BufferSplitRequest {
+    // Names the manifest's source and the chunk file names.
+    std::string source_name;
+    std::uint64_t chunk_size_bytes = 0;
+    std::size_t thread_count = 1;
+    humpty::models::SourceDigest source_digest = humpty::models::SourceDigest::Stream;
+    humpty::models::ChecksumAlgorithm checksum_algorithm = humpty::models::ChecksumAlgorithm::Fnv1a64;
+    // Content-defined chunks, as for SplitRequest.
+    bool content_defined = false;
+    std::uint64_t cdc_min_bytes = 0;
+    std::uint64_t cdc_max_bytes = 0;
+};
+
+// Splits `source` into chunks, hashes each and hands it to `sink` as a view
+// of `source`, then fills `manifest` with the complete chunk list, ready for
+// models::write_manifest(). An empty source is rejected, since a manifest
+// needs at least one chunk. Chunks are not compressed. A stream source
+// digest costs one more pass over `source`; unlike split_file it needs no
+// single thread, since the buffer can be read out of order.
+bool split_buffer(const BufferSplitRequest& request,
+                  std::span<const std::byte> source,
+                  ChunkSink& sink,
+                  humpty::models::Manifest& manifest,
+                  std::string& error);
+
+struct BufferJoinRequest {
+    bool verify_checksums = true;
+    std::size_t thread_count = 1;
+};
+
+// Has `source` fill `output`, which must be exactly manifest.source_size
+// bytes, with each chunk at its offset, then checks each chunk's checksum
+// and the source digest over the output. The manifest's chunks must be
+// listed in offset order and cover the source without gaps.
+bool join_buffer(const BufferJoinRequest& request,
+                 const humpty::models::Manifest& manifest,
+                 ChunkSource& source,
+                 std::span<std::byte> output,
+                 std::string& error);
+
+}  // namespace humpty::services
@@ -0,0 +1,113 @@
+#include "services/checkpoint.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace humpty::services {
+namespace {
+
+constexpr std::string_view kCheckpointMagic = "humpty-join-checkpoint";
+constexpr auto kFlushInterval = std::chrono::seconds(1);
+
+std::string checkpoint_header(const humpty::models::Manifest& manifest) {
+    std::ostringstream header;
+    header << kCheckpointMagic << " 1 " << std::quoted(manifest.source_file_name) << ' ' << manifest.source_size
+           << ' ' << manifest.chunk_size << ' ' << std::quoted(manifest.source_checksum);
+    return header.str();
+}
+
+}  // namespace
+
+std::filesystem::path join_checkpoint_path(const std::filesystem::path& output_file) {
+    auto path = output_file;
+    path += ".checkpoint";
+    return path;
+}
+
+void load_join_checkpoint(const std::filesystem::path& path,
+                          const humpty::models::Manifest& manifest,
+                          std::uint64_t output_size,
+                          CompletedChunks& completed) {
+    completed.clear();
+    std::ifstream in(path);
+    std::string line;
+    if (!std::getline(in, line) || line != checkpoint_header(manifest)) {
+        return;
+    }
+
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        humpty::models::Chunk chunk;
+        if (!(fields >> key >> chunk.index >> chunk.offset >> chunk.size >> std::quoted(chunk.checksum)) ||
+            key != "chunk") {
+            break;
+        }
+        if (chunk.offset > output_size || chunk.size > output_size - chunk.offset) {
+            continue;
+        }
+        completed.insert_or_assign(chunk.index, std::move(chunk));
+    }
+}
+
+bool JoinCheckpoint::open(const std::filesystem::path& path,
+                          const humpty::models::Manifest& manifest,
+                          bool append,
+                          std::string& error) {
+    path_ = path;
+    out_.open(path, append ? std::ios::app : std::ios::trunc);
+    if (!out_.is_open()) {
+        error = "Failed to open checkpoint for writing: " + path.string();
+        return false;
+    }
+    if (!append) {
+        out_ << checkpoint_header(manifest) << '\n';
+    }
+    out_.flush();
+    last_flush_ = std::chrono::steady_clock::now();
+    if (!out_.good()) {
+        error = "Failed writing checkpoint: " + path.string();
+        out_.close();
+        return false;
+    }
+    fresh_ = !append;
+    return true;
+}
+
+JoinCheckpoint::~JoinCheckpoint() {
+    if (fresh_ && !recorded_) {
+        remove();
+    }
+}
+
+bool JoinCheckpoint::record(const humpty::models::Chunk& chunk, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!out_.is_open()) {
+        return true;
+    }
+    recorded_ = true;
+    out_ << "chunk " << chunk.index << ' ' << chunk.offset << ' ' << chunk.size << ' ' << std::quoted(chunk.checksum)
+         << '\n';
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_flush_ >= kFlushInterval) {
+        out_.flush();
+        last_flush_ = now;
+    }
+    if (!out_.good()) {
+        error = "Failed writing checkpoint: " + path_.string();
+        return false;
+    }
+    return true;
+}
+
+void JoinCheckpoint::remove() {
+    if (!out_.is_open()) {
+        return;
+    }
+    out_.close();
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+}
+
+}  // namespace humpty::services
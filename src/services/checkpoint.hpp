@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "models/chunk.hpp"
+#include "models/manifest.hpp"
+
+namespace humpty::services {
+
+// Chunks an interrupted join already wrote, keyed by chunk index.
+using CompletedChunks = std::unordered_map<std::uint32_t, humpty::models::Chunk>;
+
+// "<output>.checkpoint", next to the join output.
+std::filesystem::path join_checkpoint_path(const std::filesystem::path& output_file);
+
+// Reads back a checkpoint written for `manifest`. Entries that reach past
+// `output_size` are dropped, as is everything when the checkpoint belongs to
+// another manifest; a missing file or a torn last line is not an error.
+void load_join_checkpoint(const std::filesystem::path& path,
+                          const humpty::models::Manifest& manifest,
+                          std::uint64_t output_size,
+                          CompletedChunks& completed);
+
+// Appends one line per chunk once it is in the output. Lines are flushed at
+// least once a second; record() may be called from several workers. A
+// checkpoint that was never opened records nothing.
+class JoinCheckpoint {
+public:
+    JoinCheckpoint() = default;
+    // A fresh checkpoint that never recorded a chunk is deleted, so a join
+    // that fails before writing anything leaves none behind.
+    ~JoinCheckpoint();
+
+    JoinCheckpoint(const JoinCheckpoint&) = delete;
+    JoinCheckpoint& operator=(const JoinCheckpoint&) = delete;
+
+    // Keeps the existing entries when `append` is set, otherwise starts a
+    // fresh checkpoint for `manifest`.
+    bool open(const std::filesystem::path& path,
+              const humpty::models::Manifest& manifest,
+              bool append,
+              std::string& error);
+    bool record(const humpty::models::Chunk& chunk, std::string& error);
+    // Deletes the checkpoint once the join has finished.
+    void remove();
+
+private:
+    std::filesystem::path path_;
+    std::ofstream out_;
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point last_flush_{};
+    bool fresh_ = false;
+    bool recorded_ = false;
+};
+
+}  // namespace humpty::services
@@ -1,23 +1,276 @@
 #include "services/checksums.hpp"
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
 
+#include "services/mapped_file.hpp"
+#include "services/transfer_stats.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HUMPTY_HAVE_X86_CRC32C 1
+#include <immintrin.h>
+#endif
+
 namespace humpty::services {
 namespace {
 
+using humpty::models::ChecksumAlgorithm;
+
 constexpr std::uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
 constexpr std::uint64_t kFnvPrime = 1099511628211ULL;
 constexpr std::size_t kBufferSize = 64 * 1024;
 
+constexpr std::uint32_t kCrc32cPoly = 0x82F63B78U;
+
+constexpr std::uint64_t kXxhPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t kXxhPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t kXxhPrime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t kXxhPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t kXxhPrime5 = 0x27D4EB2F165667C5ULL;
+
 std::string to_hex64(std::uint64_t value) {
     std::ostringstream out;
     out << std::hex << std::nouppercase << std::setfill('0') << std::setw(16) << value;
     return out.str();
 }
 
+std::string to_hex32(std::uint32_t value) {
+    std::ostringstream out;
+    out << std::hex << std::nouppercase << std::setfill('0') << std::setw(8) << value;
+    return out.str();
+}
+
+void append_le64(std::array<std::byte, 16>& out, std::size_t at, std::uint64_t value) {
+    for (std::size_t i = 0; i < 8; ++i) {
+        out[at + i] = static_cast<std::byte>((value >> (8 * i)) & 0xFFU);
+    }
+}
+
+std::uint64_t load_le64(const std::byte* data) {
+    std::uint64_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+std::uint32_t load_le32(const std::byte* data) {
+    std::uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+// --- CRC-32C -----------------------------------------------------------------
+
+using Crc32cTables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+constexpr Crc32cTables make_crc32c_tables() {
+    Crc32cTables tables{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) ? (crc >> 1) ^ kCrc32cPoly : crc >> 1;
+        }
+        tables[0][i] = crc;
+    }
+    for (std::size_t slice = 1; slice < tables.size(); ++slice) {
+        for (std::size_t i = 0; i < 256; ++i) {
+            const std::uint32_t prev = tables[slice - 1][i];
+            tables[slice][i] = (prev >> 8) ^ tables[0][prev & 0xFFU];
+        }
+    }
+    return tables;
+}
+
+constexpr Crc32cTables kCrc32cTables = make_crc32c_tables();
+
+#if defined(HUMPTY_HAVE_X86_CRC32C)
+
+// Multiplication modulo the CRC-32C polynomial in bit-reflected form (bit 31
+// is x^0), used to derive the shift constants for combining interleaved lanes.
+constexpr std::uint32_t crc32c_multiply(std::uint32_t a, std::uint32_t b) {
+    std::uint32_t product = 0;
+    for (std::uint32_t mask = 1U << 31; mask != 0; mask >>= 1) {
+        if (a & mask) {
+            product ^= b;
+        }
+        b = (b & 1U) ? (b >> 1) ^ kCrc32cPoly : b >> 1;
+    }
+    return product;
+}
+
+constexpr std::uint32_t crc32c_x_pow(std::uint64_t n) {
+    std::uint32_t result = 1U << 31;
+    std::uint32_t base = 1U << 30;
+    while (n != 0) {
+        if (n & 1U) {
+            result = crc32c_multiply(result, base);
+        }
+        base = crc32c_multiply(base, base);
+        n >>= 1;
+    }
+    return result;
+}
+
+// Three independent crc32 streams hide the instruction's 3-cycle latency; the
+// lanes are merged by multiplying by x^(8 * lane bytes) with PCLMULQDQ. The
+// carry-less product of two reflected 32-bit values carries an extra factor of
+// x and _mm_crc32_u64 adds x^32, hence the -33.
+constexpr std::size_t kCrc32cLaneBytes = 2048;
+constexpr std::uint32_t kCrc32cShiftOneLane = crc32c_x_pow((8 * kCrc32cLaneBytes) - 33);
+constexpr std::uint32_t kCrc32cShiftTwoLanes = crc32c_x_pow((16 * kCrc32cLaneBytes) - 33);
+
+__attribute__((target("sse4.2,pclmul"))) std::uint64_t crc32c_shift(std::uint64_t crc, std::uint32_t constant) {
+    const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crc)),
+                                                 _mm_cvtsi32_si128(static_cast<int>(constant)), 0);
+    return _mm_crc32_u64(0, static_cast<std::uint64_t>(_mm_cvtsi128_si64(product)));
+}
+
+__attribute__((target("sse4.2,pclmul"))) std::uint32_t crc32c_sse42(std::span<const std::byte> data,
+                                                                     std::uint32_t crc) {
+    const std::byte* p = data.data();
+    std::size_t n = data.size();
+    std::uint64_t state = static_cast<std::uint32_t>(~crc);
+
+    while (n != 0 && (reinterpret_cast<std::uintptr_t>(p) & 7U) != 0) {
+        state = _mm_crc32_u8(static_cast<std::uint32_t>(state), static_cast<std::uint8_t>(*p));
+        ++p;
+        --n;
+    }
+
+    while (n >= 3 * kCrc32cLaneBytes) {
+        std::uint64_t lane0 = state;
+        std::uint64_t lane1 = 0;
+        std::uint64_t lane2 = 0;
+        for (std::size_t i = 0; i < kCrc32cLaneBytes; i += 8) {
+            lane0 = _mm_crc32_u64(lane0, load_le64(p + i));
+            lane1 = _mm_crc32_u64(lane1, load_le64(p + kCrc32cLaneBytes + i));
+            lane2 = _mm_crc32_u64(lane2, load_le64(p + (2 * kCrc32cLaneBytes) + i));
+        }
+        state = crc32c_shift(lane0, kCrc32cShiftTwoLanes) ^ crc32c_shift(lane1, kCrc32cShiftOneLane) ^ lane2;
+        p += 3 * kCrc32cLaneBytes;
+        n -= 3 * kCrc32cLaneBytes;
+    }
+
+    while (n >= 8) {
+        state = _mm_crc32_u64(state, load_le64(p));
+        p += 8;
+        n -= 8;
+    }
+    while (n != 0) {
+        state = _mm_crc32_u8(static_cast<std::uint32_t>(state), static_cast<std::uint8_t>(*p));
+        ++p;
+        --n;
+    }
+
+    return ~static_cast<std::uint32_t>(state);
+}
+
+#endif
+
+using Crc32cKernel = std::uint32_t (*)(std::span<const std::byte>, std::uint32_t);
+
+struct Crc32cDispatch {
+    Crc32cKernel kernel;
+    std::string_view name;
+};
+
+Crc32cDispatch resolve_crc32c() {
+#if defined(HUMPTY_HAVE_X86_CRC32C)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul")) {
+        return {crc32c_sse42, "sse4.2+pclmul"};
+    }
+#endif
+    return {crc32c_portable, "portable"};
+}
+
+const Crc32cDispatch& crc32c_dispatch() {
+    static const Crc32cDispatch dispatch = resolve_crc32c();
+    return dispatch;
+}
+
+// --- XXH64 -------------------------------------------------------------------
+
+std::uint64_t xxh64_round(std::uint64_t acc, std::uint64_t input) {
+    acc += input * kXxhPrime2;
+    acc = std::rotl(acc, 31);
+    return acc * kXxhPrime1;
+}
+
+std::uint64_t xxh64_merge_round(std::uint64_t acc, std::uint64_t lane) {
+    acc ^= xxh64_round(0, lane);
+    return (acc * kXxhPrime1) + kXxhPrime4;
+}
+
+std::array<std::uint64_t, 4> xxh64_initial_lanes(std::uint64_t seed) {
+    return {seed + kXxhPrime1 + kXxhPrime2, seed + kXxhPrime2, seed, seed - kXxhPrime1};
+}
+
+const std::byte* xxh64_stripes(std::array<std::uint64_t, 4>& lanes, const std::byte* p, std::size_t stripes) {
+    for (std::size_t i = 0; i < stripes; ++i, p += 32) {
+        lanes[0] = xxh64_round(lanes[0], load_le64(p));
+        lanes[1] = xxh64_round(lanes[1], load_le64(p + 8));
+        lanes[2] = xxh64_round(lanes[2], load_le64(p + 16));
+        lanes[3] = xxh64_round(lanes[3], load_le64(p + 24));
+    }
+    return p;
+}
+
+std::uint64_t xxh64_finalize(const std::array<std::uint64_t, 4>& lanes,
+                             std::uint64_t seed,
+                             std::uint64_t total_length,
+                             std::span<const std::byte> tail) {
+    std::uint64_t hash = 0;
+    if (total_length >= 32) {
+        hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        for (const std::uint64_t lane : lanes) {
+            hash = xxh64_merge_round(hash, lane);
+        }
+    } else {
+        hash = seed + kXxhPrime5;
+    }
+    hash += total_length;
+
+    const std::byte* p = tail.data();
+    std::size_t n = tail.size();
+    while (n >= 8) {
+        hash ^= xxh64_round(0, load_le64(p));
+        hash = (std::rotl(hash, 27) * kXxhPrime1) + kXxhPrime4;
+        p += 8;
+        n -= 8;
+    }
+    if (n >= 4) {
+        hash ^= static_cast<std::uint64_t>(load_le32(p)) * kXxhPrime1;
+        hash = (std::rotl(hash, 23) * kXxhPrime2) + kXxhPrime3;
+        p += 4;
+        n -= 4;
+    }
+    while (n != 0) {
+        hash ^= static_cast<std::uint64_t>(*p) * kXxhPrime5;
+        hash = std::rotl(hash, 11) * kXxhPrime1;
+        ++p;
+        --n;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kXxhPrime2;
+    hash ^= hash >> 29;
+    hash *= kXxhPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
 }  // namespace
 
 std::uint64_t fnv1a64(std::span<const std::byte> data, std::uint64_t seed) {
@@ -33,7 +286,157 @@ std::string fnv1a64_hex(std::span<const std::byte> data, std::uint64_t seed) {
     return to_hex64(fnv1a64(data, seed));
 }
 
-bool hash_file_fnv1a64_hex(const std::filesystem::path& path, std::string& out_hex, std::string& error) {
+std::uint32_t crc32c(std::span<const std::byte> data, std::uint32_t crc) {
+    return crc32c_dispatch().kernel(data, crc);
+}
+
+std::uint32_t crc32c_portable(std::span<const std::byte> data, std::uint32_t crc) {
+    const std::byte* p = data.data();
+    std::size_t n = data.size();
+    std::uint32_t state = ~crc;
+
+    while (n >= 8) {
+        const std::uint64_t word = load_le64(p) ^ state;
+        state = kCrc32cTables[7][word & 0xFFU] ^ kCrc32cTables[6][(word >> 8) & 0xFFU] ^
+                kCrc32cTables[5][(word >> 16) & 0xFFU] ^ kCrc32cTables[4][(word >> 24) & 0xFFU] ^
+                kCrc32cTables[3][(word >> 32) & 0xFFU] ^ kCrc32cTables[2][(word >> 40) & 0xFFU] ^
+                kCrc32cTables[1][(word >> 48) & 0xFFU] ^ kCrc32cTables[0][word >> 56];
+        p += 8;
+        n -= 8;
+    }
+    while (n != 0) {
+        state = (state >> 8) ^ kCrc32cTables[0][(state ^ static_cast<std::uint32_t>(*p)) & 0xFFU];
+        ++p;
+        --n;
+    }
+
+    return ~state;
+}
+
+std::string_view crc32c_kernel_name() {
+    return crc32c_dispatch().name;
+}
+
+std::uint64_t xxh64(std::span<const std::byte> data, std::uint64_t seed) {
+    auto lanes = xxh64_initial_lanes(seed);
+    const std::size_t stripes = data.size() / 32;
+    const std::byte* tail = xxh64_stripes(lanes, data.data(), stripes);
+    return xxh64_finalize(lanes, seed, data.size(), std::span<const std::byte>(tail, data.size() - (stripes * 32)));
+}
+
+Hasher::Hasher(ChecksumAlgorithm algorithm) : algorithm_(algorithm) {
+    switch (algorithm_) {
+    case ChecksumAlgorithm::Fnv1a64:
+        state_ = kFnvOffsetBasis;
+        break;
+    case ChecksumAlgorithm::Crc32c:
+        state_ = 0;
+        break;
+    case ChecksumAlgorithm::Xxh64:
+        lanes_ = xxh64_initial_lanes(0);
+        break;
+    }
+}
+
+void Hasher::update(std::span<const std::byte> data) {
+    const stats::ScopedTimer timer(stats::Timer::Hash);
+    switch (algorithm_) {
+    case ChecksumAlgorithm::Fnv1a64:
+        state_ = fnv1a64(data, state_);
+        return;
+    case ChecksumAlgorithm::Crc32c:
+        state_ = crc32c(data, static_cast<std::uint32_t>(state_));
+        return;
+    case ChecksumAlgorithm::Xxh64:
+        total_length_ += data.size();
+        xxh64_consume_stripes(data);
+        return;
+    }
+}
+
+void Hasher::xxh64_consume_stripes(std::span<const std::byte> data) {
+    if (pending_size_ != 0) {
+        const std::size_t take = std::min(pending_.size() - pending_size_, data.size());
+        std::memcpy(pending_.data() + pending_size_, data.data(), take);
+        pending_size_ += take;
+        data = data.subspan(take);
+        if (pending_size_ < pending_.size()) {
+            return;
+        }
+        xxh64_stripes(lanes_, pending_.data(), 1);
+        pending_size_ = 0;
+    }
+
+    const std::size_t stripes = data.size() / 32;
+    xxh64_stripes(lanes_, data.data(), stripes);
+    const auto rest = data.subspan(stripes * 32);
+    std::memcpy(pending_.data(), rest.data(), rest.size());
+    pending_size_ = rest.size();
+}
+
+std::string Hasher::hex() const {
+    switch (algorithm_) {
+    case ChecksumAlgorithm::Fnv1a64:
+        return to_hex64(state_);
+    case ChecksumAlgorithm::Crc32c:
+        return to_hex32(static_cast<std::uint32_t>(state_));
+    case ChecksumAlgorithm::Xxh64:
+        return to_hex64(xxh64_finalize(lanes_, 0, total_length_, std::span(pending_.data(), pending_size_)));
+    }
+    return {};
+}
+
+void ChunkDigestCombiner::add(std::uint64_t offset, std::uint64_t size, std::string_view chunk_checksum) {
+    std::array<std::byte, 16> header{};
+    append_le64(header, 0, offset);
+    append_le64(header, 8, size);
+    state_ = fnv1a64(header, state_);
+    state_ = fnv1a64(std::as_bytes(std::span(chunk_checksum.data(), chunk_checksum.size())), state_);
+}
+
+std::string ChunkDigestCombiner::hex() const {
+    return to_hex64(state_);
+}
+
+bool hash_mapped_file_hex(const std::filesystem::path& path,
+                          ChecksumAlgorithm algorithm,
+                          std::string& out_hex,
+                          std::string& error) {
+    FileHandle in;
+    std::uint64_t size = 0;
+    if (!in.open_read(path) || !in.size(size)) {
+        error = "Failed to open file for hashing: " + path.string();
+        return false;
+    }
+
+    MappedRegion window;
+    Hasher hasher(algorithm);
+    for (std::uint64_t offset = 0; offset < size;) {
+        const std::uint64_t remaining = size - offset;
+        const std::size_t to_map = static_cast<std::size_t>(
+            (remaining < static_cast<std::uint64_t>(kMapWindowSize)) ? remaining : kMapWindowSize);
+        if (!window.map_read(in, offset, to_map)) {
+            error = "Failed to map file for hashing: " + path.string();
+            return false;
+        }
+        window.advise_sequential();
+        hasher.update(window.bytes());
+        offset += to_map;
+    }
+
+    out_hex = hasher.hex();
+    return true;
+}
+
+bool hash_file_hex(const std::filesystem::path& path,
+                   ChecksumAlgorithm algorithm,
+                   std::string& out_hex,
+                   std::string& error,
+                   IoEngine engine) {
+    if (engine == IoEngine::Mmap) {
+        return hash_mapped_file_hex(path, algorithm, out_hex, error);
+    }
+
     std::ifstream in(path, std::ios::binary);
     if (!in.is_open()) {
         error = "Failed to open file for hashing: " + path.string();
@@ -41,7 +444,7 @@ bool hash_file_fnv1a64_hex(const std::filesystem::path& path, std::string& out_h
     }
 
     std::array<std::byte, kBufferSize> buffer{};
-    std::uint64_t hash = kFnvOffsetBasis;
+    Hasher hasher(algorithm);
 
     while (in.good()) {
         in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
@@ -50,8 +453,7 @@ bool hash_file_fnv1a64_hex(const std::filesystem::path& path, std::string& out_h
             break;
         }
 
-        const auto view = std::span<const std::byte>(buffer.data(), static_cast<std::size_t>(bytes_read));
-        hash = fnv1a64(view, hash);
+        hasher.update(std::span<const std::byte>(buffer.data(), static_cast<std::size_t>(bytes_read)));
     }
 
     if (!in.eof() && in.fail()) {
@@ -59,8 +461,12 @@ bool hash_file_fnv1a64_hex(const std::filesystem::path& path, std::string& out_h
         return false;
     }
 
-    out_hex = to_hex64(hash);
+    out_hex = hasher.hex();
     return true;
 }
 
+bool hash_file_fnv1a64_hex(const std::filesystem::path& path, std::string& out_hex, std::string& error) {
+    return hash_file_hex(path, ChecksumAlgorithm::Fnv1a64, out_hex, error);
+}
+
 }  // namespace humpty::services
@@ -1,15 +1,64 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <filesystem>
 #include <span>
 #include <string>
+#include <string_view>
+
+#include "models/manifest.hpp"
+#include "services/file_io.hpp"
 
 namespace humpty::services {
 
 std::uint64_t fnv1a64(std::span<const std::byte> data, std::uint64_t seed = 14695981039346656037ULL);
 std::string fnv1a64_hex(std::span<const std::byte> data, std::uint64_t seed = 14695981039346656037ULL);
 
+// CRC-32C (Castagnoli). `crc` is the finalized value of the preceding data,
+// so calls can be chained. crc32c() dispatches at runtime to the SSE4.2 +
+// PCLMUL kernel when the CPU has it and to crc32c_portable() otherwise.
+std::uint32_t crc32c(std::span<const std::byte> data, std::uint32_t crc = 0);
+std::uint32_t crc32c_portable(std::span<const std::byte> data, std::uint32_t crc = 0);
+std::string_view crc32c_kernel_name();
+
+std::uint64_t xxh64(std::span<const std::byte> data, std::uint64_t seed = 0);
+
+class Hasher {
+public:
+    explicit Hasher(humpty::models::ChecksumAlgorithm algorithm = humpty::models::ChecksumAlgorithm::Fnv1a64);
+
+    void update(std::span<const std::byte> data);
+    [[nodiscard]] std::string hex() const;
+    [[nodiscard]] humpty::models::ChecksumAlgorithm algorithm() const { return algorithm_; }
+
+private:
+    void xxh64_consume_stripes(std::span<const std::byte> data);
+
+    humpty::models::ChecksumAlgorithm algorithm_;
+    std::uint64_t state_ = 0;
+    std::uint64_t total_length_ = 0;
+    std::array<std::uint64_t, 4> lanes_{};
+    std::array<std::byte, 32> pending_{};
+    std::size_t pending_size_ = 0;
+};
+
+// Builds the whole-file digest of a "combined" manifest from its chunk
+// entries, fed in index order, so it never has to re-read the data.
+class ChunkDigestCombiner {
+public:
+    void add(std::uint64_t offset, std::uint64_t size, std::string_view chunk_checksum);
+    [[nodiscard]] std::string hex() const;
+
+private:
+    std::uint64_t state_ = 14695981039346656037ULL;
+};
+
+bool hash_file_hex(const std::filesystem::path& path,
+                   humpty::models::ChecksumAlgorithm algorithm,
+                   std::string& out_hex,
+                   std::string& error,
+                   IoEngine engine = IoEngine::Stream);
 bool hash_file_fnv1a64_hex(const std::filesystem::path& path, std::string& out_hex, std::string& error);
 
 }  // namespace humpty::services
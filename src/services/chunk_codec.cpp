@@ -0,0 +1,323 @@
+#include "services/chunk_codec.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "services/transfer_stats.hpp"
+
+namespace humpty::services {
+namespace {
+
+constexpr std::uint32_t kRawFrameFlag = 0x80000000U;
+
+constexpr unsigned kHashLog = 16;
+constexpr std::size_t kMinMatch = 4;
+// The format requires the last 5 bytes of a block to be literals and the
+// last match to start at least 12 bytes before the end.
+constexpr std::size_t kLastLiterals = 5;
+constexpr std::size_t kMatchFindLimit = 12;
+constexpr std::size_t kMaxOffset = 65535;
+
+std::uint32_t load32(const unsigned char* bytes) {
+    std::uint32_t value = 0;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+std::uint32_t hash_sequence(std::uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - kHashLog);
+}
+
+std::size_t length_extension_size(std::size_t length) {
+    return length >= 15 ? ((length - 15) / 255) + 1 : 0;
+}
+
+unsigned char* put_length_extension(unsigned char* out, std::size_t length) {
+    if (length < 15) {
+        return out;
+    }
+    length -= 15;
+    for (; length >= 255; length -= 255) {
+        *out++ = 255;
+    }
+    *out++ = static_cast<unsigned char>(length);
+    return out;
+}
+
+// Appends one sequence: `literal_count` literals from `literals`, then a
+// match of `match_length` bytes `offset` back, unless `match_length` is zero
+// (the last sequence). Returns nullptr when it does not fit before `out_end`.
+unsigned char* put_sequence(unsigned char* out,
+                            const unsigned char* out_end,
+                            const unsigned char* literals,
+                            std::size_t literal_count,
+                            std::size_t offset,
+                            std::size_t match_length) {
+    const std::size_t match_code = match_length == 0 ? 0 : match_length - kMinMatch;
+    const std::size_t needed = 1 + length_extension_size(literal_count) + literal_count +
+                               (match_length == 0 ? 0 : 2 + length_extension_size(match_code));
+    if (needed > static_cast<std::size_t>(out_end - out)) {
+        return nullptr;
+    }
+
+    *out++ = static_cast<unsigned char>((std::min<std::size_t>(literal_count, 15) << 4) |
+                                        std::min<std::size_t>(match_code, 15));
+    out = put_length_extension(out, literal_count);
+    std::memcpy(out, literals, literal_count);
+    out += literal_count;
+    if (match_length != 0) {
+        *out++ = static_cast<unsigned char>(offset & 0xFF);
+        *out++ = static_cast<unsigned char>(offset >> 8);
+        out = put_length_extension(out, match_code);
+    }
+    return out;
+}
+
+// Greedy LZ4 block compressor: a hash table remembers the last position of
+// each 4-byte sequence, and a hit is extended backwards over pending
+// literals and forwards as far as it matches. Returns 0 when the result
+// would not fit in `out`.
+std::size_t lz4_compress(std::span<const std::byte> input, std::span<std::byte> output) {
+    const auto* in = reinterpret_cast<const unsigned char*>(input.data());
+    auto* out = reinterpret_cast<unsigned char*>(output.data());
+    const unsigned char* out_end = out + output.size();
+    const std::size_t size = input.size();
+    std::size_t anchor = 0;
+
+    if (size > kMatchFindLimit) {
+        std::vector<std::uint32_t> table(std::size_t{1} << kHashLog, 0);
+        const std::size_t last_match_start = size - kMatchFindLimit;
+        const std::size_t match_end_limit = size - kLastLiterals;
+        std::size_t position = 1;
+
+        while (position <= last_match_start) {
+            const std::uint32_t sequence = load32(in + position);
+            auto& slot = table[hash_sequence(sequence)];
+            std::size_t candidate = slot;
+            slot = static_cast<std::uint32_t>(position);
+            if (candidate >= position || position - candidate > kMaxOffset || load32(in + candidate) != sequence) {
+                // Searches speed up through long runs without matches.
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            while (position > anchor && candidate > 0 && in[position - 1] == in[candidate - 1]) {
+                --position;
+                --candidate;
+            }
+            std::size_t length = kMinMatch;
+            while (position + length < match_end_limit && in[candidate + length] == in[position + length]) {
+                ++length;
+            }
+
+            out = put_sequence(out, out_end, in + anchor, position - anchor, position - candidate, length);
+            if (out == nullptr) {
+                return 0;
+            }
+            position += length;
+            anchor = position;
+            if (position - 2 <= last_match_start) {
+                table[hash_sequence(load32(in + position - 2))] = static_cast<std::uint32_t>(position - 2);
+            }
+        }
+    }
+
+    out = put_sequence(out, out_end, in + anchor, size - anchor, 0, 0);
+    return out == nullptr ? 0 : static_cast<std::size_t>(out - reinterpret_cast<unsigned char*>(output.data()));
+}
+
+bool read_length_extension(const unsigned char*& in, const unsigned char* in_end, std::size_t& length) {
+    unsigned char byte = 255;
+    while (byte == 255) {
+        if (in == in_end) {
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    }
+    return true;
+}
+
+// Decodes an LZ4 block that must fill `output` exactly. Every length and
+// offset is checked, so a corrupt block fails instead of reading or writing
+// out of bounds.
+bool lz4_decompress(std::span<const std::byte> input, std::span<std::byte> output) {
+    const auto* in = reinterpret_cast<const unsigned char*>(input.data());
+    const unsigned char* in_end = in + input.size();
+    auto* const out_begin = reinterpret_cast<unsigned char*>(output.data());
+    unsigned char* out = out_begin;
+    const unsigned char* out_end = out + output.size();
+
+    for (;;) {
+        if (in == in_end) {
+            return false;
+        }
+        const unsigned char token = *in++;
+        std::size_t literal_count = token >> 4;
+        if (literal_count == 15 && !read_length_extension(in, in_end, literal_count)) {
+            return false;
+        }
+        if (literal_count > static_cast<std::size_t>(in_end - in) ||
+            literal_count > static_cast<std::size_t>(out_end - out)) {
+            return false;
+        }
+        std::memcpy(out, in, literal_count);
+        in += literal_count;
+        out += literal_count;
+        if (in == in_end) {
+            return out == out_end;
+        }
+
+        if (in_end - in < 2) {
+            return false;
+        }
+        const std::size_t offset = static_cast<std::size_t>(in[0]) | (static_cast<std::size_t>(in[1]) << 8);
+        in += 2;
+        std::size_t length = token & 15;
+        if (length == 15 && !read_length_extension(in, in_end, length)) {
+            return false;
+        }
+        length += kMinMatch;
+        if (offset == 0 || offset > static_cast<std::size_t>(out - out_begin) ||
+            length > static_cast<std::size_t>(out_end - out)) {
+            return false;
+        }
+
+        const unsigned char* match = out - offset;
+        if (offset >= length) {
+            std::memcpy(out, match, length);
+            out += length;
+        } else {
+            // Overlapping matches repeat the bytes just written.
+            for (std::size_t i = 0; i < length; ++i) {
+                *out++ = *match++;
+            }
+        }
+    }
+}
+
+void store_frame_header(std::span<std::byte> frame, std::uint32_t header) {
+    for (std::size_t i = 0; i < kCodecFrameHeaderSize; ++i) {
+        frame[i] = static_cast<std::byte>(header >> (8 * i));
+    }
+}
+
+std::uint32_t load_frame_header(std::span<const std::byte> frame) {
+    std::uint32_t header = 0;
+    for (std::size_t i = 0; i < kCodecFrameHeaderSize; ++i) {
+        header |= std::to_integer<std::uint32_t>(frame[i]) << (8 * i);
+    }
+    return header;
+}
+
+}  // namespace
+
+std::size_t encode_frame(humpty::models::ChunkCodec codec,
+                         std::span<const std::byte> block,
+                         std::span<std::byte> frame) {
+    auto payload = frame.subspan(kCodecFrameHeaderSize, block.size());
+    std::size_t payload_size = 0;
+    if (codec == humpty::models::ChunkCodec::Lz4 && !block.empty()) {
+        // Anything that does not beat the raw block is not worth decoding.
+        payload_size = lz4_compress(block, payload.first(block.size() - 1));
+    }
+    if (payload_size == 0) {
+        std::memcpy(payload.data(), block.data(), block.size());
+        store_frame_header(frame, static_cast<std::uint32_t>(block.size()) | kRawFrameFlag);
+        return kCodecFrameHeaderSize + block.size();
+    }
+    store_frame_header(frame, static_cast<std::uint32_t>(payload_size));
+    return kCodecFrameHeaderSize + payload_size;
+}
+
+bool read_frame_size(const FileHandle& chunk_in,
+                     const humpty::models::Chunk& chunk,
+                     std::uint64_t file_offset,
+                     std::uint64_t& frame_size,
+                     std::string& error) {
+    std::array<std::byte, kCodecFrameHeaderSize> header{};
+    if (file_offset > chunk.stored_size || chunk.stored_size - file_offset < kCodecFrameHeaderSize ||
+        !chunk_in.read_exact_at(header, file_offset)) {
+        error = "Unexpected end of chunk: " + chunk.file_name;
+        return false;
+    }
+    frame_size = kCodecFrameHeaderSize + (load_frame_header(header) & ~kRawFrameFlag);
+    return true;
+}
+
+bool decode_frame_at(const FileHandle& chunk_in,
+                     const humpty::models::Chunk& chunk,
+                     std::uint64_t file_offset,
+                     std::span<std::byte> block,
+                     std::vector<std::byte>& scratch,
+                     std::uint64_t& next_offset,
+                     std::string& error) {
+    std::array<std::byte, kCodecFrameHeaderSize> header{};
+    if (file_offset > chunk.stored_size || chunk.stored_size - file_offset < kCodecFrameHeaderSize ||
+        !chunk_in.read_exact_at(header, file_offset)) {
+        error = "Unexpected end of chunk: " + chunk.file_name;
+        return false;
+    }
+    const std::uint32_t value = load_frame_header(header);
+    const bool raw = (value & kRawFrameFlag) != 0;
+    const std::size_t payload_size = value & ~kRawFrameFlag;
+    file_offset += kCodecFrameHeaderSize;
+    if (payload_size > block.size() || (raw && payload_size != block.size())) {
+        error = "Corrupt encoded chunk: " + chunk.file_name;
+        return false;
+    }
+    if (chunk.stored_size - file_offset < payload_size) {
+        error = "Unexpected end of chunk: " + chunk.file_name;
+        return false;
+    }
+
+    if (raw) {
+        if (!chunk_in.read_exact_at(block, file_offset)) {
+            error = "Unexpected end of chunk: " + chunk.file_name;
+            return false;
+        }
+    } else {
+        scratch.resize(std::max(scratch.size(), payload_size));
+        const auto payload = std::span<std::byte>(scratch.data(), payload_size);
+        if (!chunk_in.read_exact_at(payload, file_offset)) {
+            error = "Unexpected end of chunk: " + chunk.file_name;
+            return false;
+        }
+        if (!lz4_decompress(payload, block)) {
+            error = "Corrupt encoded chunk: " + chunk.file_name;
+            return false;
+        }
+    }
+    next_offset = file_offset + payload_size;
+    return true;
+}
+
+bool decode_chunk_file(const FileHandle& chunk_in,
+                       const humpty::models::Chunk& chunk,
+                       const std::function<bool(std::span<const std::byte> block, std::string& error)>& on_block,
+                       std::string& error) {
+    std::vector<std::byte> scratch(kCodecBlockSize);
+    std::vector<std::byte> block(kCodecBlockSize);
+    const stats::BufferCharge buffer_charge(scratch.size() + block.size());
+    std::uint64_t file_offset = 0;
+    std::uint64_t done = 0;
+
+    while (done < chunk.size) {
+        const auto view = std::span<std::byte>(
+            block.data(), static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size - done, kCodecBlockSize)));
+        if (!decode_frame_at(chunk_in, chunk, file_offset, view, scratch, file_offset, error) ||
+            !on_block(view, error)) {
+            return false;
+        }
+        done += view.size();
+    }
+
+    if (file_offset != chunk.stored_size) {
+        error = "Encoded chunk has trailing data: " + chunk.file_name;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "models/chunk.hpp"
+#include "services/file_io.hpp"
+
+namespace humpty::services {
+
+// An encoded chunk file is a run of frames, each holding the next
+// kCodecBlockSize bytes of the chunk (the last one may hold fewer): a 32-bit
+// little-endian header with the payload length, then the payload. A header
+// with its top bit set marks a block kept as is because it did not shrink.
+// Blocks are compressed independently, in the LZ4 block format.
+constexpr std::size_t kCodecBlockSize = 1024 * 1024;
+constexpr std::size_t kCodecFrameHeaderSize = 4;
+
+// Room encode_frame() needs for a block of `block_size` bytes.
+constexpr std::size_t max_encoded_frame_size(std::size_t block_size) {
+    return kCodecFrameHeaderSize + block_size;
+}
+
+// Encodes `block` (at most kCodecBlockSize bytes) into the front of `frame`
+// and returns the frame's length.
+std::size_t encode_frame(humpty::models::ChunkCodec codec,
+                         std::span<const std::byte> block,
+                         std::span<std::byte> frame);
+
+// Reads the header of the frame at `file_offset` of an encoded chunk file
+// and sets `frame_size` to the length of the whole frame.
+bool read_frame_size(const FileHandle& chunk_in,
+                     const humpty::models::Chunk& chunk,
+                     std::uint64_t file_offset,
+                     std::uint64_t& frame_size,
+                     std::string& error);
+
+// Decodes the frame at `file_offset` into `block`, which must be exactly
+// as long as that block of the chunk, and sets `next_offset` to the frame
+// after it. `scratch` holds the compressed payload between calls.
+bool decode_frame_at(const FileHandle& chunk_in,
+                     const humpty::models::Chunk& chunk,
+                     std::uint64_t file_offset,
+                     std::span<std::byte> block,
+                     std::vector<std::byte>& scratch,
+                     std::uint64_t& next_offset,
+                     std::string& error);
+
+// Reads an encoded chunk file from its start and hands each decoded block
+// to `on_block` in order. Fails unless the frames fill exactly
+// `chunk.stored_size` bytes and decode to exactly `chunk.size`.
+bool decode_chunk_file(const FileHandle& chunk_in,
+                       const humpty::models::Chunk& chunk,
+                       const std::function<bool(std::span<const std::byte> block, std::string& error)>& on_block,
+                       std::string& error);
+
+}  // namespace humpty::services
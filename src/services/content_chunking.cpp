@@ -0,0 +1,196 @@
+#include "services/content_chunking.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <functional>
+
+#include "services/mapped_file.hpp"
+#include "services/workers.hpp"
+
+namespace humpty::services {
+namespace {
+
+// The gear table fixes where every cut lands, so it must never change:
+// splitmix64 from a constant seed.
+constexpr std::array<std::uint64_t, 256> make_gear_table() {
+    std::array<std::uint64_t, 256> table{};
+    std::uint64_t state = 0x68756d7074794344ULL;
+    for (auto& entry : table) {
+        state += 0x9E3779B97F4A7C15ULL;
+        std::uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        entry = z ^ (z >> 31);
+    }
+    return table;
+}
+
+constexpr auto kGear = make_gear_table();
+
+// The shift in the gear hash moves older bytes towards the top, so the top
+// bits depend on the most recent 64 bytes and are the ones to test.
+constexpr std::uint64_t top_bits_mask(unsigned bits) {
+    return bits == 0 ? 0 : ~std::uint64_t{0} << (64 - bits);
+}
+
+// Cuts chunks from `offset`, which must be a chunk boundary, and reports
+// the end of each to `on_cut` until one ends at or past `stop` or `on_cut`
+// returns false. Each cut is searched with `maximum` bytes in view, so a
+// window is remapped from the current chunk once fewer than that remain.
+bool scan_chunks(const FileHandle& input,
+                 std::uint64_t size,
+                 const GearChunker& chunker,
+                 std::uint64_t maximum,
+                 std::uint64_t offset,
+                 std::uint64_t stop,
+                 const std::function<bool(std::uint64_t end)>& on_cut,
+                 std::string& error) {
+    MappedRegion window;
+    std::span<const std::byte> view;
+    std::uint64_t window_offset = offset;
+
+    while (offset < stop) {
+        const std::uint64_t window_end = window_offset + view.size();
+        if (window_end < size && offset + maximum > window_end) {
+            const auto length =
+                static_cast<std::size_t>(std::min<std::uint64_t>(size - offset, kMapWindowSize + maximum));
+            if (!window.map_read(input, offset, length)) {
+                error = "Failed to map input while finding chunk boundaries.";
+                return false;
+            }
+            window.advise_sequential();
+            window_offset = offset;
+            view = window.bytes();
+        }
+
+        offset += chunker.find_cut(view.subspan(static_cast<std::size_t>(offset - window_offset)));
+        if (!on_cut(offset)) {
+            break;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+CdcParams make_cdc_params(std::uint64_t average, std::uint64_t minimum, std::uint64_t maximum) {
+    CdcParams params;
+    params.average = average;
+    params.minimum = minimum != 0 ? minimum : average / 4;
+    params.maximum = maximum != 0 ? maximum : average * 4;
+    return params;
+}
+
+bool is_valid_cdc_params(const CdcParams& params) {
+    return params.minimum >= kCdcMinimumChunk && params.minimum < params.average &&
+           params.average < params.maximum && params.maximum <= kCdcMaximumChunk;
+}
+
+GearChunker::GearChunker(const CdcParams& params)
+    : minimum_(static_cast<std::size_t>(params.minimum)),
+      average_(static_cast<std::size_t>(params.average)),
+      maximum_(static_cast<std::size_t>(params.maximum)) {
+    const auto bits = static_cast<unsigned>(std::bit_width(params.average) - 1);
+    mask_small_ = top_bits_mask(bits + 1);
+    mask_large_ = top_bits_mask(bits - 1);
+}
+
+std::size_t GearChunker::find_cut(std::span<const std::byte> data) const {
+    const std::size_t length = std::min(data.size(), maximum_);
+    if (length <= minimum_) {
+        return length;
+    }
+
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    const std::size_t normal = std::min(length, average_);
+    std::uint64_t hash = 0;
+    std::size_t i = minimum_;
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + kGear[bytes[i]];
+        if ((hash & mask_small_) == 0) {
+            return i + 1;
+        }
+    }
+    for (; i < length; ++i) {
+        hash = (hash << 1) + kGear[bytes[i]];
+        if ((hash & mask_large_) == 0) {
+            return i + 1;
+        }
+    }
+    return length;
+}
+
+bool find_cdc_boundaries(const FileHandle& input,
+                         std::uint64_t size,
+                         const CdcParams& params,
+                         std::size_t thread_count,
+                         std::vector<std::uint64_t>& chunk_ends,
+                         std::string& error) {
+    const GearChunker chunker(params);
+    if (size == 0) {
+        return true;
+    }
+    if (thread_count <= 1) {
+        return scan_chunks(input, size, chunker, params.maximum, 0, size,
+                           [&](std::uint64_t end) {
+                               chunk_ends.push_back(end);
+                               return true;
+                           },
+                           error);
+    }
+
+    // Each segment is cut as if a chunk started where the segment does. Only
+    // the first segment's cuts are certain, but a cut depends on nothing
+    // before its chunk's start, so once the true chain lands on a cut of the
+    // next segment the two agree from there on. That usually happens within
+    // a few chunks; until it does, the chain is extended serially.
+    const std::uint64_t segment_size =
+        std::max<std::uint64_t>(16 * params.maximum, (size + 4 * thread_count - 1) / (4 * thread_count));
+    const auto segment_count = static_cast<std::size_t>((size + segment_size - 1) / segment_size);
+    std::vector<std::vector<std::uint64_t>> segments(segment_count);
+    if (!parallel_for_each_index(
+            segment_count, thread_count,
+            [&](std::size_t index, std::string& task_error) {
+                const std::uint64_t begin = index * segment_size;
+                const std::uint64_t stop = std::min(size, begin + segment_size);
+                return scan_chunks(input, size, chunker, params.maximum, begin, stop,
+                                   [&](std::uint64_t end) {
+                                       segments[index].push_back(end);
+                                       return true;
+                                   },
+                                   task_error);
+            },
+            error)) {
+        return false;
+    }
+
+    chunk_ends = std::move(segments.front());
+    for (std::size_t index = 1; index < segment_count; ++index) {
+        const auto& speculative = segments[index];
+        if (chunk_ends.back() >= speculative.back()) {
+            continue;
+        }
+        const auto find = [&](std::uint64_t end) {
+            const auto it = std::lower_bound(speculative.begin(), speculative.end(), end);
+            return (it != speculative.end() && *it == end) ? it : speculative.end();
+        };
+        auto joined = find(chunk_ends.back());
+        if (joined == speculative.end() &&
+            !scan_chunks(input, size, chunker, params.maximum, chunk_ends.back(), speculative.back(),
+                         [&](std::uint64_t end) {
+                             chunk_ends.push_back(end);
+                             joined = find(end);
+                             return joined == speculative.end();
+                         },
+                         error)) {
+            return false;
+        }
+        if (joined != speculative.end()) {
+            chunk_ends.insert(chunk_ends.end(), joined + 1, speculative.end());
+        }
+    }
+    return true;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "services/file_io.hpp"
+
+namespace humpty::services {
+
+// Bounds for content-defined chunks. Cut points are chosen so that chunks
+// average about `average` bytes; only the last chunk of the input may be
+// shorter than `minimum`.
+struct CdcParams {
+    std::uint64_t minimum = 0;
+    std::uint64_t average = 0;
+    std::uint64_t maximum = 0;
+};
+
+constexpr std::uint64_t kCdcMinimumChunk = 64;
+constexpr std::uint64_t kCdcMaximumChunk = 256 * 1024 * 1024;
+
+// Fills in a zero minimum or maximum as average / 4 and average * 4.
+CdcParams make_cdc_params(std::uint64_t average, std::uint64_t minimum, std::uint64_t maximum);
+bool is_valid_cdc_params(const CdcParams& params);
+
+// FastCDC-style chunker: a gear hash rolls over each chunk, starting after
+// its first `minimum` bytes, and a cut is made where the top bits of the
+// hash are zero. Before `average` the test uses one bit more than
+// log2(average) and after it one bit less, which keeps chunk sizes close to
+// the average.
+class GearChunker {
+public:
+    explicit GearChunker(const CdcParams& params);
+
+    // `data` starts at a chunk boundary. Returns the length of the chunk that
+    // starts there; it is data.size() when no cut is found, so callers pass
+    // `maximum` bytes, or all that is left of the input.
+    [[nodiscard]] std::size_t find_cut(std::span<const std::byte> data) const;
+
+private:
+    std::size_t minimum_;
+    std::size_t average_;
+    std::size_t maximum_;
+    std::uint64_t mask_small_;
+    std::uint64_t mask_large_;
+};
+
+// Scans the first `size` bytes of `input` through read-only mappings and
+// stores the end offset of every content-defined chunk in `chunk_ends`. With
+// more than one thread, segments of the input are scanned concurrently; the
+// cuts are the same as for a single thread.
+bool find_cdc_boundaries(const FileHandle& input,
+                         std::uint64_t size,
+                         const CdcParams& params,
+                         std::size_t thread_count,
+                         std::vector<std::uint64_t>& chunk_ends,
+                         std::string& error);
+
+}  // namespace humpty::services
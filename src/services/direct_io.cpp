@@ -0,0 +1,221 @@
+#include "services/direct_io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "services/transfer_stats.hpp"
+
+namespace humpty::services {
+namespace {
+
+constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+
+std::uint64_t align_down(std::uint64_t value) {
+    return value - (value % kDirectIoAlignment);
+}
+
+std::uint64_t align_up(std::uint64_t value) {
+    return align_down(value + kDirectIoAlignment - 1);
+}
+
+bool is_aligned_address(const void* address) {
+    return reinterpret_cast<std::uintptr_t>(address) % kDirectIoAlignment == 0;
+}
+
+}  // namespace
+
+bool is_valid_direct_buffer_size(std::size_t size) {
+    return size != 0 && size % kDirectIoAlignment == 0;
+}
+
+AlignedBufferPool::AlignedBufferPool(std::size_t buffer_count, std::size_t buffer_size) : buffer_size_(buffer_size) {
+    if (buffer_count == 0 || !is_valid_direct_buffer_size(buffer_size)) {
+        return;
+    }
+
+    const bool huge = buffer_size % kHugePageSize == 0;
+    const std::size_t length = buffer_count * buffer_size;
+    mapping_length_ = length + (huge ? kHugePageSize : 0);
+    void* mapping = ::mmap(nullptr, mapping_length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        mapping_length_ = 0;
+        return;
+    }
+
+    mapping_ = mapping;
+    auto address = reinterpret_cast<std::uintptr_t>(mapping);
+    if (huge) {
+        address = (address + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+#if defined(MADV_HUGEPAGE)
+        (void)::madvise(reinterpret_cast<void*>(address), length, MADV_HUGEPAGE);
+#endif
+    }
+    base_ = reinterpret_cast<std::byte*>(address);
+
+    free_.reserve(buffer_count);
+    for (std::size_t i = buffer_count; i > 0; --i) {
+        free_.push_back(i - 1);
+    }
+}
+
+AlignedBufferPool::~AlignedBufferPool() {
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, mapping_length_);
+    }
+}
+
+AlignedBufferPool::Lease AlignedBufferPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_.wait(lock, [&] { return !free_.empty(); });
+    const std::size_t index = free_.back();
+    free_.pop_back();
+    return Lease(this, index);
+}
+
+void AlignedBufferPool::release(std::size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(index);
+    }
+    released_.notify_one();
+}
+
+AlignedBufferPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)), index_(other.index_) {}
+
+AlignedBufferPool::Lease::~Lease() {
+    if (pool_ != nullptr) {
+        pool_->release(index_);
+    }
+}
+
+std::span<std::byte> AlignedBufferPool::Lease::bytes() const {
+    return {pool_->base_ + index_ * pool_->buffer_size_, pool_->buffer_size_};
+}
+
+bool direct_read_range(const FileHandle& input,
+                       std::uint64_t offset,
+                       std::uint64_t length,
+                       std::span<std::byte> buffer,
+                       const std::function<bool(std::span<const std::byte> data, std::string& error)>& on_data,
+                       std::string_view source_name,
+                       std::string& error) {
+    const std::uint64_t end = offset + length;
+    std::uint64_t position = align_down(offset);
+
+    while (position < end) {
+        const auto want = static_cast<std::size_t>(
+            std::min<std::uint64_t>(buffer.size(), align_up(end) - position));
+
+        // A read that stops off a block boundary has reached end of file;
+        // retrying from there would be an unaligned O_DIRECT read.
+        std::size_t got = 0;
+        while (got < want) {
+            const ssize_t count =
+                ::pread(input.fd(), buffer.data() + got, want - got, static_cast<off_t>(position + got));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                error = "Failed reading file: " + std::string(source_name);
+                return false;
+            }
+            stats::count_read(static_cast<std::uint64_t>(count));
+            got += static_cast<std::size_t>(count);
+            if (count == 0 || got % kDirectIoAlignment != 0) {
+                break;
+            }
+        }
+
+        const std::uint64_t first = std::max(position, offset);
+        const std::uint64_t last = std::min(position + got, end);
+        if (last < std::min(position + want, end)) {
+            error = "Unexpected end of file: " + std::string(source_name);
+            return false;
+        }
+        if (!on_data(buffer.subspan(static_cast<std::size_t>(first - position), static_cast<std::size_t>(last - first)),
+                     error)) {
+            return false;
+        }
+        position += want;
+    }
+    return true;
+}
+
+DirectWriter::DirectWriter(const FileHandle& direct,
+                           const FileHandle& buffered,
+                           std::uint64_t offset,
+                           std::span<std::byte> staging)
+    : direct_(direct),
+      buffered_(buffered),
+      offset_(offset),
+      head_remaining_(static_cast<std::size_t>(align_up(offset) - offset)),
+      staging_(staging) {}
+
+bool DirectWriter::write(std::span<const std::byte> data) {
+    if (head_remaining_ > 0 && !data.empty()) {
+        const auto head = data.first(std::min(head_remaining_, data.size()));
+        if (!buffered_.write_all_at(head, offset_)) {
+            return false;
+        }
+        offset_ += head.size();
+        head_remaining_ -= head.size();
+        data = data.subspan(head.size());
+    }
+
+    if (staged_ == 0 && is_aligned_address(data.data())) {
+        const auto blocks = data.first(static_cast<std::size_t>(align_down(data.size())));
+        if (!flush_blocks(blocks)) {
+            return false;
+        }
+        data = data.subspan(blocks.size());
+    }
+
+    while (!data.empty()) {
+        const std::size_t take = std::min(staging_.size() - staged_, data.size());
+        std::memcpy(staging_.data() + staged_, data.data(), take);
+        staged_ += take;
+        data = data.subspan(take);
+        if (staged_ == staging_.size()) {
+            if (!flush_blocks(staging_)) {
+                return false;
+            }
+            staged_ = 0;
+        }
+    }
+    return true;
+}
+
+bool DirectWriter::finish() {
+    const auto staged = std::span<const std::byte>(staging_.data(), staged_);
+    const auto blocks = staged.first(static_cast<std::size_t>(align_down(staged.size())));
+    if (!flush_blocks(blocks)) {
+        return false;
+    }
+
+    const auto tail = staged.subspan(blocks.size());
+    if (!tail.empty() && !buffered_.write_all_at(tail, offset_)) {
+        return false;
+    }
+    offset_ += tail.size();
+    staged_ = 0;
+    return true;
+}
+
+bool DirectWriter::flush_blocks(std::span<const std::byte> blocks) {
+    if (blocks.empty()) {
+        return true;
+    }
+    if (!direct_.write_all_at(blocks, offset_)) {
+        return false;
+    }
+    offset_ += blocks.size();
+    return true;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "services/file_io.hpp"
+
+namespace humpty::services {
+
+// O_DIRECT transfers must start at, and be sized in, multiples of the
+// device's logical block size; 4 KiB covers the devices we run on.
+constexpr std::size_t kDirectIoAlignment = 4096;
+constexpr std::size_t kDefaultDirectBufferSize = 4 * 1024 * 1024;
+
+bool is_valid_direct_buffer_size(std::size_t size);
+
+// Equally sized buffers carved out of one anonymous mapping. Buffers are
+// page aligned; when the size is a multiple of 2 MiB they are also hugepage
+// aligned and the mapping is marked MADV_HUGEPAGE.
+class AlignedBufferPool {
+public:
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        [[nodiscard]] std::span<std::byte> bytes() const;
+
+    private:
+        friend class AlignedBufferPool;
+        Lease(AlignedBufferPool* pool, std::size_t index) : pool_(pool), index_(index) {}
+
+        AlignedBufferPool* pool_;
+        std::size_t index_;
+    };
+
+    AlignedBufferPool(std::size_t buffer_count, std::size_t buffer_size);
+    ~AlignedBufferPool();
+
+    AlignedBufferPool(const AlignedBufferPool&) = delete;
+    AlignedBufferPool& operator=(const AlignedBufferPool&) = delete;
+
+    [[nodiscard]] bool is_valid() const { return base_ != nullptr; }
+    [[nodiscard]] std::size_t buffer_size() const { return buffer_size_; }
+
+    // Blocks until a buffer is free.
+    Lease acquire();
+
+private:
+    void release(std::size_t index);
+
+    void* mapping_ = nullptr;
+    std::size_t mapping_length_ = 0;
+    std::byte* base_ = nullptr;
+    std::size_t buffer_size_ = 0;
+    std::mutex mutex_;
+    std::condition_variable released_;
+    std::vector<std::size_t> free_;
+};
+
+// Reads [offset, offset + length) of `input` with block-aligned reads into
+// `buffer` and passes the requested bytes to on_data in order.
+bool direct_read_range(const FileHandle& input,
+                       std::uint64_t offset,
+                       std::uint64_t length,
+                       std::span<std::byte> buffer,
+                       const std::function<bool(std::span<const std::byte> data, std::string& error)>& on_data,
+                       std::string_view source_name,
+                       std::string& error);
+
+// Writes a contiguous byte stream to a file starting at `offset`. Whole
+// aligned blocks go through `direct`; the unaligned head and tail go through
+// `buffered`, which must refer to the same file. Data is staged in `staging`
+// unless it already sits at an aligned address.
+class DirectWriter {
+public:
+    DirectWriter(const FileHandle& direct,
+                 const FileHandle& buffered,
+                 std::uint64_t offset,
+                 std::span<std::byte> staging);
+
+    bool write(std::span<const std::byte> data);
+    bool finish();
+
+private:
+    bool flush_blocks(std::span<const std::byte> blocks);
+
+    const FileHandle& direct_;
+    const FileHandle& buffered_;
+    std::uint64_t offset_;
+    std::size_t head_remaining_;
+    std::span<std::byte> staging_;
+    std::size_t staged_ = 0;
+};
+
+}  // namespace humpty::services
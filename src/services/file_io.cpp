@@ -0,0 +1,251 @@
+#include "services/file_io.hpp"
+
+#include <cerrno>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "services/transfer_stats.hpp"
+
+namespace humpty::services {
+
+std::string_view io_engine_name(IoEngine engine) {
+    switch (engine) {
+    case IoEngine::Stream:
+        return "stream";
+    case IoEngine::Mmap:
+        return "mmap";
+    case IoEngine::Uring:
+        return "uring";
+    }
+    return "stream";
+}
+
+bool parse_io_engine(std::string_view name, IoEngine& engine) {
+    if (name == "stream") {
+        engine = IoEngine::Stream;
+        return true;
+    }
+    if (name == "mmap") {
+        engine = IoEngine::Mmap;
+        return true;
+    }
+    if (name == "uring") {
+        engine = IoEngine::Uring;
+        return true;
+    }
+    return false;
+}
+
+bool is_standard_stream(const std::filesystem::path& path) {
+    return path == "-";
+}
+
+FileHandle::~FileHandle() {
+    close();
+}
+
+FileHandle::FileHandle(FileHandle&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+
+FileHandle& FileHandle::operator=(FileHandle&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+bool FileHandle::open_read(const std::filesystem::path& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    return opened();
+}
+
+bool FileHandle::open_write(const std::filesystem::path& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    return opened();
+}
+
+bool FileHandle::open_read_write(const std::filesystem::path& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    return opened();
+}
+
+bool FileHandle::open_update(const std::filesystem::path& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    return opened();
+}
+
+namespace {
+
+int open_direct(const std::filesystem::path& path, int flags) {
+#if defined(O_DIRECT)
+    const int fd = ::open(path.c_str(), flags | O_DIRECT | O_CLOEXEC);
+    if (fd >= 0 || errno != EINVAL) {
+        return fd;
+    }
+#endif
+    return ::open(path.c_str(), flags | O_CLOEXEC);
+}
+
+}  // namespace
+
+bool FileHandle::open_read_direct(const std::filesystem::path& path) {
+    close();
+    fd_ = open_direct(path, O_RDONLY);
+    return opened();
+}
+
+bool FileHandle::open_write_direct(const std::filesystem::path& path) {
+    close();
+    fd_ = open_direct(path, O_WRONLY);
+    return opened();
+}
+
+bool FileHandle::open_standard_input() {
+    close();
+    fd_ = ::fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 0);
+    return opened();
+}
+
+bool FileHandle::open_standard_output() {
+    close();
+    fd_ = ::fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+    return opened();
+}
+
+bool FileHandle::opened() const {
+    if (fd_ < 0) {
+        return false;
+    }
+    stats::count_open();
+    return true;
+}
+
+void FileHandle::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool FileHandle::size(std::uint64_t& out_size) const {
+    struct stat info {};
+    if (::fstat(fd_, &info) != 0) {
+        return false;
+    }
+    out_size = static_cast<std::uint64_t>(info.st_size);
+    return true;
+}
+
+bool FileHandle::preallocate(std::uint64_t size) const {
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        return false;
+    }
+#if defined(__linux__)
+    const int rc = ::posix_fallocate(fd_, 0, static_cast<off_t>(size));
+    return rc == 0 || rc == EOPNOTSUPP || rc == EINVAL;
+#else
+    return true;
+#endif
+}
+
+void FileHandle::advise_sequential() const {
+#if defined(POSIX_FADV_SEQUENTIAL)
+    (void)::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+void FileHandle::advise_willneed() const {
+#if defined(POSIX_FADV_WILLNEED)
+    (void)::posix_fadvise(fd_, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+}
+
+bool FileHandle::read_exact(std::span<std::byte> buffer) const {
+    while (!buffer.empty()) {
+        const ssize_t got = ::read(fd_, buffer.data(), buffer.size());
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        stats::count_read(static_cast<std::uint64_t>(got));
+        buffer = buffer.subspan(static_cast<std::size_t>(got));
+    }
+    return true;
+}
+
+bool FileHandle::read_full(std::span<std::byte> buffer, std::size_t& got) const {
+    got = 0;
+    while (got < buffer.size()) {
+        const ssize_t read = ::read(fd_, buffer.data() + got, buffer.size() - got);
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read < 0) {
+            return false;
+        }
+        if (read == 0) {
+            break;
+        }
+        stats::count_read(static_cast<std::uint64_t>(read));
+        got += static_cast<std::size_t>(read);
+    }
+    return true;
+}
+
+bool FileHandle::read_exact_at(std::span<std::byte> buffer, std::uint64_t offset) const {
+    while (!buffer.empty()) {
+        const ssize_t got = ::pread(fd_, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        stats::count_read(static_cast<std::uint64_t>(got));
+        buffer = buffer.subspan(static_cast<std::size_t>(got));
+        offset += static_cast<std::uint64_t>(got);
+    }
+    return true;
+}
+
+bool FileHandle::write_all(std::span<const std::byte> data) const {
+    while (!data.empty()) {
+        const ssize_t put = ::write(fd_, data.data(), data.size());
+        if (put < 0 && errno == EINTR) {
+            continue;
+        }
+        if (put <= 0) {
+            return false;
+        }
+        stats::count_write(static_cast<std::uint64_t>(put));
+        data = data.subspan(static_cast<std::size_t>(put));
+    }
+    return true;
+}
+
+bool FileHandle::write_all_at(std::span<const std::byte> data, std::uint64_t offset) const {
+    while (!data.empty()) {
+        const ssize_t put = ::pwrite(fd_, data.data(), data.size(), static_cast<off_t>(offset));
+        if (put < 0 && errno == EINTR) {
+            continue;
+        }
+        if (put <= 0) {
+            return false;
+        }
+        stats::count_write(static_cast<std::uint64_t>(put));
+        data = data.subspan(static_cast<std::size_t>(put));
+        offset += static_cast<std::uint64_t>(put);
+    }
+    return true;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+namespace humpty::services {
+
+enum class IoEngine {
+    Stream,
+    Mmap,
+    Uring,
+};
+
+std::string_view io_engine_name(IoEngine engine);
+bool parse_io_engine(std::string_view name, IoEngine& engine);
+
+// "-" in place of an input or output path means standard input or output.
+bool is_standard_stream(const std::filesystem::path& path);
+
+class FileHandle {
+public:
+    FileHandle() = default;
+    ~FileHandle();
+
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+    FileHandle(FileHandle&& other) noexcept;
+    FileHandle& operator=(FileHandle&& other) noexcept;
+
+    bool open_read(const std::filesystem::path& path);
+    bool open_write(const std::filesystem::path& path);
+    bool open_read_write(const std::filesystem::path& path);
+    // Like open_read_write() but keeps the existing contents.
+    bool open_update(const std::filesystem::path& path);
+    // O_DIRECT variants. When the filesystem rejects O_DIRECT the file is
+    // opened for ordinary buffered I/O instead. open_write_direct() neither
+    // creates nor truncates, so it can sit beside a buffered handle.
+    bool open_read_direct(const std::filesystem::path& path);
+    bool open_write_direct(const std::filesystem::path& path);
+    // Duplicates the standard descriptor, so closing the handle leaves it
+    // open.
+    bool open_standard_input();
+    bool open_standard_output();
+    void close();
+
+    [[nodiscard]] bool is_open() const { return fd_ >= 0; }
+    [[nodiscard]] int fd() const { return fd_; }
+
+    bool size(std::uint64_t& out_size) const;
+    bool preallocate(std::uint64_t size) const;
+
+    // Read-ahead hints; failures are ignored.
+    void advise_sequential() const;
+    void advise_willneed() const;
+
+    bool read_exact(std::span<std::byte> buffer) const;
+    // Reads until `buffer` is full or the input ends; `got` falls short of
+    // the buffer only at the end. Suits pipes, which return short reads.
+    bool read_full(std::span<std::byte> buffer, std::size_t& got) const;
+    bool read_exact_at(std::span<std::byte> buffer, std::uint64_t offset) const;
+    bool write_all(std::span<const std::byte> data) const;
+    bool write_all_at(std::span<const std::byte> data, std::uint64_t offset) const;
+
+private:
+    // Result of an open; counts it for TransferStats.
+    bool opened() const;
+
+    int fd_ = -1;
+};
+
+}  // namespace humpty::services
@@ -0,0 +1,272 @@
+#include "services/io_backend.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <utility>
+
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "services/transfer_stats.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HUMPTY_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+namespace humpty::services {
+namespace {
+
+void count_request(const IoRequest& request, std::uint64_t bytes) {
+    if (request.operation == IoOperation::Read) {
+        stats::count_read(bytes);
+    } else {
+        stats::count_write(bytes);
+    }
+}
+
+class BlockingIoBackend final : public IoBackend {
+public:
+    bool register_buffers(std::span<const std::span<std::byte>>) override { return true; }
+
+    bool submit(const IoRequest& request) override {
+        ssize_t result = 0;
+        do {
+            result = (request.operation == IoOperation::Read)
+                         ? ::pread(request.fd, request.buffer.data(), request.buffer.size(),
+                                   static_cast<off_t>(request.offset))
+                         : ::pwrite(request.fd, request.buffer.data(), request.buffer.size(),
+                                    static_cast<off_t>(request.offset));
+        } while (result < 0 && errno == EINTR);
+        if (result > 0) {
+            count_request(request, static_cast<std::uint64_t>(result));
+        }
+
+        ready_.push_back({request.tag, result < 0 ? -static_cast<std::int64_t>(errno) : result});
+        return true;
+    }
+
+    bool wait(std::size_t, std::vector<IoCompletion>& completions) override {
+        completions.insert(completions.end(), ready_.begin(), ready_.end());
+        ready_.clear();
+        return true;
+    }
+
+    [[nodiscard]] std::string_view name() const override { return "blocking"; }
+
+private:
+    std::vector<IoCompletion> ready_;
+};
+
+#if defined(HUMPTY_HAVE_IO_URING)
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+template <typename T>
+T* ring_field(void* base, std::uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+class UringIoBackend final : public IoBackend {
+public:
+    ~UringIoBackend() override {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != nullptr) {
+            ::munmap(sq_ring_, sq_ring_size_);
+        }
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+        }
+    }
+
+    bool open(unsigned queue_depth) {
+        io_uring_params params{};
+        ring_fd_ = sys_io_uring_setup(queue_depth, &params);
+        if (ring_fd_ < 0) {
+            return false;
+        }
+
+        sq_ring_size_ = params.sq_off.array + (params.sq_entries * sizeof(std::uint32_t));
+        cq_ring_size_ = params.cq_off.cqes + (params.cq_entries * sizeof(io_uring_cqe));
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+            cq_ring_size_ = sq_ring_size_;
+        }
+
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                          IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            sq_ring_ = nullptr;
+            return false;
+        }
+        cq_ring_ = single_mmap ? sq_ring_
+                               : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                        ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            return false;
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                            IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        sq_tail_ = ring_field<unsigned>(sq_ring_, params.sq_off.tail);
+        sq_mask_ = *ring_field<unsigned>(sq_ring_, params.sq_off.ring_mask);
+        sq_array_ = ring_field<unsigned>(sq_ring_, params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+        cq_head_ = ring_field<unsigned>(cq_ring_, params.cq_off.head);
+        cq_tail_ = ring_field<unsigned>(cq_ring_, params.cq_off.tail);
+        cq_mask_ = *ring_field<unsigned>(cq_ring_, params.cq_off.ring_mask);
+        cqes_ = ring_field<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+        return true;
+    }
+
+    bool register_buffers(std::span<const std::span<std::byte>> buffers) override {
+        std::vector<iovec> vectors;
+        vectors.reserve(buffers.size());
+        for (const auto& buffer : buffers) {
+            vectors.push_back({buffer.data(), buffer.size()});
+        }
+        buffers_registered_ = sys_io_uring_register(ring_fd_, IORING_REGISTER_BUFFERS, vectors.data(),
+                                                    static_cast<unsigned>(vectors.size())) == 0;
+        // Unregistered buffers still work through the plain opcodes.
+        return true;
+    }
+
+    bool submit(const IoRequest& request) override {
+        if (queued_ >= sq_entries_ && !enter(0)) {
+            return false;
+        }
+
+        const unsigned tail = *sq_tail_;
+        const unsigned index = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[index];
+        sqe = {};
+
+        const bool fixed = buffers_registered_ && request.buffer_index >= 0;
+        if (request.operation == IoOperation::Read) {
+            sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        } else {
+            sqe.opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        }
+        sqe.fd = request.fd;
+        sqe.off = request.offset;
+        sqe.addr = reinterpret_cast<std::uint64_t>(request.buffer.data());
+        sqe.len = static_cast<std::uint32_t>(request.buffer.size());
+        if (fixed) {
+            sqe.buf_index = static_cast<std::uint16_t>(request.buffer_index);
+        }
+        sqe.user_data = request.tag;
+
+        // Counted as submitted; the completion may move fewer bytes.
+        count_request(request, request.buffer.size());
+        sq_array_[index] = index;
+        std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+        ++queued_;
+        return true;
+    }
+
+    bool wait(std::size_t min_completions, std::vector<IoCompletion>& completions) override {
+        if (!enter(static_cast<unsigned>(min_completions))) {
+            return false;
+        }
+
+        unsigned head = std::atomic_ref<unsigned>(*cq_head_).load(std::memory_order_relaxed);
+        const unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            completions.push_back({cqe.user_data, cqe.res});
+            ++head;
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] std::string_view name() const override { return "io_uring"; }
+
+private:
+    bool enter(unsigned min_complete) {
+        const unsigned flags = (min_complete != 0) ? IORING_ENTER_GETEVENTS : 0;
+        while (true) {
+            const int submitted = sys_io_uring_enter(ring_fd_, queued_, min_complete, flags);
+            if (submitted < 0 && errno == EINTR) {
+                continue;
+            }
+            if (submitted < 0) {
+                return false;
+            }
+            queued_ -= std::min(queued_, static_cast<unsigned>(submitted));
+            return true;
+        }
+    }
+
+    int ring_fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    std::size_t sq_ring_size_ = 0;
+    std::size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned queued_ = 0;
+    bool buffers_registered_ = false;
+};
+
+#endif
+
+}  // namespace
+
+std::unique_ptr<IoBackend> make_blocking_io_backend() {
+    return std::make_unique<BlockingIoBackend>();
+}
+
+std::unique_ptr<IoBackend> make_uring_io_backend(unsigned queue_depth) {
+#if defined(HUMPTY_HAVE_IO_URING)
+    auto backend = std::make_unique<UringIoBackend>();
+    if (backend->open(queue_depth)) {
+        return backend;
+    }
+#else
+    (void)queue_depth;
+#endif
+    return nullptr;
+}
+
+std::unique_ptr<IoBackend> make_io_backend(unsigned queue_depth) {
+    if (auto backend = make_uring_io_backend(queue_depth)) {
+        return backend;
+    }
+    return make_blocking_io_backend();
+}
+
+}  // namespace humpty::services
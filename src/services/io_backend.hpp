@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace humpty::services {
+
+enum class IoOperation {
+    Read,
+    Write,
+};
+
+struct IoRequest {
+    IoOperation operation = IoOperation::Read;
+    int fd = -1;
+    std::uint64_t offset = 0;
+    std::span<std::byte> buffer;
+    int buffer_index = -1;
+    std::uint64_t tag = 0;
+};
+
+struct IoCompletion {
+    std::uint64_t tag = 0;
+    std::int64_t result = 0;
+};
+
+// Positional read/write submission queue. Requests are queued with submit()
+// and handed to the device by wait(), which blocks until at least
+// `min_completions` results are available; results are bytes transferred or
+// a negated errno.
+class IoBackend {
+public:
+    virtual ~IoBackend() = default;
+
+    virtual bool register_buffers(std::span<const std::span<std::byte>> buffers) = 0;
+    virtual bool submit(const IoRequest& request) = 0;
+    virtual bool wait(std::size_t min_completions, std::vector<IoCompletion>& completions) = 0;
+    [[nodiscard]] virtual std::string_view name() const = 0;
+};
+
+std::unique_ptr<IoBackend> make_blocking_io_backend();
+std::unique_ptr<IoBackend> make_uring_io_backend(unsigned queue_depth);
+
+// io_uring when the kernel allows it, otherwise the blocking backend.
+std::unique_ptr<IoBackend> make_io_backend(unsigned queue_depth);
+
+}  // namespace humpty::services
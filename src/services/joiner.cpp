@@ -1,107 +1,954 @@
 #include "services/joiner.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
-#include <fstream>
+#include <cstring>
+#include <map>
+#include <mutex>
 #include <span>
+#include <vector>
 
 #include "models/manifest.hpp"
+#include "models/manifest_reader.hpp"
+#include "services/async_copy.hpp"
+#include "services/checkpoint.hpp"
 #include "services/checksums.hpp"
+#include "services/chunk_codec.hpp"
+#include "services/direct_io.hpp"
+#include "services/file_io.hpp"
+#include "services/io_backend.hpp"
+#include "services/kernel_copy.hpp"
+#include "services/mapped_file.hpp"
+#include "services/pipeline.hpp"
+#include "services/progress.hpp"
+#include "services/transfer_stats.hpp"
+#include "services/workers.hpp"
 
 namespace humpty::services {
 namespace {
 
 constexpr std::size_t kBufferSize = 64 * 1024;
+constexpr std::size_t kAsyncSegmentSize = 256 * 1024;
 
-std::string hash_state_to_hex(std::uint64_t state) {
-    return fnv1a64_hex({}, state);
-}
+// Hands out chunk entries as the join consumes them, so copying starts
+// before the manifest is fully parsed, and records finished chunks in the
+// checkpoint. Checks that need every entry (the declared count, the sizes
+// adding up, a combined source checksum) run in finish(). next() and
+// complete() may be called from several workers.
+class ChunkFeed {
+public:
+    ChunkFeed(humpty::models::ManifestReader& reader,
+              const humpty::models::Manifest& manifest,
+              bool combine_digest,
+              const CompletedChunks& completed,
+              JoinCheckpoint& checkpoint,
+              ProgressReporter& progress)
+        : reader_(reader),
+          manifest_(manifest),
+          combine_digest_(combine_digest),
+          completed_(completed),
+          checkpoint_(checkpoint),
+          progress_(progress) {}
 
-}  // namespace
+    // Entries a resumed join already wrote are skipped; `have` is cleared
+    // once the manifest has no entries left.
+    bool next_pending(humpty::models::Chunk& chunk, bool& have, std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (;;) {
+            have = false;
+            if (reader_done_) {
+                return true;
+            }
+            const stats::ScopedTimer timer(stats::Timer::Manifest);
+            if (!reader_.next(chunk, reader_done_, error)) {
+                return false;
+            }
+            if (reader_done_) {
+                return true;
+            }
+            if (chunk.offset > manifest_.source_size || chunk.size > manifest_.source_size - chunk.offset) {
+                error = "Chunk range exceeds manifest source_size: " + chunk.file_name;
+                return false;
+            }
+            total_size_ += chunk.size;
+            if (combine_digest_) {
+                combiner_.add(chunk.offset, chunk.size, chunk.checksum);
+            }
+            if (!is_completed(chunk)) {
+                have = true;
+                return true;
+            }
+            ++skipped_;
+        }
+    }
 
-bool join_file(const JoinRequest& request, JoinResult& result, std::string& error) {
-    result = {};
-    error.clear();
+    bool next(humpty::models::Chunk& chunk, std::string& error) {
+        bool have = false;
+        if (!next_pending(chunk, have, error)) {
+            return false;
+        }
+        if (!have) {
+            error = "Manifest chunk count does not match chunk entries.";
+            return false;
+        }
+        return true;
+    }
 
-    std::string manifest_error;
-    const auto manifest_opt = humpty::models::read_manifest(request.manifest_path, manifest_error);
-    if (!manifest_opt.has_value()) {
-        error = manifest_error;
-        return false;
+    // Progress counts bytes as the join functions copy them and chunks as
+    // they complete.
+    void copied(std::uint64_t bytes) { progress_.add_bytes(bytes); }
+
+    bool complete(const humpty::models::Chunk& chunk, std::string& error) {
+        progress_.add_chunk();
+        return checkpoint_.record(chunk, error);
     }
 
-    const humpty::models::Manifest& manifest = *manifest_opt;
-    const auto base_dir = request.manifest_path.parent_path();
+    [[nodiscard]] std::size_t skipped() const { return skipped_; }
+
+    bool finish(std::string& error) {
+        if (!reader_done_) {
+            const stats::ScopedTimer timer(stats::Timer::Manifest);
+            humpty::models::Chunk extra;
+            if (!reader_.next(extra, reader_done_, error)) {
+                return false;
+            }
+            if (!reader_done_) {
+                error = "Manifest chunk count does not match chunk entries.";
+                return false;
+            }
+        }
+        if (total_size_ != manifest_.source_size) {
+            error = "Output size does not match manifest source_size.";
+            return false;
+        }
+        // A combined source checksum covers the chunk checksums, which are
+        // each verified against the data as it is copied.
+        if (combine_digest_ && combiner_.hex() != manifest_.source_checksum) {
+            error = "Source checksum mismatch for manifest chunk list.";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool is_completed(const humpty::models::Chunk& chunk) const {
+        const auto entry = completed_.find(chunk.index);
+        return entry != completed_.end() && entry->second.offset == chunk.offset &&
+               entry->second.size == chunk.size && entry->second.checksum == chunk.checksum;
+    }
 
-    std::ofstream output(request.output_file, std::ios::binary | std::ios::trunc);
-    if (!output.is_open()) {
+    humpty::models::ManifestReader& reader_;
+    const humpty::models::Manifest& manifest_;
+    bool combine_digest_;
+    const CompletedChunks& completed_;
+    JoinCheckpoint& checkpoint_;
+    ProgressReporter& progress_;
+    std::mutex mutex_;
+    bool reader_done_ = false;
+    std::uint64_t total_size_ = 0;
+    std::size_t skipped_ = 0;
+    ChunkDigestCombiner combiner_;
+};
+
+// Opens the output of the joins that write it front to back, which may be
+// standard output.
+bool open_stream_output(const JoinRequest& request, FileHandle& output, std::string& error) {
+    const bool opened =
+        is_standard_stream(request.output_file) ? output.open_standard_output() : output.open_write(request.output_file);
+    if (!opened) {
         error = "Failed to open output file: " + request.output_file.string();
         return false;
     }
+    return true;
+}
 
+bool join_sequential(const JoinRequest& request,
+                     const humpty::models::Manifest& manifest,
+                     std::size_t chunk_count,
+                     ChunkFeed& feed,
+                     std::uint64_t& total_bytes_written,
+                     std::string& error) {
+    const auto base_dir = humpty::models::chunk_directory(manifest, request.manifest_path);
+
+    FileHandle output;
+    if (!open_stream_output(request, output, error)) {
+        return false;
+    }
+
+    const bool stream_digest = manifest.source_digest == humpty::models::SourceDigest::Stream;
     std::array<std::byte, kBufferSize> buffer{};
-    std::uint64_t source_hash_state = 14695981039346656037ULL;
-    std::uint64_t total_bytes_written = 0;
+    const stats::BufferCharge buffer_charge(buffer.size());
+    Hasher source_hasher(manifest.checksum_algorithm);
 
-    for (const auto& chunk : manifest.chunks) {
+    humpty::models::Chunk chunk;
+    for (std::size_t i = 0; i < chunk_count; ++i) {
+        if (!feed.next(chunk, error)) {
+            return false;
+        }
         const auto chunk_path = base_dir / chunk.file_name;
-        std::ifstream chunk_in(chunk_path, std::ios::binary);
-        if (!chunk_in.is_open()) {
+        FileHandle chunk_in;
+        if (!chunk_in.open_read(chunk_path)) {
             error = "Failed to open chunk file: " + chunk_path.string();
             return false;
         }
 
-        std::uint64_t chunk_hash_state = 14695981039346656037ULL;
-        std::uint64_t chunk_bytes_read = 0;
-
-        while (chunk_bytes_read < chunk.size) {
-            const std::uint64_t chunk_remaining = chunk.size - chunk_bytes_read;
-            const std::size_t to_read = static_cast<std::size_t>(
-                (chunk_remaining < static_cast<std::uint64_t>(buffer.size())) ? chunk_remaining : buffer.size());
-
-            chunk_in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(to_read));
-            const std::streamsize got = chunk_in.gcount();
-            if (got <= 0) {
-                error = "Unexpected end of chunk: " + chunk_path.string();
+        Hasher chunk_hasher(manifest.checksum_algorithm);
+        auto write_data = [&](std::span<const std::byte> data, std::string& data_error) {
+            if (!output.write_all(data)) {
+                data_error = "Failed writing output file: " + request.output_file.string();
                 return false;
             }
+            if (request.verify_checksums) {
+                chunk_hasher.update(data);
+                if (stream_digest) {
+                    source_hasher.update(data);
+                }
+            }
+            total_bytes_written += data.size();
+            feed.copied(data.size());
+            return true;
+        };
 
-            output.write(reinterpret_cast<const char*>(buffer.data()), got);
-            if (!output.good()) {
-                error = "Failed writing output file: " + request.output_file.string();
+        if (chunk.codec != humpty::models::ChunkCodec::None) {
+            if (!decode_chunk_file(chunk_in, chunk, write_data, error)) {
                 return false;
             }
+        } else {
+            std::uint64_t chunk_bytes_read = 0;
+            while (chunk_bytes_read < chunk.size) {
+                const std::uint64_t chunk_remaining = chunk.size - chunk_bytes_read;
+                const std::size_t to_read = static_cast<std::size_t>(
+                    (chunk_remaining < static_cast<std::uint64_t>(buffer.size())) ? chunk_remaining : buffer.size());
 
-            const auto view = std::span<const std::byte>(buffer.data(), static_cast<std::size_t>(got));
-            chunk_hash_state = fnv1a64(view, chunk_hash_state);
-            source_hash_state = fnv1a64(view, source_hash_state);
-            chunk_bytes_read += static_cast<std::uint64_t>(got);
-            total_bytes_written += static_cast<std::uint64_t>(got);
+                const auto view = std::span<std::byte>(buffer.data(), to_read);
+                if (!chunk_in.read_exact(view)) {
+                    error = "Unexpected end of chunk: " + chunk_path.string();
+                    return false;
+                }
+                if (!write_data(view, error)) {
+                    return false;
+                }
+                chunk_bytes_read += to_read;
+            }
         }
 
         if (request.verify_checksums && !chunk.checksum.empty()) {
-            const auto actual = hash_state_to_hex(chunk_hash_state);
+            const auto actual = chunk_hasher.hex();
             if (actual != chunk.checksum) {
                 error = "Chunk checksum mismatch for " + chunk.file_name;
                 return false;
             }
         }
+
+        // Writes go straight to the descriptor, so the checkpoint never gets
+        // ahead of what reached the file.
+        if (!feed.complete(chunk, error)) {
+            return false;
+        }
     }
 
-    if (request.verify_checksums && !manifest.source_checksum.empty()) {
-        const auto actual = hash_state_to_hex(source_hash_state);
+    if (stream_digest && request.verify_checksums && !manifest.source_checksum.empty()) {
+        const auto actual = source_hasher.hex();
         if (actual != manifest.source_checksum) {
             error = "Source checksum mismatch after join.";
             return false;
         }
     }
 
+    return true;
+}
+
+bool open_positional_output(const JoinRequest& request,
+                            const humpty::models::Manifest& manifest,
+                            FileHandle& output,
+                            std::string& error) {
+    // A resumed join keeps what the interrupted one already wrote.
+    const bool opened =
+        request.resume ? output.open_update(request.output_file) : output.open_read_write(request.output_file);
+    if (!opened) {
+        error = "Failed to open output file: " + request.output_file.string();
+        return false;
+    }
+    if (!output.preallocate(manifest.source_size)) {
+        error = "Failed to preallocate output file: " + request.output_file.string();
+        return false;
+    }
+    return true;
+}
+
+struct JoinContext {
+    const JoinRequest& request;
+    std::filesystem::path chunk_dir;
+    const FileHandle& output;
+    humpty::models::ChecksumAlgorithm algorithm;
+    Hasher* source_hasher = nullptr;
+    const FileHandle* direct_output = nullptr;
+    AlignedBufferPool* buffers = nullptr;
+    ChunkFeed* feed = nullptr;
+};
+
+bool check_chunk_checksum(const JoinContext& context,
+                          const humpty::models::Chunk& chunk,
+                          const Hasher& chunk_hasher,
+                          std::string& error) {
+    if (context.request.verify_checksums && !chunk.checksum.empty()) {
+        const auto actual = chunk_hasher.hex();
+        if (actual != chunk.checksum) {
+            error = "Chunk checksum mismatch for " + chunk.file_name;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool join_chunk_buffered(const JoinContext& context, const humpty::models::Chunk& chunk, std::string& error) {
+    const auto chunk_path = context.chunk_dir / chunk.file_name;
+    FileHandle chunk_in;
+    if (!chunk_in.open_read(chunk_path)) {
+        error = "Failed to open chunk file: " + chunk_path.string();
+        return false;
+    }
+
+    std::vector<std::byte> buffer(kBufferSize);
+    const stats::BufferCharge buffer_charge(buffer.size());
+    Hasher chunk_hasher(context.algorithm);
+    std::uint64_t done = 0;
+
+    while (done < chunk.size) {
+        const std::uint64_t chunk_remaining = chunk.size - done;
+        const std::size_t to_read = static_cast<std::size_t>(
+            (chunk_remaining < static_cast<std::uint64_t>(buffer.size())) ? chunk_remaining : buffer.size());
+
+        const auto view = std::span<std::byte>(buffer.data(), to_read);
+        if (!chunk_in.read_exact(view)) {
+            error = "Unexpected end of chunk: " + chunk_path.string();
+            return false;
+        }
+        if (!context.output.write_all_at(view, chunk.offset + done)) {
+            error = "Failed writing output file: " + context.request.output_file.string();
+            return false;
+        }
+
+        if (context.request.verify_checksums) {
+            chunk_hasher.update(view);
+            if (context.source_hasher != nullptr) {
+                context.source_hasher->update(view);
+            }
+        }
+        done += to_read;
+        context.feed->copied(to_read);
+    }
+
+    return check_chunk_checksum(context, chunk, chunk_hasher, error);
+}
+
+bool join_chunk_mapped(const JoinContext& context, const humpty::models::Chunk& chunk, std::string& error) {
+    const auto chunk_path = context.chunk_dir / chunk.file_name;
+    FileHandle chunk_in;
+    if (!chunk_in.open_read(chunk_path)) {
+        error = "Failed to open chunk file: " + chunk_path.string();
+        return false;
+    }
+
+    std::uint64_t chunk_file_size = 0;
+    if (!chunk_in.size(chunk_file_size) || chunk_file_size < chunk.size) {
+        error = "Unexpected end of chunk: " + chunk_path.string();
+        return false;
+    }
+
+    MappedRegion chunk_window;
+    MappedRegion output_window;
+    Hasher chunk_hasher(context.algorithm);
+    std::uint64_t done = 0;
+
+    while (done < chunk.size) {
+        const std::uint64_t chunk_remaining = chunk.size - done;
+        const std::size_t to_map = static_cast<std::size_t>(
+            (chunk_remaining < static_cast<std::uint64_t>(kMapWindowSize)) ? chunk_remaining : kMapWindowSize);
+
+        if (!chunk_window.map_read(chunk_in, done, to_map)) {
+            error = "Failed to map chunk file: " + chunk_path.string();
+            return false;
+        }
+        if (!output_window.map_write(context.output, chunk.offset + done, to_map)) {
+            error = "Failed to map output file: " + context.request.output_file.string();
+            return false;
+        }
+        chunk_window.advise_sequential();
+
+        const auto view = chunk_window.bytes();
+        std::memcpy(output_window.bytes().data(), view.data(), view.size());
+
+        if (context.request.verify_checksums) {
+            chunk_hasher.update(view);
+            if (context.source_hasher != nullptr) {
+                context.source_hasher->update(view);
+            }
+        }
+        done += to_map;
+        context.feed->copied(to_map);
+    }
+
+    return check_chunk_checksum(context, chunk, chunk_hasher, error);
+}
+
+bool join_chunk_copied(const JoinContext& context, const humpty::models::Chunk& chunk, std::string& error) {
+    const auto chunk_path = context.chunk_dir / chunk.file_name;
+    FileHandle chunk_in;
+    if (!chunk_in.open_read(chunk_path)) {
+        error = "Failed to open chunk file: " + chunk_path.string();
+        return false;
+    }
+
+    std::uint64_t chunk_file_size = 0;
+    if (!chunk_in.size(chunk_file_size) || chunk_file_size < chunk.size) {
+        error = "Unexpected end of chunk: " + chunk_path.string();
+        return false;
+    }
+
+    if (!kernel_copy_blocks(chunk_in, 0, context.output, chunk.offset, chunk.size,
+                            [&](std::uint64_t bytes) { context.feed->copied(bytes); })) {
+        error = "Failed copying chunk into output file: " + chunk_path.string();
+        return false;
+    }
+    return true;
+}
+
+bool join_chunk_direct(const JoinContext& context, const humpty::models::Chunk& chunk, std::string& error) {
+    const auto chunk_path = context.chunk_dir / chunk.file_name;
+    FileHandle chunk_in;
+    if (!chunk_in.open_read_direct(chunk_path)) {
+        error = "Failed to open chunk file: " + chunk_path.string();
+        return false;
+    }
+
+    const auto read_buffer = context.buffers->acquire();
+    const auto staging = context.buffers->acquire();
+    DirectWriter writer(*context.direct_output, context.output, chunk.offset, staging.bytes());
+    Hasher chunk_hasher(context.algorithm);
+
+    if (!direct_read_range(
+            chunk_in, 0, chunk.size, read_buffer.bytes(),
+            [&](std::span<const std::byte> data, std::string& data_error) {
+                if (!writer.write(data)) {
+                    data_error = "Failed writing output file: " + context.request.output_file.string();
+                    return false;
+                }
+                if (context.request.verify_checksums) {
+                    chunk_hasher.update(data);
+                    if (context.source_hasher != nullptr) {
+                        context.source_hasher->update(data);
+                    }
+                }
+                context.feed->copied(data.size());
+                return true;
+            },
+            chunk_path.string(), error)) {
+        return false;
+    }
+    if (!writer.finish()) {
+        error = "Failed writing output file: " + context.request.output_file.string();
+        return false;
+    }
+
+    return check_chunk_checksum(context, chunk, chunk_hasher, error);
+}
+
+// Decodes a compressed chunk file block by block and writes the blocks at
+// the chunk's offset; the checksum is checked against the decoded data.
+bool join_chunk_decoded(const JoinContext& context, const humpty::models::Chunk& chunk, std::string& error) {
+    if (chunk.codec == humpty::models::ChunkCodec::None) {
+        return join_chunk_buffered(context, chunk, error);
+    }
+
+    const auto chunk_path = context.chunk_dir / chunk.file_name;
+    FileHandle chunk_in;
+    if (!chunk_in.open_read(chunk_path)) {
+        error = "Failed to open chunk file: " + chunk_path.string();
+        return false;
+    }
+
+    Hasher chunk_hasher(context.algorithm);
+    std::uint64_t done = 0;
+    if (!decode_chunk_file(
+            chunk_in, chunk,
+            [&](std::span<const std::byte> block, std::string& block_error) {
+                if (!context.output.write_all_at(block, chunk.offset + done)) {
+                    block_error = "Failed writing output file: " + context.request.output_file.string();
+                    return false;
+                }
+                if (context.request.verify_checksums) {
+                    chunk_hasher.update(block);
+                    if (context.source_hasher != nullptr) {
+                        context.source_hasher->update(block);
+                    }
+                }
+                done += block.size();
+                context.feed->copied(block.size());
+                return true;
+            },
+            error)) {
+        return false;
+    }
+
+    return check_chunk_checksum(context, chunk, chunk_hasher, error);
+}
+
+bool join_positional(const JoinRequest& request,
+                     const humpty::models::Manifest& manifest,
+                     std::size_t chunk_count,
+                     ChunkFeed& feed,
+                     bool stream_hash,
+                     std::uint64_t& total_bytes_written,
+                     std::string& error) {
+    FileHandle output;
+    if (!open_positional_output(request, manifest, output, error)) {
+        return false;
+    }
+
+    const std::size_t thread_count = stream_hash ? 1 : request.thread_count;
+
+    // The direct handle shares the file with `output`, which keeps carrying
+    // the unaligned edges of each chunk.
+    FileHandle direct_output;
+    AlignedBufferPool buffers(request.direct_io ? 2 * thread_count : 0, request.direct_buffer_size);
+    const stats::BufferCharge buffer_charge(request.direct_io ? 2 * thread_count * request.direct_buffer_size : 0);
+    if (request.direct_io) {
+        if (!direct_output.open_write_direct(request.output_file)) {
+            error = "Failed to open output file: " + request.output_file.string();
+            return false;
+        }
+        if (!buffers.is_valid()) {
+            error = "Failed to allocate direct I/O buffers.";
+            return false;
+        }
+    }
+
+    Hasher source_hasher(manifest.checksum_algorithm);
+    const JoinContext context{request, humpty::models::chunk_directory(manifest, request.manifest_path), output,
+                              manifest.checksum_algorithm, stream_hash ? &source_hasher : nullptr,
+                              &direct_output, &buffers, &feed};
+    auto join_chunk = (request.io_engine == IoEngine::Mmap) ? join_chunk_mapped : join_chunk_buffered;
+    if (request.direct_io) {
+        join_chunk = join_chunk_direct;
+    } else if (!request.verify_checksums) {
+        join_chunk = join_chunk_copied;
+    }
+    if (manifest.codec != humpty::models::ChunkCodec::None) {
+        join_chunk = join_chunk_decoded;
+    }
+
+    if (!parallel_for_each_index(
+            chunk_count, thread_count,
+            [&](std::size_t, std::string& task_error) {
+                humpty::models::Chunk chunk;
+                bool have = false;
+                if (!feed.next_pending(chunk, have, task_error)) {
+                    return false;
+                }
+                return !have || (join_chunk(context, chunk, task_error) && feed.complete(chunk, task_error));
+            },
+            error)) {
+        return false;
+    }
+
+    if (stream_hash && source_hasher.hex() != manifest.source_checksum) {
+        error = "Source checksum mismatch after join.";
+        return false;
+    }
+
+    total_bytes_written = manifest.source_size;
+    return true;
+}
+
+bool join_async(const JoinRequest& request,
+                const humpty::models::Manifest& manifest,
+                std::size_t chunk_count,
+                ChunkFeed& feed,
+                bool stream_hash,
+                std::uint64_t& total_bytes_written,
+                std::string& error) {
+    FileHandle output;
+    if (!open_positional_output(request, manifest, output, error)) {
+        return false;
+    }
+
+    const auto base_dir = humpty::models::chunk_directory(manifest, request.manifest_path);
+    Hasher source_hasher(manifest.checksum_algorithm);
+    Hasher chunk_hasher(manifest.checksum_algorithm);
+    std::uint64_t chunk_bytes_hashed = 0;
+    struct InFlightChunk {
+        humpty::models::Chunk chunk;
+        FileHandle input;
+    };
+    std::map<std::size_t, InFlightChunk> in_flight;
+
+    AsyncCopyCallbacks callbacks;
+    callbacks.open_range = [&](std::size_t index, RangeCopy& range, std::string& range_error) {
+        humpty::models::Chunk chunk;
+        if (!feed.next(chunk, range_error)) {
+            return false;
+        }
+        const auto chunk_path = base_dir / chunk.file_name;
+        FileHandle chunk_in;
+        if (!chunk_in.open_read(chunk_path)) {
+            range_error = "Failed to open chunk file: " + chunk_path.string();
+            return false;
+        }
+
+        range.source_fd = chunk_in.fd();
+        range.source_offset = 0;
+        range.target_fd = output.fd();
+        range.target_offset = chunk.offset;
+        range.length = chunk.size;
+        range.source_name = chunk_path.string();
+        range.target_name = request.output_file.string();
+        in_flight.emplace(index, InFlightChunk{std::move(chunk), std::move(chunk_in)});
+        return true;
+    };
+    callbacks.on_data = [&](std::size_t index, std::span<const std::byte> data, std::string& data_error) {
+        chunk_hasher.update(data);
+        if (stream_hash) {
+            source_hasher.update(data);
+        }
+        chunk_bytes_hashed += data.size();
+        feed.copied(data.size());
+        const auto& chunk = in_flight.at(index).chunk;
+        if (chunk_bytes_hashed == chunk.size) {
+            if (!chunk.checksum.empty() && chunk_hasher.hex() != chunk.checksum) {
+                data_error = "Chunk checksum mismatch for " + chunk.file_name;
+                return false;
+            }
+            chunk_hasher = Hasher(manifest.checksum_algorithm);
+            chunk_bytes_hashed = 0;
+        }
+        return true;
+    };
+    callbacks.on_range_done = [&](std::size_t index, std::string& range_error) {
+        const auto entry = in_flight.find(index);
+        const bool recorded = feed.complete(entry->second.chunk, range_error);
+        in_flight.erase(entry);
+        return recorded;
+    };
+
+    auto backend = make_io_backend(static_cast<unsigned>(request.queue_depth));
+    if (!async_copy_ranges(*backend, chunk_count, request.queue_depth, kAsyncSegmentSize, callbacks,
+                           error)) {
+        return false;
+    }
+
+    if (stream_hash && source_hasher.hex() != manifest.source_checksum) {
+        error = "Source checksum mismatch after join.";
+        return false;
+    }
+
+    total_bytes_written = manifest.source_size;
+    return true;
+}
+
+bool join_pipelined(const JoinRequest& request,
+                    const humpty::models::Manifest& manifest,
+                    std::size_t chunk_count,
+                    ChunkFeed& feed,
+                    bool stream_hash,
+                    std::uint64_t& total_bytes_written,
+                    std::string& error) {
+    FileHandle output;
+    if (!open_stream_output(request, output, error)) {
+        return false;
+    }
+
+    const auto base_dir = humpty::models::chunk_directory(manifest, request.manifest_path);
+    std::size_t read_index = 0;
+    std::uint64_t read_done = 0;
+    humpty::models::Chunk read_chunk;
+    humpty::models::Chunk next_chunk;
+    FileHandle chunk_in;
+    FileHandle next_chunk_in;
+    Hasher source_hasher(manifest.checksum_algorithm);
+    Hasher chunk_hasher(manifest.checksum_algorithm);
+
+    // Entries of the chunks between the read and the last stage, with the
+    // number of stages (hash, write) done with them. Whichever stage is
+    // second records the chunk in the checkpoint.
+    std::mutex in_flight_mutex;
+    std::map<std::size_t, std::pair<humpty::models::Chunk, int>> in_flight;
+    auto finish_stage = [&](std::size_t index, std::string& stage_error) {
+        std::unique_lock<std::mutex> lock(in_flight_mutex);
+        const auto entry = in_flight.find(index);
+        if (++entry->second.second < 2) {
+            return true;
+        }
+        const auto chunk = std::move(entry->second.first);
+        in_flight.erase(entry);
+        lock.unlock();
+        return feed.complete(chunk, stage_error);
+    };
+
+    // Opening the following chunk early lets its read-ahead overlap with the
+    // tail of the current one.
+    auto open_chunk = [&](humpty::models::Chunk& chunk, FileHandle& handle, std::string& open_error) {
+        if (!feed.next(chunk, open_error)) {
+            return false;
+        }
+        const auto chunk_path = base_dir / chunk.file_name;
+        if (!handle.open_read(chunk_path)) {
+            open_error = "Failed to open chunk file: " + chunk_path.string();
+            return false;
+        }
+        handle.advise_willneed();
+        return true;
+    };
+
+    PipelineStages stages;
+    stages.read = [&](std::span<std::byte> buffer, PipelineSegment& segment, bool& done, std::string& read_error) {
+        if (read_index == chunk_count) {
+            done = true;
+            return true;
+        }
+
+        const auto& chunk = read_chunk;
+        if (read_done == 0) {
+            if (next_chunk_in.is_open()) {
+                read_chunk = std::move(next_chunk);
+                chunk_in = std::move(next_chunk_in);
+            } else if (!open_chunk(read_chunk, chunk_in, read_error)) {
+                return false;
+            }
+            if (read_index + 1 < chunk_count && !open_chunk(next_chunk, next_chunk_in, read_error)) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(in_flight_mutex);
+            in_flight.try_emplace(read_index, read_chunk, 0);
+        }
+
+        const std::uint64_t chunk_remaining = chunk.size - read_done;
+        const auto view = buffer.first(static_cast<std::size_t>(
+            (chunk_remaining < static_cast<std::uint64_t>(buffer.size())) ? chunk_remaining : buffer.size()));
+        if (!chunk_in.read_exact(view)) {
+            read_error = "Unexpected end of chunk: " + (base_dir / chunk.file_name).string();
+            return false;
+        }
+
+        read_done += view.size();
+        segment.range_index = read_index;
+        segment.data = view;
+        segment.last_in_range = read_done == chunk.size;
+        if (segment.last_in_range) {
+            chunk_in.close();
+            ++read_index;
+            read_done = 0;
+        }
+        return true;
+    };
+    stages.hash = [&](const PipelineSegment& segment, std::string& hash_error) {
+        chunk_hasher.update(segment.data);
+        if (stream_hash) {
+            source_hasher.update(segment.data);
+        }
+        if (segment.last_in_range) {
+            {
+                std::lock_guard<std::mutex> lock(in_flight_mutex);
+                const auto& chunk = in_flight.at(segment.range_index).first;
+                if (!chunk.checksum.empty() && chunk_hasher.hex() != chunk.checksum) {
+                    hash_error = "Chunk checksum mismatch for " + chunk.file_name;
+                    return false;
+                }
+            }
+            chunk_hasher = Hasher(manifest.checksum_algorithm);
+            return finish_stage(segment.range_index, hash_error);
+        }
+        return true;
+    };
+    stages.write = [&](const PipelineSegment& segment, std::string& write_error) {
+        if (!output.write_all(segment.data)) {
+            write_error = "Failed writing output file: " + request.output_file.string();
+            return false;
+        }
+        total_bytes_written += segment.data.size();
+        feed.copied(segment.data.size());
+        return !segment.last_in_range || finish_stage(segment.range_index, write_error);
+    };
+
+    if (!run_pipeline(kPipelineBufferCount, kPipelineBufferSize, stages, error)) {
+        return false;
+    }
+
+    if (stream_hash && source_hasher.hex() != manifest.source_checksum) {
+        error = "Source checksum mismatch after join.";
+        return false;
+    }
+    return true;
+}
+
+// Re-reads the finished output in order to check a stream source checksum,
+// for joins that did not write every byte of it front to back.
+bool check_output_digest(const JoinRequest& request, const humpty::models::Manifest& manifest, std::string& error) {
+    FileHandle output;
+    if (!output.open_read(request.output_file)) {
+        error = "Failed to open output file: " + request.output_file.string();
+        return false;
+    }
+    std::vector<std::byte> buffer(kAsyncSegmentSize);
+    const stats::BufferCharge buffer_charge(buffer.size());
+    Hasher source_hasher(manifest.checksum_algorithm);
+    for (std::uint64_t done = 0; done < manifest.source_size;) {
+        const auto view = std::span<std::byte>(
+            buffer.data(), static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), manifest.source_size - done)));
+        if (!output.read_exact(view)) {
+            error = "Failed reading output file: " + request.output_file.string();
+            return false;
+        }
+        source_hasher.update(view);
+        done += view.size();
+    }
+    if (source_hasher.hex() != manifest.source_checksum) {
+        error = "Source checksum mismatch after join.";
+        return false;
+    }
+    return true;
+}
+
+// A regular file, or a path the join is about to create as one.
+bool is_regular_output(const std::filesystem::path& path) {
+    std::error_code ec;
+    const auto type = std::filesystem::status(path, ec).type();
+    return type == std::filesystem::file_type::regular || type == std::filesystem::file_type::not_found;
+}
+
+}  // namespace
+
+bool join_file(const JoinRequest& request, JoinResult& result, std::string& error) {
+    result = {};
+    error.clear();
+    stats::Collection collection(request.collect_stats);
+
+    humpty::models::ManifestReader reader;
+    {
+        const stats::ScopedTimer timer(stats::Timer::Manifest);
+        if (!reader.open(request.manifest_path, error)) {
+            return false;
+        }
+    }
+
+    // Workers only see this copy; the reader's header is re-read from the
+    // trailer as the last entries are parsed.
+    const humpty::models::Manifest manifest = reader.header();
+    if (!manifest.complete) {
+        error = "Manifest is incomplete; the split that wrote it did not finish.";
+        return false;
+    }
+
+    if (request.direct_io && request.io_engine != IoEngine::Stream) {
+        error = "Direct I/O is only available with the stream I/O engine.";
+        return false;
+    }
+    if (request.direct_io && !is_valid_direct_buffer_size(request.direct_buffer_size)) {
+        error = "Direct I/O buffer size must be a positive multiple of 4096 bytes.";
+        return false;
+    }
+    // Standard output can only be written front to back.
+    const bool standard_output = is_standard_stream(request.output_file);
+    if (standard_output && (request.resume || request.direct_io || request.io_engine != IoEngine::Stream)) {
+        error = "Standard output is written in order; --resume, --direct and --io mmap|uring need an output file.";
+        return false;
+    }
+
+    const std::size_t chunk_count = reader.chunk_count();
+    const bool combine_digest = request.verify_checksums && !manifest.source_checksum.empty() &&
+                                manifest.source_digest == humpty::models::SourceDigest::Combined;
+
+    // A stream source checksum can only be rebuilt in source order.
+    const bool stream_hash = request.verify_checksums && !manifest.source_checksum.empty() &&
+                             manifest.source_digest == humpty::models::SourceDigest::Stream;
+
+    // Chunks a previous join recorded are only trusted if the output still
+    // reaches past them and their entries match this manifest.
+    CompletedChunks completed;
+    const auto checkpoint_path = join_checkpoint_path(request.output_file);
+    if (request.resume) {
+        std::error_code ec;
+        const auto output_size = std::filesystem::file_size(request.output_file, ec);
+        if (!ec) {
+            load_join_checkpoint(checkpoint_path, manifest, output_size, completed);
+        }
+    }
+    const bool resuming = !completed.empty();
+    // Parallel and resumed joins write chunks out of order, so they re-read
+    // a regular output file for a stream source checksum once every chunk is
+    // in place. Other outputs cannot be read back and are joined on one
+    // thread instead.
+    const bool regular_output = !standard_output && is_regular_output(request.output_file);
+    const bool hash_output = stream_hash && regular_output && (resuming || request.thread_count > 1);
+    if (stream_hash && !standard_output && !regular_output && request.thread_count > 1) {
+        result.warnings.push_back("The output cannot be read back to check the stream source checksum, so it is "
+                                  "joined on one thread.");
+    }
+
+    // Only a regular output file can be resumed into, so devices such as
+    // /dev/null get no checkpoint. Without one the join still works; it
+    // just cannot be resumed.
+    JoinCheckpoint checkpoint;
+    if (regular_output) {
+        std::string checkpoint_error;
+        if (!checkpoint.open(checkpoint_path, manifest, resuming, checkpoint_error)) {
+            if (resuming) {
+                error = checkpoint_error;
+                return false;
+            }
+            result.warnings.push_back(checkpoint_error + "; an interrupted join cannot be resumed.");
+        }
+    }
+    // Resumed chunks count as done from the start.
+    ProgressReporter progress(request.progress, request.progress_interval);
+    for (const auto& [index, chunk] : completed) {
+        progress.add(chunk.size);
+    }
+    ChunkFeed feed(reader, manifest, combine_digest, completed, checkpoint, progress);
+
+    // Only the positional path writes at chunk offsets, which a resumed join
+    // needs to fill the gaps.
+    const bool positional = !standard_output && manifest.source_size != 0 &&
+                            ((request.thread_count > 1 && (hash_output || !stream_hash)) ||
+                             manifest.codec != humpty::models::ChunkCodec::None ||
+                             request.io_engine != IoEngine::Stream || !request.verify_checksums ||
+                             request.direct_io || resuming);
+
+    collection.end_setup();
+    progress.start(manifest.source_size, chunk_count);
+    std::uint64_t total_bytes_written = 0;
+    bool ok = false;
+    if (request.io_engine == IoEngine::Uring && request.verify_checksums && manifest.source_size != 0 && !resuming &&
+        manifest.codec == humpty::models::ChunkCodec::None) {
+        ok = join_async(request, manifest, chunk_count, feed, stream_hash && !hash_output, total_bytes_written,
+                        error);
+    } else if (positional) {
+        ok = join_positional(request, manifest, chunk_count, feed, stream_hash && !hash_output, total_bytes_written,
+                             error);
+    } else if (request.pipelined && manifest.codec == humpty::models::ChunkCodec::None) {
+        ok = join_pipelined(request, manifest, chunk_count, feed, stream_hash, total_bytes_written, error);
+    } else {
+        ok = join_sequential(request, manifest, chunk_count, feed, total_bytes_written, error);
+    }
+    if (ok && hash_output) {
+        ok = check_output_digest(request, manifest, error);
+    }
+    collection.end_data();
+    if (!ok || !feed.finish(error)) {
+        return false;
+    }
+    checkpoint.remove();
+
     if (manifest.source_size != 0 && total_bytes_written != manifest.source_size) {
         error = "Output size does not match manifest source_size.";
         return false;
     }
 
     result.total_bytes_written = total_bytes_written;
+    result.chunks_resumed = feed.skipped();
+    collection.finish(result.stats);
+    progress.finish(manifest.source_size, chunk_count);
     return true;
 }
 
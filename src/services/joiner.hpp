@@ -1,19 +1,47 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <string>
+#include <vector>
+
+#include "services/direct_io.hpp"
+#include "services/file_io.hpp"
+#include "services/progress.hpp"
+#include "services/transfer_stats.hpp"
 
 namespace humpty::services {
 
 struct JoinRequest {
     std::filesystem::path manifest_path;
+    // "-" writes the output to standard output, in order and on one thread.
     std::filesystem::path output_file;
     bool verify_checksums = true;
+    std::size_t thread_count = 1;
+    IoEngine io_engine = IoEngine::Stream;
+    std::size_t queue_depth = 32;
+    bool pipelined = false;
+    bool direct_io = false;
+    std::size_t direct_buffer_size = kDefaultDirectBufferSize;
+    // Skip the chunks that the checkpoint of an interrupted join recorded.
+    bool resume = false;
+    // Fill JoinResult::stats.
+    bool collect_stats = false;
+    // Called every `progress_interval` from a reporting thread while the
+    // transfer runs, and once more when it succeeds.
+    ProgressCallback progress;
+    std::chrono::milliseconds progress_interval = kDefaultProgressInterval;
 };
 
 struct JoinResult {
     std::uint64_t total_bytes_written = 0;
+    std::size_t chunks_resumed = 0;
+    // Problems that did not stop the join, such as a checkpoint that could
+    // not be written.
+    std::vector<std::string> warnings;
+    // Zero unless the request set collect_stats.
+    TransferStats stats;
 };
 
 bool join_file(const JoinRequest& request, JoinResult& result, std::string& error);
@@ -0,0 +1,178 @@
+#include "services/kernel_copy.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "services/transfer_stats.hpp"
+
+namespace humpty::services {
+namespace {
+
+constexpr std::size_t kFallbackBufferSize = 64 * 1024;
+constexpr std::size_t kMaxKernelCopy = 1024 * 1024 * 1024;
+
+bool is_unsupported(int error_number) {
+    return error_number == ENOSYS || error_number == EXDEV || error_number == EINVAL ||
+           error_number == EOPNOTSUPP || error_number == EBADF;
+}
+
+enum class CopyOutcome {
+    Done,
+    Unsupported,
+    Failed,
+};
+
+#if defined(__linux__)
+
+CopyOutcome copy_with_copy_file_range(int source_fd,
+                                      std::uint64_t& source_offset,
+                                      int target_fd,
+                                      std::uint64_t& target_offset,
+                                      std::uint64_t& remaining) {
+    while (remaining != 0) {
+        auto in_offset = static_cast<loff_t>(source_offset);
+        auto out_offset = static_cast<loff_t>(target_offset);
+        const auto request = static_cast<std::size_t>(remaining < kMaxKernelCopy ? remaining : kMaxKernelCopy);
+        const ssize_t copied = ::copy_file_range(source_fd, &in_offset, target_fd, &out_offset, request, 0);
+        if (copied < 0 && errno == EINTR) {
+            continue;
+        }
+        if (copied < 0) {
+            return is_unsupported(errno) ? CopyOutcome::Unsupported : CopyOutcome::Failed;
+        }
+        if (copied == 0) {
+            return CopyOutcome::Failed;
+        }
+        stats::count_read(static_cast<std::uint64_t>(copied));
+        stats::count_write(static_cast<std::uint64_t>(copied));
+        source_offset += static_cast<std::uint64_t>(copied);
+        target_offset += static_cast<std::uint64_t>(copied);
+        remaining -= static_cast<std::uint64_t>(copied);
+    }
+    return CopyOutcome::Done;
+}
+
+CopyOutcome copy_with_splice(int source_fd,
+                             std::uint64_t& source_offset,
+                             int target_fd,
+                             std::uint64_t& target_offset,
+                             std::uint64_t& remaining) {
+    int pipe_fds[2] = {-1, -1};
+    if (::pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        return CopyOutcome::Unsupported;
+    }
+
+    CopyOutcome outcome = CopyOutcome::Done;
+    while (remaining != 0) {
+        auto in_offset = static_cast<loff_t>(source_offset);
+        const auto request =
+            static_cast<std::size_t>(remaining < kFallbackBufferSize ? remaining : kFallbackBufferSize);
+        const ssize_t filled = ::splice(source_fd, &in_offset, pipe_fds[1], nullptr, request, SPLICE_F_MOVE);
+        if (filled < 0 && errno == EINTR) {
+            continue;
+        }
+        if (filled <= 0) {
+            outcome = (filled < 0 && is_unsupported(errno)) ? CopyOutcome::Unsupported : CopyOutcome::Failed;
+            break;
+        }
+
+        stats::count_read(static_cast<std::uint64_t>(filled));
+        auto pending = static_cast<std::size_t>(filled);
+        while (pending != 0) {
+            auto out_offset = static_cast<loff_t>(target_offset);
+            const ssize_t drained = ::splice(pipe_fds[0], nullptr, target_fd, &out_offset, pending, SPLICE_F_MOVE);
+            if (drained < 0 && errno == EINTR) {
+                continue;
+            }
+            if (drained <= 0) {
+                // Bytes already sitting in the pipe cannot be handed back, so a
+                // failure here is final rather than a reason to fall back.
+                outcome = CopyOutcome::Failed;
+                break;
+            }
+            stats::count_write(static_cast<std::uint64_t>(drained));
+            pending -= static_cast<std::size_t>(drained);
+            target_offset += static_cast<std::uint64_t>(drained);
+        }
+        if (outcome != CopyOutcome::Done) {
+            break;
+        }
+
+        source_offset += static_cast<std::uint64_t>(filled);
+        remaining -= static_cast<std::uint64_t>(filled);
+    }
+
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+    return outcome;
+}
+
+#endif
+
+bool copy_with_buffer(const FileHandle& source,
+                      std::uint64_t source_offset,
+                      const FileHandle& target,
+                      std::uint64_t target_offset,
+                      std::uint64_t remaining) {
+    std::vector<std::byte> buffer(kFallbackBufferSize);
+    const stats::BufferCharge buffer_charge(buffer.size());
+    while (remaining != 0) {
+        const auto to_copy = static_cast<std::size_t>(remaining < buffer.size() ? remaining : buffer.size());
+        const auto view = std::span<std::byte>(buffer.data(), to_copy);
+        if (!source.read_exact_at(view, source_offset) || !target.write_all_at(view, target_offset)) {
+            return false;
+        }
+        source_offset += to_copy;
+        target_offset += to_copy;
+        remaining -= to_copy;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool kernel_copy(const FileHandle& source,
+                 std::uint64_t source_offset,
+                 const FileHandle& target,
+                 std::uint64_t target_offset,
+                 std::uint64_t length) {
+#if defined(__linux__)
+    CopyOutcome outcome =
+        copy_with_copy_file_range(source.fd(), source_offset, target.fd(), target_offset, length);
+    if (outcome == CopyOutcome::Unsupported) {
+        outcome = copy_with_splice(source.fd(), source_offset, target.fd(), target_offset, length);
+    }
+    if (outcome == CopyOutcome::Done) {
+        return true;
+    }
+    if (outcome == CopyOutcome::Failed) {
+        return false;
+    }
+#endif
+    return copy_with_buffer(source, source_offset, target, target_offset, length);
+}
+
+bool kernel_copy_blocks(const FileHandle& source,
+                        std::uint64_t source_offset,
+                        const FileHandle& target,
+                        std::uint64_t target_offset,
+                        std::uint64_t length,
+                        const std::function<void(std::uint64_t bytes)>& copied) {
+    for (std::uint64_t done = 0; done < length;) {
+        const std::uint64_t block = std::min(kKernelCopyBlockSize, length - done);
+        if (!kernel_copy(source, source_offset + done, target, target_offset + done, block)) {
+            return false;
+        }
+        copied(block);
+        done += block;
+    }
+    return true;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "services/file_io.hpp"
+
+namespace humpty::services {
+
+// Copies a byte range between two files without pulling it through user
+// space where the kernel allows it: copy_file_range first (which lets
+// filesystems reflink or copy server-side), then splice through a pipe, and
+// finally a plain pread/pwrite loop. Offsets are explicit, so concurrent
+// copies into one target are safe.
+bool kernel_copy(const FileHandle& source,
+                 std::uint64_t source_offset,
+                 const FileHandle& target,
+                 std::uint64_t target_offset,
+                 std::uint64_t length);
+
+constexpr std::uint64_t kKernelCopyBlockSize = 8 * 1024 * 1024;
+
+// As kernel_copy, kKernelCopyBlockSize bytes at a time, calling `copied` with
+// the size of each block once it has landed, so a long copy can report
+// progress as it goes.
+bool kernel_copy_blocks(const FileHandle& source,
+                        std::uint64_t source_offset,
+                        const FileHandle& target,
+                        std::uint64_t target_offset,
+                        std::uint64_t length,
+                        const std::function<void(std::uint64_t bytes)>& copied);
+
+}  // namespace humpty::services
@@ -0,0 +1,85 @@
+#include "services/mapped_file.hpp"
+
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "services/transfer_stats.hpp"
+
+namespace humpty::services {
+
+MappedRegion::~MappedRegion() {
+    unmap();
+}
+
+MappedRegion::MappedRegion(MappedRegion&& other) noexcept
+    : base_(std::exchange(other.base_, nullptr)),
+      mapped_length_(std::exchange(other.mapped_length_, 0)),
+      data_(std::exchange(other.data_, nullptr)),
+      length_(std::exchange(other.length_, 0)) {}
+
+MappedRegion& MappedRegion::operator=(MappedRegion&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        base_ = std::exchange(other.base_, nullptr);
+        mapped_length_ = std::exchange(other.mapped_length_, 0);
+        data_ = std::exchange(other.data_, nullptr);
+        length_ = std::exchange(other.length_, 0);
+    }
+    return *this;
+}
+
+bool MappedRegion::map_read(const FileHandle& file, std::uint64_t offset, std::size_t length) {
+    return map(file, offset, length, false);
+}
+
+bool MappedRegion::map_write(const FileHandle& file, std::uint64_t offset, std::size_t length) {
+    return map(file, offset, length, true);
+}
+
+bool MappedRegion::map(const FileHandle& file, std::uint64_t offset, std::size_t length, bool writable) {
+    unmap();
+    if (length == 0) {
+        return true;
+    }
+
+    const auto page_size = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+    const std::uint64_t aligned_offset = offset - (offset % page_size);
+    const auto lead = static_cast<std::size_t>(offset - aligned_offset);
+
+    const int protection = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* base = ::mmap(nullptr, length + lead, protection, MAP_SHARED, file.fd(), static_cast<off_t>(aligned_offset));
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    if (writable) {
+        stats::count_write(length);
+    } else {
+        stats::count_read(length);
+    }
+    base_ = base;
+    mapped_length_ = length + lead;
+    data_ = static_cast<std::byte*>(base) + lead;
+    length_ = length;
+    return true;
+}
+
+void MappedRegion::advise_sequential() const {
+    if (base_ != nullptr) {
+        ::madvise(base_, mapped_length_, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedRegion::unmap() {
+    if (base_ != nullptr) {
+        ::munmap(base_, mapped_length_);
+    }
+    base_ = nullptr;
+    mapped_length_ = 0;
+    data_ = nullptr;
+    length_ = 0;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "services/file_io.hpp"
+
+namespace humpty::services {
+
+// Upper bound for one mapping; larger ranges are walked window by window so
+// address space use stays flat regardless of file size.
+constexpr std::size_t kMapWindowSize = 64 * 1024 * 1024;
+
+class MappedRegion {
+public:
+    MappedRegion() = default;
+    ~MappedRegion();
+
+    MappedRegion(const MappedRegion&) = delete;
+    MappedRegion& operator=(const MappedRegion&) = delete;
+    MappedRegion(MappedRegion&& other) noexcept;
+    MappedRegion& operator=(MappedRegion&& other) noexcept;
+
+    bool map_read(const FileHandle& file, std::uint64_t offset, std::size_t length);
+    bool map_write(const FileHandle& file, std::uint64_t offset, std::size_t length);
+    void advise_sequential() const;
+    void unmap();
+
+    [[nodiscard]] std::span<std::byte> bytes() const { return {data_, length_}; }
+
+private:
+    bool map(const FileHandle& file, std::uint64_t offset, std::size_t length, bool writable);
+
+    void* base_ = nullptr;
+    std::size_t mapped_length_ = 0;
+    std::byte* data_ = nullptr;
+    std::size_t length_ = 0;
+};
+
+}  // namespace humpty::services
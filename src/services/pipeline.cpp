@@ -0,0 +1,137 @@
+#include "services/pipeline.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "services/transfer_stats.hpp"
+
+namespace humpty::services {
+namespace {
+
+// Segments are numbered in read order; segment n lives in slot
+// n % buffer_count. A stage may consume segment n once the reader has
+// published it, and the reader may refill a slot once both consumers have
+// moved past the segment it held.
+class BufferRing {
+public:
+    BufferRing(std::size_t buffer_count, std::size_t buffer_size)
+        : storage_(buffer_count * buffer_size), buffer_size_(buffer_size), segments_(buffer_count) {}
+
+    [[nodiscard]] std::size_t capacity() const { return segments_.size(); }
+
+    std::span<std::byte> buffer(std::uint64_t sequence) {
+        const auto slot = static_cast<std::size_t>(sequence % capacity());
+        return {storage_.data() + slot * buffer_size_, buffer_size_};
+    }
+
+    PipelineSegment& segment(std::uint64_t sequence) { return segments_[static_cast<std::size_t>(sequence % capacity())]; }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::uint64_t read_count = 0;
+    std::uint64_t hashed_count = 0;
+    std::uint64_t written_count = 0;
+    bool input_done = false;
+    bool failed = false;
+    std::string first_error;
+
+    void fail(const std::string& stage_error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed) {
+            failed = true;
+            first_error = stage_error;
+        }
+        changed.notify_all();
+    }
+
+private:
+    std::vector<std::byte> storage_;
+    std::size_t buffer_size_;
+    std::vector<PipelineSegment> segments_;
+};
+
+void run_consumer(BufferRing& ring,
+                  const std::function<bool(const PipelineSegment&, std::string&)>& stage,
+                  std::uint64_t BufferRing::*consumed) {
+    std::string stage_error;
+    for (std::uint64_t sequence = 0;; ++sequence) {
+        {
+            std::unique_lock<std::mutex> lock(ring.mutex);
+            ring.changed.wait(lock, [&] { return ring.failed || ring.read_count > sequence || ring.input_done; });
+            if (ring.failed || ring.read_count <= sequence) {
+                return;
+            }
+        }
+
+        if (stage && !stage(ring.segment(sequence), stage_error)) {
+            ring.fail(stage_error);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(ring.mutex);
+        ring.*consumed = sequence + 1;
+        ring.changed.notify_all();
+    }
+}
+
+}  // namespace
+
+bool run_pipeline(std::size_t buffer_count,
+                  std::size_t buffer_size,
+                  const PipelineStages& stages,
+                  std::string& error) {
+    buffer_count = std::max<std::size_t>(buffer_count, 2);
+    buffer_size = std::max<std::size_t>(buffer_size, 1);
+    BufferRing ring(buffer_count, buffer_size);
+    const stats::BufferCharge buffer_charge(buffer_count * buffer_size);
+
+    std::thread hasher(run_consumer, std::ref(ring), std::cref(stages.hash), &BufferRing::hashed_count);
+    std::thread writer(run_consumer, std::ref(ring), std::cref(stages.write), &BufferRing::written_count);
+
+    std::string read_error;
+    for (std::uint64_t sequence = 0;; ++sequence) {
+        {
+            std::unique_lock<std::mutex> lock(ring.mutex);
+            ring.changed.wait(lock, [&] {
+                return ring.failed || std::min(ring.hashed_count, ring.written_count) + ring.capacity() > sequence;
+            });
+            if (ring.failed) {
+                break;
+            }
+        }
+
+        bool done = false;
+        PipelineSegment& segment = ring.segment(sequence);
+        segment = {};
+        if (!stages.read(ring.buffer(sequence), segment, done, read_error)) {
+            ring.fail(read_error);
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(ring.mutex);
+        if (done) {
+            ring.input_done = true;
+        } else {
+            ring.read_count = sequence + 1;
+        }
+        ring.changed.notify_all();
+        if (done) {
+            break;
+        }
+    }
+
+    hasher.join();
+    writer.join();
+
+    if (ring.failed) {
+        error = ring.first_error;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string>
+
+namespace humpty::services {
+
+constexpr std::size_t kPipelineBufferCount = 8;
+constexpr std::size_t kPipelineBufferSize = 1024 * 1024;
+
+struct PipelineSegment {
+    std::size_t range_index = 0;
+    std::span<const std::byte> data;
+    bool last_in_range = false;
+};
+
+// read() fills the start of `buffer` and describes it in `segment`; it sets
+// `done` instead once the input is exhausted. hash() and write() both see
+// every segment in read order; a buffer returns to the ring once both have
+// released it.
+struct PipelineStages {
+    std::function<bool(std::span<std::byte> buffer, PipelineSegment& segment, bool& done, std::string& error)> read;
+    std::function<bool(const PipelineSegment& segment, std::string& error)> hash;
+    std::function<bool(const PipelineSegment& segment, std::string& error)> write;
+};
+
+// Runs the read stage on the calling thread and the hash and write stages on
+// their own threads, passing segments through a ring of buffer_count
+// preallocated buffers. The first failing stage stops the others.
+bool run_pipeline(std::size_t buffer_count,
+                  std::size_t buffer_size,
+                  const PipelineStages& stages,
+                  std::string& error);
+
+}  // namespace humpty::services
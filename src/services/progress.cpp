@@ -0,0 +1,99 @@
+#include "services/progress.hpp"
+
+#include <utility>
+
+namespace humpty::services {
+namespace {
+
+double seconds_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+}  // namespace
+
+ProgressReporter::ProgressReporter(ProgressCallback callback, std::chrono::milliseconds interval)
+    : callback_(std::move(callback)), interval_(interval.count() > 0 ? interval : kDefaultProgressInterval) {}
+
+ProgressReporter::~ProgressReporter() {
+    stop();
+}
+
+void ProgressReporter::start(std::uint64_t bytes_total, std::uint64_t chunks_total) {
+    if (!callback_ || thread_.joinable()) {
+        return;
+    }
+    bytes_total_ = bytes_total;
+    chunks_total_ = chunks_total;
+    baseline_bytes_ = bytes_done_.load(std::memory_order_relaxed);
+    last_bytes_ = baseline_bytes_;
+    started_ = std::chrono::steady_clock::now();
+    last_report_ = started_;
+    last_moved_ = started_;
+    thread_ = std::thread(&ProgressReporter::run, this);
+}
+
+void ProgressReporter::finish(std::uint64_t bytes_total, std::uint64_t chunks_total) {
+    if (!thread_.joinable()) {
+        return;
+    }
+    stop();
+    bytes_total_ = bytes_total;
+    chunks_total_ = chunks_total;
+    auto progress = snapshot(std::chrono::steady_clock::now());
+    progress.finished = true;
+    progress.eta_seconds = 0.0;
+    callback_(progress);
+}
+
+void ProgressReporter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_for(lock, interval_, [this] { return stopping_; })) {
+        lock.unlock();
+        callback_(snapshot(std::chrono::steady_clock::now()));
+        lock.lock();
+    }
+}
+
+void ProgressReporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+Progress ProgressReporter::snapshot(std::chrono::steady_clock::time_point now) {
+    Progress progress;
+    progress.bytes_done = bytes_done_.load(std::memory_order_relaxed);
+    progress.chunks_done = chunks_done_.load(std::memory_order_relaxed);
+    progress.bytes_total = bytes_total_;
+    progress.chunks_total = chunks_total_;
+    progress.elapsed_seconds = seconds_between(started_, now);
+
+    const double interval = seconds_between(last_report_, now);
+    if (interval > 0.0) {
+        progress.current_bytes_per_second = static_cast<double>(progress.bytes_done - last_bytes_) / interval;
+    }
+    if (progress.elapsed_seconds > 0.0) {
+        progress.average_bytes_per_second =
+            static_cast<double>(progress.bytes_done - baseline_bytes_) / progress.elapsed_seconds;
+    }
+    if (progress.bytes_total != 0 && progress.average_bytes_per_second > 0.0) {
+        const std::uint64_t remaining =
+            progress.bytes_total > progress.bytes_done ? progress.bytes_total - progress.bytes_done : 0;
+        progress.eta_seconds = static_cast<double>(remaining) / progress.average_bytes_per_second;
+    }
+    if (progress.bytes_done != last_bytes_) {
+        last_moved_ = now;
+    }
+    progress.stalled_seconds = seconds_between(last_moved_, now);
+
+    last_bytes_ = progress.bytes_done;
+    last_report_ = now;
+    return progress;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace humpty::services {
+
+// A snapshot of a running split or join. Bytes move as each block of a chunk
+// is copied, chunks as whole chunks finish.
+struct Progress {
+    std::uint64_t bytes_done = 0;
+    // Zero while unknown, as for standard input.
+    std::uint64_t bytes_total = 0;
+    std::uint64_t chunks_done = 0;
+    std::uint64_t chunks_total = 0;
+    double elapsed_seconds = 0.0;
+    // Throughput over the last interval and since the start; chunks carried
+    // over by a resume do not count towards either.
+    double current_bytes_per_second = 0.0;
+    double average_bytes_per_second = 0.0;
+    // From the average throughput; negative while it cannot be estimated.
+    double eta_seconds = -1.0;
+    // Time since bytes_done last moved, which grows while the transfer is
+    // stalled.
+    double stalled_seconds = 0.0;
+    // Set on the last report, once the transfer has succeeded.
+    bool finished = false;
+};
+
+// Called from a reporting thread, not the one that started the transfer.
+using ProgressCallback = std::function<void(const Progress& progress)>;
+
+constexpr std::chrono::milliseconds kDefaultProgressInterval{1000};
+
+// Counts copied bytes and finished chunks and reports them to a callback
+// every interval from its own thread, whether or not anything moved, so a
+// stalled transfer keeps reporting. Workers only pay for a relaxed atomic
+// add per block and per chunk.
+class ProgressReporter {
+public:
+    ProgressReporter(ProgressCallback callback, std::chrono::milliseconds interval);
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    void add_bytes(std::uint64_t bytes) { bytes_done_.fetch_add(bytes, std::memory_order_relaxed); }
+    void add_chunk() { chunks_done_.fetch_add(1, std::memory_order_relaxed); }
+    // A whole chunk at once, as for one carried over by a resume.
+    void add(std::uint64_t bytes) {
+        add_bytes(bytes);
+        add_chunk();
+    }
+
+    // Starts reporting. What was added before counts as done but not
+    // towards the throughput.
+    void start(std::uint64_t bytes_total, std::uint64_t chunks_total);
+    // Stops reporting after one last report marked finished, with the totals
+    // as they turned out; standard input only knows them at the end.
+    void finish(std::uint64_t bytes_total, std::uint64_t chunks_total);
+
+private:
+    void run();
+    void stop();
+    Progress snapshot(std::chrono::steady_clock::time_point now);
+
+    ProgressCallback callback_;
+    std::chrono::milliseconds interval_;
+    std::atomic<std::uint64_t> bytes_done_{0};
+    std::atomic<std::uint64_t> chunks_done_{0};
+    std::uint64_t bytes_total_ = 0;
+    std::uint64_t chunks_total_ = 0;
+    std::uint64_t baseline_bytes_ = 0;
+    std::chrono::steady_clock::time_point started_;
+    // Only touched by whichever thread is reporting.
+    std::uint64_t last_bytes_ = 0;
+    std::chrono::steady_clock::time_point last_report_;
+    std::chrono::steady_clock::time_point last_moved_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+}  // namespace humpty::services
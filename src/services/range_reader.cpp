@@ -0,0 +1,199 @@
+#include "services/range_reader.hpp"
+
+#include <algorithm>
+
+#include "services/checksums.hpp"
+#include "services/chunk_codec.hpp"
+
+namespace humpty::services {
+namespace {
+
+constexpr std::size_t kVerifyBufferSize = 1024 * 1024;
+
+}  // namespace
+
+bool RangeReader::open(const std::filesystem::path& manifest_path,
+                       bool verify_chunks,
+                       std::size_t max_open_chunks,
+                       std::string& error) {
+    auto manifest = humpty::models::read_manifest(manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    if (!manifest->complete) {
+        error = "Manifest is incomplete; the split that wrote it did not finish.";
+        return false;
+    }
+
+    auto& chunks = manifest->chunks;
+    std::sort(chunks.begin(), chunks.end(),
+              [](const humpty::models::Chunk& a, const humpty::models::Chunk& b) { return a.offset < b.offset; });
+    std::uint64_t covered = 0;
+    for (const auto& chunk : chunks) {
+        if (chunk.offset != covered) {
+            error = "Manifest chunks do not cover the source without gaps.";
+            return false;
+        }
+        covered += chunk.size;
+    }
+    if (covered != manifest->source_size) {
+        error = "Manifest chunks do not cover the source without gaps.";
+        return false;
+    }
+
+    manifest_ = std::move(*manifest);
+    chunk_dir_ = humpty::models::chunk_directory(manifest_, manifest_path);
+    verify_ = verify_chunks;
+    max_open_ = std::max<std::size_t>(max_open_chunks, 1);
+    open_chunks_.clear();
+    verified_.assign(manifest_.chunks.size(), false);
+    block_valid_ = false;
+    return true;
+}
+
+bool RangeReader::read(std::uint64_t offset, std::span<std::byte> buffer, std::string& error) {
+    if (offset > manifest_.source_size || buffer.size() > manifest_.source_size - offset) {
+        error = "Range exceeds the source size.";
+        return false;
+    }
+
+    const auto& chunks = manifest_.chunks;
+    // The last chunk that starts at or before `offset`.
+    auto it = std::upper_bound(chunks.begin(), chunks.end(), offset,
+                               [](std::uint64_t value, const humpty::models::Chunk& chunk) {
+                                   return value < chunk.offset;
+                               });
+    while (!buffer.empty()) {
+        const auto position = static_cast<std::size_t>((it - chunks.begin()) - 1);
+        const auto& chunk = chunks[position];
+        const std::uint64_t chunk_offset = offset - chunk.offset;
+        const auto length =
+            static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), chunk.size - chunk_offset));
+
+        auto* open = open_chunk(position, error);
+        if (open == nullptr || (verify_ && !verified_[position] && !verify_chunk(*open, error)) ||
+            !read_slice(*open, chunk_offset, buffer.first(length), error)) {
+            return false;
+        }
+        buffer = buffer.subspan(length);
+        offset += length;
+        ++it;
+    }
+    return true;
+}
+
+RangeReader::OpenChunk* RangeReader::open_chunk(std::size_t position, std::string& error) {
+    const auto found = std::find_if(open_chunks_.begin(), open_chunks_.end(),
+                                    [&](const OpenChunk& chunk) { return chunk.position == position; });
+    if (found != open_chunks_.end()) {
+        open_chunks_.splice(open_chunks_.begin(), open_chunks_, found);
+        return &open_chunks_.front();
+    }
+
+    OpenChunk chunk;
+    chunk.position = position;
+    const auto chunk_path = chunk_dir_ / manifest_.chunks[position].file_name;
+    if (!chunk.file.open_read(chunk_path)) {
+        error = "Failed to open chunk file: " + chunk_path.string();
+        return nullptr;
+    }
+    chunk.frame_offsets.push_back(0);
+    if (open_chunks_.size() >= max_open_) {
+        open_chunks_.pop_back();
+    }
+    open_chunks_.push_front(std::move(chunk));
+    return &open_chunks_.front();
+}
+
+bool RangeReader::verify_chunk(OpenChunk& open, std::string& error) {
+    const auto& chunk = manifest_.chunks[open.position];
+    Hasher hasher(manifest_.checksum_algorithm);
+    if (chunk.codec != humpty::models::ChunkCodec::None) {
+        if (!decode_chunk_file(
+                open.file, chunk,
+                [&](std::span<const std::byte> block, std::string&) {
+                    hasher.update(block);
+                    return true;
+                },
+                error)) {
+            return false;
+        }
+    } else {
+        std::vector<std::byte> buffer(kVerifyBufferSize);
+        for (std::uint64_t done = 0; done < chunk.size;) {
+            const auto view = std::span<std::byte>(
+                buffer.data(), static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size - done, buffer.size())));
+            if (!open.file.read_exact_at(view, done)) {
+                error = "Unexpected end of chunk: " + chunk.file_name;
+                return false;
+            }
+            hasher.update(view);
+            done += view.size();
+        }
+    }
+
+    if (!chunk.checksum.empty() && hasher.hex() != chunk.checksum) {
+        error = "Chunk checksum mismatch for " + chunk.file_name;
+        return false;
+    }
+    verified_[open.position] = true;
+    return true;
+}
+
+bool RangeReader::read_slice(OpenChunk& open,
+                             std::uint64_t chunk_offset,
+                             std::span<std::byte> buffer,
+                             std::string& error) {
+    if (manifest_.chunks[open.position].codec != humpty::models::ChunkCodec::None) {
+        return read_encoded_slice(open, chunk_offset, buffer, error);
+    }
+    if (!open.file.read_exact_at(buffer, chunk_offset)) {
+        error = "Unexpected end of chunk: " + manifest_.chunks[open.position].file_name;
+        return false;
+    }
+    return true;
+}
+
+bool RangeReader::read_encoded_slice(OpenChunk& open,
+                                     std::uint64_t chunk_offset,
+                                     std::span<std::byte> buffer,
+                                     std::string& error) {
+    const auto& chunk = manifest_.chunks[open.position];
+    while (!buffer.empty()) {
+        const auto block_index = static_cast<std::size_t>(chunk_offset / kCodecBlockSize);
+        const std::uint64_t block_start = static_cast<std::uint64_t>(block_index) * kCodecBlockSize;
+        const auto block_size =
+            static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size - block_start, kCodecBlockSize));
+
+        if (!block_valid_ || block_position_ != open.position || block_index_ != block_index) {
+            // Frames vary in length, so their starts are found by walking the
+            // headers up to the block, once per chunk.
+            while (open.frame_offsets.size() <= block_index) {
+                std::uint64_t frame_size = 0;
+                if (!read_frame_size(open.file, chunk, open.frame_offsets.back(), frame_size, error)) {
+                    return false;
+                }
+                open.frame_offsets.push_back(open.frame_offsets.back() + frame_size);
+            }
+            block_valid_ = false;
+            block_.resize(kCodecBlockSize);
+            std::uint64_t next_offset = 0;
+            if (!decode_frame_at(open.file, chunk, open.frame_offsets[block_index],
+                                 std::span<std::byte>(block_.data(), block_size), scratch_, next_offset, error)) {
+                return false;
+            }
+            block_position_ = open.position;
+            block_index_ = block_index;
+            block_valid_ = true;
+        }
+
+        const auto in_block = static_cast<std::size_t>(chunk_offset - block_start);
+        const std::size_t length = std::min(buffer.size(), block_size - in_block);
+        std::copy_n(block_.begin() + static_cast<std::ptrdiff_t>(in_block), length, buffer.begin());
+        buffer = buffer.subspan(length);
+        chunk_offset += length;
+    }
+    return true;
+}
+
+}  // namespace humpty::services
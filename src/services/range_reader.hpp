@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/file_io.hpp"
+
+namespace humpty::services {
+
+// Reads byte ranges of a split source straight from its chunk files, without
+// joining it. The chunks covering a range are found by binary search over
+// their offsets, and only the slices the range needs are read; compressed
+// chunks are decoded from the block that holds the range onwards. The most
+// recently used chunk files stay open. Not safe for concurrent use.
+class RangeReader {
+public:
+    static constexpr std::size_t kDefaultOpenChunks = 16;
+
+    // Loads the manifest, which must be complete and whose chunks must
+    // cover the source without gaps. With `verify_chunks`, the first read
+    // that touches a chunk checks its checksum over the whole chunk.
+    bool open(const std::filesystem::path& manifest_path,
+              bool verify_chunks,
+              std::size_t max_open_chunks,
+              std::string& error);
+
+    [[nodiscard]] const humpty::models::Manifest& manifest() const { return manifest_; }
+    [[nodiscard]] std::uint64_t size() const { return manifest_.source_size; }
+
+    // Fills `buffer` with the source bytes starting at `offset`; the range
+    // must lie within the source.
+    bool read(std::uint64_t offset, std::span<std::byte> buffer, std::string& error);
+
+private:
+    struct OpenChunk {
+        std::size_t position = 0;
+        FileHandle file;
+        // Start of each frame of a compressed chunk, found as reads reach it.
+        std::vector<std::uint64_t> frame_offsets;
+    };
+
+    OpenChunk* open_chunk(std::size_t position, std::string& error);
+    bool verify_chunk(OpenChunk& chunk, std::string& error);
+    bool read_slice(OpenChunk& chunk, std::uint64_t chunk_offset, std::span<std::byte> buffer, std::string& error);
+    bool read_encoded_slice(OpenChunk& chunk,
+                            std::uint64_t chunk_offset,
+                            std::span<std::byte> buffer,
+                            std::string& error);
+
+    humpty::models::Manifest manifest_;
+    std::filesystem::path chunk_dir_;
+    bool verify_ = false;
+    std::size_t max_open_ = kDefaultOpenChunks;
+    // Most recently used first.
+    std::list<OpenChunk> open_chunks_;
+    std::vector<bool> verified_;
+    // The last decoded block, so short sequential reads decode each block
+    // once.
+    std::vector<std::byte> block_;
+    std::vector<std::byte> scratch_;
+    std::size_t block_position_ = 0;
+    std::size_t block_index_ = 0;
+    bool block_valid_ = false;
+};
+
+}  // namespace humpty::services
@@ -1,70 +1,126 @@
 #include "services/splitter.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <span>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <unistd.h>
 
 #include "models/chunk.hpp"
 #include "models/manifest.hpp"
+#include "models/manifest_reader.hpp"
+#include "models/manifest_writer.hpp"
+#include "services/async_copy.hpp"
 #include "services/checksums.hpp"
+#include "services/chunk_codec.hpp"
+#include "services/content_chunking.hpp"
+#include "services/direct_io.hpp"
+#include "services/file_io.hpp"
+#include "services/io_backend.hpp"
+#include "services/kernel_copy.hpp"
+#include "services/mapped_file.hpp"
+#include "services/pipeline.hpp"
+#include "services/progress.hpp"
+#include "services/transfer_stats.hpp"
+#include "services/workers.hpp"
 
 namespace humpty::services {
 namespace {
 
 constexpr std::size_t kBufferSize = 64 * 1024;
+constexpr std::size_t kAsyncSegmentSize = 256 * 1024;
 
-}  // namespace
+// Hands finished chunks to the manifest writer in index order. Parallel and
+// async splits finish chunks out of order; the few that arrive early wait in
+// `pending_` until the gap before them is filled. Progress counts bytes as
+// the split functions copy them and chunks as they arrive, early or not.
+class ChunkRecorder {
+public:
+    ChunkRecorder(humpty::models::ManifestStreamWriter& writer, bool combine_digest, ProgressReporter& progress)
+        : writer_(writer), combine_digest_(combine_digest), progress_(progress) {}
 
-bool split_file(const SplitRequest& request, SplitResult& result, std::string& error) {
-    result = {};
-    error.clear();
+    void copied(std::uint64_t bytes) { progress_.add_bytes(bytes); }
 
-    if (request.chunk_size_bytes == 0) {
-        error = "Chunk size must be greater than zero.";
-        return false;
+    bool record(humpty::models::Chunk chunk, std::string& error) {
+        progress_.add_chunk();
+        std::lock_guard<std::mutex> lock(mutex_);
+        const stats::ScopedTimer timer(stats::Timer::Manifest);
+        pending_.emplace(chunk.index, std::move(chunk));
+        while (!pending_.empty() && pending_.begin()->first == next_index_) {
+            const auto& next = pending_.begin()->second;
+            if (!writer_.append(next, error)) {
+                return false;
+            }
+            if (combine_digest_) {
+                combiner_.add(next.offset, next.size, next.checksum);
+            }
+            if (next.changed) {
+                ++changed_;
+            }
+            stored_bytes_ += next.file_size();
+            pending_.erase(pending_.begin());
+            ++next_index_;
+        }
+        return true;
     }
 
-    if (!std::filesystem::exists(request.input_file)) {
-        error = "Input file does not exist: " + request.input_file.string();
-        return false;
-    }
-    if (!std::filesystem::is_regular_file(request.input_file)) {
-        error = "Input path is not a regular file: " + request.input_file.string();
-        return false;
-    }
+    [[nodiscard]] std::uint64_t recorded() const { return next_index_; }
+    [[nodiscard]] std::size_t changed() const { return changed_; }
+    [[nodiscard]] std::uint64_t stored_bytes() const { return stored_bytes_; }
+    [[nodiscard]] std::string combined_digest() const { return combiner_.hex(); }
 
-    std::error_code ec;
-    std::filesystem::create_directories(request.output_dir, ec);
-    if (ec) {
-        error = "Failed to create output directory: " + request.output_dir.string();
-        return false;
-    }
+private:
+    humpty::models::ManifestStreamWriter& writer_;
+    bool combine_digest_;
+    ProgressReporter& progress_;
+    std::mutex mutex_;
+    std::map<std::uint32_t, humpty::models::Chunk> pending_;
+    std::uint64_t next_index_ = 0;
+    std::size_t changed_ = 0;
+    std::uint64_t stored_bytes_ = 0;
+    ChunkDigestCombiner combiner_;
+};
 
+// Whether the split hashes a stream digest as it goes, which takes the whole
+// input in order on one thread. Parallel splits, and resumed splits that
+// skip chunks, read the input once more on a thread of their own instead.
+bool computes_stream_digest(const SplitRequest& request,
+                            const humpty::models::Manifest& manifest,
+                            std::size_t first_chunk) {
+    return request.compute_checksums && manifest.source_digest == humpty::models::SourceDigest::Stream &&
+           first_chunk == 0 && (request.thread_count <= 1 || is_standard_stream(request.input_file));
+}
+
+bool split_sequential(const SplitRequest& request,
+                      humpty::models::Manifest& manifest,
+                      ChunkRecorder& recorder,
+                      std::size_t first_chunk,
+                      std::string& error) {
     std::ifstream input(request.input_file, std::ios::binary);
     if (!input.is_open()) {
         error = "Failed to open input file: " + request.input_file.string();
         return false;
     }
+    stats::count_open();
 
-    const std::uint64_t source_size = std::filesystem::file_size(request.input_file, ec);
-    if (ec) {
-        error = "Failed to read input size: " + request.input_file.string();
-        return false;
-    }
-
-    humpty::models::Manifest manifest;
-    manifest.source_file_name = request.input_file.filename().string();
-    manifest.source_size = source_size;
-    manifest.chunk_size = request.chunk_size_bytes;
-
+    const bool stream_digest = computes_stream_digest(request, manifest, first_chunk);
     std::array<std::byte, kBufferSize> buffer{};
-    std::uint64_t source_hash_state = 14695981039346656037ULL;
-    std::uint64_t offset = 0;
-    std::uint32_t chunk_index = 0;
+    const stats::BufferCharge buffer_charge(buffer.size());
+    Hasher source_hasher(manifest.checksum_algorithm);
+    std::uint64_t offset = static_cast<std::uint64_t>(first_chunk) * request.chunk_size_bytes;
+    auto chunk_index = static_cast<std::uint32_t>(first_chunk);
+    input.seekg(static_cast<std::streamoff>(offset));
 
-    while (offset < source_size) {
-        const std::uint64_t remaining = source_size - offset;
+    while (offset < manifest.source_size) {
+        const std::uint64_t remaining = manifest.source_size - offset;
         const std::uint64_t chunk_size = (remaining < request.chunk_size_bytes) ? remaining : request.chunk_size_bytes;
 
         humpty::models::Chunk chunk;
@@ -79,9 +135,10 @@ bool split_file(const SplitRequest& request, SplitResult& result, std::string& e
             error = "Failed to open chunk for writing: " + chunk_path.string();
             return false;
         }
+        stats::count_open();
 
         std::uint64_t chunk_bytes_written = 0;
-        std::uint64_t chunk_hash_state = 14695981039346656037ULL;
+        Hasher chunk_hasher(manifest.checksum_algorithm);
 
         while (chunk_bytes_written < chunk_size) {
             const std::uint64_t chunk_remaining = chunk_size - chunk_bytes_written;
@@ -94,6 +151,7 @@ bool split_file(const SplitRequest& request, SplitResult& result, std::string& e
                 error = "Unexpected end of input while splitting file.";
                 return false;
             }
+            stats::count_read(static_cast<std::uint64_t>(got));
 
             const auto view = std::span<const std::byte>(buffer.data(), static_cast<std::size_t>(got));
             chunk_out.write(reinterpret_cast<const char*>(buffer.data()), got);
@@ -101,32 +159,1094 @@ bool split_file(const SplitRequest& request, SplitResult& result, std::string& e
                 error = "Failed writing chunk file: " + chunk_path.string();
                 return false;
             }
+            stats::count_write(static_cast<std::uint64_t>(got));
+            recorder.copied(static_cast<std::uint64_t>(got));
 
-            chunk_hash_state = fnv1a64(view, chunk_hash_state);
-            source_hash_state = fnv1a64(view, source_hash_state);
+            chunk_hasher.update(view);
+            if (stream_digest) {
+                source_hasher.update(view);
+            }
             chunk_bytes_written += static_cast<std::uint64_t>(got);
             offset += static_cast<std::uint64_t>(got);
         }
 
-        chunk.checksum = fnv1a64_hex({}, chunk_hash_state);
-        manifest.chunks.push_back(std::move(chunk));
+        chunk.checksum = chunk_hasher.hex();
+        if (!recorder.record(std::move(chunk), error)) {
+            return false;
+        }
         ++chunk_index;
     }
 
-    manifest.source_checksum = fnv1a64_hex({}, source_hash_state);
-    if (!manifest.is_valid()) {
-        error = "Generated manifest is invalid.";
+    if (stream_digest) {
+        manifest.source_checksum = source_hasher.hex();
+    }
+    return true;
+}
+
+// Splits standard input, whose length is unknown until it ends. Each chunk
+// file is opened once its first block arrives and closed when it is full,
+// so a chunk is never cut before the input ends. Blocks are compressed one
+// frame at a time when a codec is set.
+bool split_standard_input(const SplitRequest& request,
+                          humpty::models::Manifest& manifest,
+                          ChunkRecorder& recorder,
+                          std::string& error) {
+    FileHandle input;
+    if (!input.open_standard_input()) {
+        error = "Failed to open standard input.";
         return false;
     }
 
+    const bool hashing = request.compute_checksums;
+    const bool stream_digest = computes_stream_digest(request, manifest, 0);
+    const bool encoding = request.codec != humpty::models::ChunkCodec::None;
+    std::vector<std::byte> block(kCodecBlockSize);
+    std::vector<std::byte> frame(encoding ? max_encoded_frame_size(kCodecBlockSize) : 0);
+    const stats::BufferCharge buffer_charge(block.size() + frame.size());
+    Hasher source_hasher(manifest.checksum_algorithm);
+    std::uint64_t offset = 0;
+    std::uint64_t chunk_index = 0;
+    bool at_end = false;
+
+    while (!at_end) {
+        if (chunk_index > std::numeric_limits<std::uint32_t>::max()) {
+            error = "Too many chunks for chunk size.";
+            return false;
+        }
+        humpty::models::Chunk chunk;
+        chunk.index = static_cast<std::uint32_t>(chunk_index);
+        chunk.offset = offset;
+        chunk.file_name = humpty::models::make_chunk_filename(manifest.source_file_name, chunk.index);
+        const std::filesystem::path chunk_path = request.output_dir / chunk.file_name;
+        FileHandle chunk_out;
+        Hasher chunk_hasher(manifest.checksum_algorithm);
+
+        while (chunk.size < request.chunk_size_bytes) {
+            const auto want = static_cast<std::size_t>(
+                std::min<std::uint64_t>(request.chunk_size_bytes - chunk.size, block.size()));
+            std::size_t got = 0;
+            if (!input.read_full(std::span<std::byte>(block.data(), want), got)) {
+                error = "Failed reading standard input.";
+                return false;
+            }
+            if (got == 0) {
+                at_end = true;
+                break;
+            }
+            if (!chunk_out.is_open() && !chunk_out.open_write(chunk_path)) {
+                error = "Failed to open chunk for writing: " + chunk_path.string();
+                return false;
+            }
+
+            const auto view = std::span<const std::byte>(block.data(), got);
+            auto data = view;
+            if (encoding) {
+                data = std::span<const std::byte>(frame.data(), encode_frame(request.codec, view, frame));
+                chunk.stored_size += data.size();
+            }
+            if (!chunk_out.write_all(data)) {
+                error = "Failed writing chunk file: " + chunk_path.string();
+                return false;
+            }
+            if (hashing) {
+                chunk_hasher.update(view);
+                if (stream_digest) {
+                    source_hasher.update(view);
+                }
+            }
+            chunk.size += got;
+            recorder.copied(got);
+            if (got < want) {
+                at_end = true;
+            }
+        }
+        if (chunk.size == 0) {
+            break;
+        }
+
+        chunk.checksum = hashing ? chunk_hasher.hex() : std::string();
+        chunk.codec = request.codec;
+        offset += chunk.size;
+        if (!recorder.record(std::move(chunk), error)) {
+            return false;
+        }
+        ++chunk_index;
+    }
+
+    manifest.source_size = offset;
+    if (stream_digest) {
+        manifest.source_checksum = source_hasher.hex();
+    }
+    return true;
+}
+
+bool open_input(const SplitRequest& request,
+                const humpty::models::Manifest& manifest,
+                FileHandle& input,
+                std::string& error) {
+    const bool opened = request.direct_io ? input.open_read_direct(request.input_file) : input.open_read(request.input_file);
+    if (!opened) {
+        error = "Failed to open input file: " + request.input_file.string();
+        return false;
+    }
+
+    // The mapped engine must never touch pages past EOF, so re-check the size
+    // on the open descriptor rather than trusting the earlier stat.
+    std::uint64_t input_size = 0;
+    if (!input.size(input_size) || input_size < manifest.source_size) {
+        error = "Unexpected end of input while splitting file.";
+        return false;
+    }
+    return true;
+}
+
+bool count_fixed_chunks(const SplitRequest& request,
+                        const humpty::models::Manifest& manifest,
+                        std::size_t& chunk_count,
+                        std::string& error) {
+    const std::uint64_t count = (manifest.source_size + request.chunk_size_bytes - 1) / request.chunk_size_bytes;
+    if (count > static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max()) + 1) {
+        error = "Too many chunks for chunk size.";
+        return false;
+    }
+    chunk_count = static_cast<std::size_t>(count);
+    return true;
+}
+
+humpty::models::Chunk make_fixed_chunk(const SplitRequest& request,
+                                       const humpty::models::Manifest& manifest,
+                                       std::size_t index) {
+    humpty::models::Chunk chunk;
+    chunk.index = static_cast<std::uint32_t>(index);
+    chunk.offset = static_cast<std::uint64_t>(index) * request.chunk_size_bytes;
+    chunk.size = std::min(request.chunk_size_bytes, manifest.source_size - chunk.offset);
+    chunk.file_name = humpty::models::make_chunk_filename(manifest.source_file_name, chunk.index);
+    return chunk;
+}
+
+// Store objects a split has already taken on, so a chunk that repeats within
+// the input is written once even when several workers meet it together.
+class StoreClaims {
+public:
+    bool claim(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return names_.insert(name).second;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_set<std::string> names_;
+};
+
+humpty::models::Chunk make_cdc_chunk(const humpty::models::Manifest& manifest,
+                                     std::span<const std::uint64_t> chunk_ends,
+                                     std::size_t index) {
+    humpty::models::Chunk chunk;
+    chunk.index = static_cast<std::uint32_t>(index);
+    chunk.offset = index == 0 ? 0 : chunk_ends[index - 1];
+    chunk.size = chunk_ends[index] - chunk.offset;
+    chunk.file_name = humpty::models::make_chunk_filename(manifest.source_file_name, chunk.index);
+    return chunk;
+}
+
+struct SplitContext {
+    const SplitRequest& request;
+    const FileHandle& input;
+    humpty::models::ChecksumAlgorithm algorithm;
+    Hasher* source_hasher = nullptr;
+    AlignedBufferPool* buffers = nullptr;
+    // The chunks of the manifest an incremental split replaces.
+    const std::vector<humpty::models::Chunk>* previous = nullptr;
+    StoreClaims* store_claims = nullptr;
+    ChunkRecorder* recorder = nullptr;
+};
+
+bool split_chunk_buffered(const SplitContext& context, humpty::models::Chunk& chunk, std::string& error) {
+    const std::filesystem::path chunk_path = context.request.output_dir / chunk.file_name;
+    FileHandle chunk_out;
+    if (!chunk_out.open_write(chunk_path)) {
+        error = "Failed to open chunk for writing: " + chunk_path.string();
+        return false;
+    }
+
+    std::vector<std::byte> buffer(kBufferSize);
+    const stats::BufferCharge buffer_charge(buffer.size());
+    Hasher chunk_hasher(context.algorithm);
+    std::uint64_t done = 0;
+
+    while (done < chunk.size) {
+        const std::uint64_t chunk_remaining = chunk.size - done;
+        const std::size_t to_read = static_cast<std::size_t>(
+            (chunk_remaining < static_cast<std::uint64_t>(buffer.size())) ? chunk_remaining : buffer.size());
+
+        const auto view = std::span<std::byte>(buffer.data(), to_read);
+        if (!context.input.read_exact_at(view, chunk.offset + done)) {
+            error = "Unexpected end of input while splitting file.";
+            return false;
+        }
+        if (!chunk_out.write_all(view)) {
+            error = "Failed writing chunk file: " + chunk_path.string();
+            return false;
+        }
+
+        chunk_hasher.update(view);
+        if (context.source_hasher != nullptr) {
+            context.source_hasher->update(view);
+        }
+        done += to_read;
+        context.recorder->copied(to_read);
+    }
+
+    chunk.checksum = chunk_hasher.hex();
+    return true;
+}
+
+bool split_chunk_mapped(const SplitContext& context, humpty::models::Chunk& chunk, std::string& error) {
+    const std::filesystem::path chunk_path = context.request.output_dir / chunk.file_name;
+    FileHandle chunk_out;
+    if (!chunk_out.open_write(chunk_path)) {
+        error = "Failed to open chunk for writing: " + chunk_path.string();
+        return false;
+    }
+
+    MappedRegion window;
+    Hasher chunk_hasher(context.algorithm);
+    std::uint64_t done = 0;
+
+    while (done < chunk.size) {
+        const std::uint64_t chunk_remaining = chunk.size - done;
+        const std::size_t to_map = static_cast<std::size_t>(
+            (chunk_remaining < static_cast<std::uint64_t>(kMapWindowSize)) ? chunk_remaining : kMapWindowSize);
+
+        if (!window.map_read(context.input, chunk.offset + done, to_map)) {
+            error = "Failed to map input file: " + context.request.input_file.string();
+            return false;
+        }
+        window.advise_sequential();
+
+        const auto view = window.bytes();
+        if (!chunk_out.write_all(view)) {
+            error = "Failed writing chunk file: " + chunk_path.string();
+            return false;
+        }
+
+        chunk_hasher.update(view);
+        if (context.source_hasher != nullptr) {
+            context.source_hasher->update(view);
+        }
+        done += to_map;
+        context.recorder->copied(to_map);
+    }
+
+    chunk.checksum = chunk_hasher.hex();
+    return true;
+}
+
+bool split_chunk_copied(const SplitContext& context, humpty::models::Chunk& chunk, std::string& error) {
+    const std::filesystem::path chunk_path = context.request.output_dir / chunk.file_name;
+    FileHandle chunk_out;
+    if (!chunk_out.open_write(chunk_path)) {
+        error = "Failed to open chunk for writing: " + chunk_path.string();
+        return false;
+    }
+
+    if (!kernel_copy_blocks(context.input, chunk.offset, chunk_out, 0, chunk.size,
+                            [&](std::uint64_t bytes) { context.recorder->copied(bytes); })) {
+        error = "Failed copying input range into chunk file: " + chunk_path.string();
+        return false;
+    }
+
+    chunk.checksum.clear();
+    return true;
+}
+
+bool split_chunk_direct(const SplitContext& context, humpty::models::Chunk& chunk, std::string& error) {
+    const std::filesystem::path chunk_path = context.request.output_dir / chunk.file_name;
+    FileHandle chunk_out;
+    FileHandle chunk_direct;
+    if (!chunk_out.open_write(chunk_path) || !chunk_direct.open_write_direct(chunk_path)) {
+        error = "Failed to open chunk for writing: " + chunk_path.string();
+        return false;
+    }
+
+    const auto read_buffer = context.buffers->acquire();
+    const auto staging = context.buffers->acquire();
+    DirectWriter writer(chunk_direct, chunk_out, 0, staging.bytes());
+    Hasher chunk_hasher(context.algorithm);
+    const bool hashing = context.request.compute_checksums;
+
+    if (!direct_read_range(
+            context.input, chunk.offset, chunk.size, read_buffer.bytes(),
+            [&](std::span<const std::byte> data, std::string& data_error) {
+                if (!writer.write(data)) {
+                    data_error = "Failed writing chunk file: " + chunk_path.string();
+                    return false;
+                }
+                if (hashing) {
+                    chunk_hasher.update(data);
+                    if (context.source_hasher != nullptr) {
+                        context.source_hasher->update(data);
+                    }
+                }
+                context.recorder->copied(data.size());
+                return true;
+            },
+            context.request.input_file.string(), error)) {
+        return false;
+    }
+    if (!writer.finish()) {
+        error = "Failed writing chunk file: " + chunk_path.string();
+        return false;
+    }
+
+    chunk.checksum = hashing ? chunk_hasher.hex() : std::string();
+    return true;
+}
+
+// Sets the chunk's checksum from its input range without writing anything.
+bool hash_input_range(const SplitContext& context, humpty::models::Chunk& chunk, std::string& error) {
+    std::vector<std::byte> buffer(kBufferSize);
+    const stats::BufferCharge buffer_charge(buffer.size());
+    Hasher chunk_hasher(context.algorithm);
+    std::uint64_t done = 0;
+
+    while (done < chunk.size) {
+        const std::uint64_t chunk_remaining = chunk.size - done;
+        const std::size_t to_read = static_cast<std::size_t>(
+            (chunk_remaining < static_cast<std::uint64_t>(buffer.size())) ? chunk_remaining : buffer.size());
+
+        const auto view = std::span<std::byte>(buffer.data(), to_read);
+        if (!context.input.read_exact_at(view, chunk.offset + done)) {
+            error = "Unexpected end of input while splitting file.";
+            return false;
+        }
+        chunk_hasher.update(view);
+        if (context.source_hasher != nullptr) {
+            context.source_hasher->update(view);
+        }
+        done += to_read;
+        context.recorder->copied(to_read);
+    }
+    chunk.checksum = chunk_hasher.hex();
+    return true;
+}
+
+bool copy_input_range(const SplitContext& context,
+                      const humpty::models::Chunk& chunk,
+                      const std::filesystem::path& chunk_path,
+                      std::string& error) {
+    FileHandle chunk_out;
+    if (!chunk_out.open_write(chunk_path)) {
+        error = "Failed to open chunk for writing: " + chunk_path.string();
+        return false;
+    }
+    if (!kernel_copy(context.input, chunk.offset, chunk_out, 0, chunk.size)) {
+        error = "Failed copying input range into chunk file: " + chunk_path.string();
+        return false;
+    }
+    return true;
+}
+
+// Hashes the input range before touching the chunk file, which is left alone
+// when the previous manifest has the same file with the same digest and size
+// and the file still has that size. The offset is not compared: the file
+// holds the same bytes wherever they now sit in the input. Changed ranges are
+// copied inside the kernel.
+bool split_chunk_incremental(const SplitContext& context, humpty::models::Chunk& chunk, std::string& error) {
+    if (!hash_input_range(context, chunk, error)) {
+        return false;
+    }
+
+    const std::filesystem::path chunk_path = context.request.output_dir / chunk.file_name;
+    const auto& previous = *context.previous;
+    if (chunk.index < previous.size()) {
+        const auto& old = previous[chunk.index];
+        std::error_code ec;
+        if (old.index == chunk.index && old.size == chunk.size && old.file_name == chunk.file_name &&
+            old.checksum == chunk.checksum && std::filesystem::file_size(chunk_path, ec) == chunk.size && !ec) {
+            return true;
+        }
+    }
+
+    chunk.changed = true;
+    return copy_input_range(context, chunk, chunk_path, error);
+}
+
+// Names the chunk after its digest and size and writes it to the chunk store
+// unless an object of that name and size is already there. New objects are
+// written under a temporary name and renamed into place, so a concurrent
+// split never finds a partial one.
+bool split_chunk_stored(const SplitContext& context, humpty::models::Chunk& chunk, std::string& error) {
+    if (!hash_input_range(context, chunk, error)) {
+        return false;
+    }
+
+    chunk.file_name = humpty::models::make_store_object_name(chunk.checksum, chunk.size);
+    const auto object_path = context.request.chunk_store / chunk.file_name;
+    std::error_code ec;
+    if (!context.store_claims->claim(chunk.file_name) ||
+        (std::filesystem::file_size(object_path, ec) == chunk.size && !ec)) {
+        return true;
+    }
+
+    std::filesystem::create_directories(object_path.parent_path(), ec);
+    auto temp_path = object_path;
+    temp_path += ".tmp-" + std::to_string(::getpid()) + "-" + std::to_string(chunk.index);
+    if (!copy_input_range(context, chunk, temp_path, error)) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    std::filesystem::rename(temp_path, object_path, ec);
+    if (ec) {
+        error = "Failed to add chunk to store: " + object_path.string();
+        return false;
+    }
+    chunk.changed = true;
+    return true;
+}
+
+// Reads the chunk a block at a time, hashes the raw data and writes each
+// block compressed as one frame. Workers compress their chunks in parallel.
+bool split_chunk_encoded(const SplitContext& context, humpty::models::Chunk& chunk, std::string& error) {
+    const std::filesystem::path chunk_path = context.request.output_dir / chunk.file_name;
+    FileHandle chunk_out;
+    if (!chunk_out.open_write(chunk_path)) {
+        error = "Failed to open chunk for writing: " + chunk_path.string();
+        return false;
+    }
+
+    std::vector<std::byte> block(kCodecBlockSize);
+    std::vector<std::byte> frame(max_encoded_frame_size(kCodecBlockSize));
+    const stats::BufferCharge buffer_charge(block.size() + frame.size());
+    Hasher chunk_hasher(context.algorithm);
+    const bool hashing = context.request.compute_checksums;
+    std::uint64_t done = 0;
+    std::uint64_t stored = 0;
+
+    while (done < chunk.size) {
+        const auto view = std::span<std::byte>(
+            block.data(), static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size - done, block.size())));
+        if (!context.input.read_exact_at(view, chunk.offset + done)) {
+            error = "Unexpected end of input while splitting file.";
+            return false;
+        }
+        const std::size_t frame_size = encode_frame(context.request.codec, view, frame);
+        if (!chunk_out.write_all(std::span<const std::byte>(frame.data(), frame_size))) {
+            error = "Failed writing chunk file: " + chunk_path.string();
+            return false;
+        }
+
+        if (hashing) {
+            chunk_hasher.update(view);
+            if (context.source_hasher != nullptr) {
+                context.source_hasher->update(view);
+            }
+        }
+        done += view.size();
+        stored += frame_size;
+        context.recorder->copied(view.size());
+    }
+
+    chunk.checksum = hashing ? chunk_hasher.hex() : std::string();
+    chunk.codec = context.request.codec;
+    chunk.stored_size = stored;
+    return true;
+}
+
+bool split_positional(const SplitRequest& request,
+                      humpty::models::Manifest& manifest,
+                      ChunkRecorder& recorder,
+                      std::size_t first_chunk,
+                      std::span<const std::uint64_t> chunk_ends,
+                      const std::vector<humpty::models::Chunk>* previous,
+                      std::string& error) {
+    FileHandle input;
+    std::size_t chunk_count = chunk_ends.size();
+    if (!open_input(request, manifest, input, error) ||
+        (chunk_ends.empty() && !count_fixed_chunks(request, manifest, chunk_count, error))) {
+        return false;
+    }
+
+    const bool stream_digest = computes_stream_digest(request, manifest, first_chunk);
+    Hasher source_hasher(manifest.checksum_algorithm);
+    // A stream digest hashed on the way needs the chunks in index order on
+    // this thread.
+    const std::size_t thread_count = stream_digest ? 1 : request.thread_count;
+
+    // Each direct-I/O worker holds a read buffer and a write staging buffer.
+    AlignedBufferPool buffers(request.direct_io ? 2 * thread_count : 0, request.direct_buffer_size);
+    const stats::BufferCharge buffer_charge(request.direct_io ? 2 * thread_count * request.direct_buffer_size : 0);
+    if (request.direct_io && !buffers.is_valid()) {
+        error = "Failed to allocate direct I/O buffers.";
+        return false;
+    }
+
+    StoreClaims store_claims;
+    const SplitContext context{request, input, manifest.checksum_algorithm, stream_digest ? &source_hasher : nullptr,
+                               &buffers, previous, &store_claims, &recorder};
+    auto split_chunk = (request.io_engine == IoEngine::Mmap) ? split_chunk_mapped : split_chunk_buffered;
+    if (!request.chunk_store.empty()) {
+        split_chunk = split_chunk_stored;
+    } else if (previous != nullptr) {
+        split_chunk = split_chunk_incremental;
+    } else if (request.codec != humpty::models::ChunkCodec::None) {
+        split_chunk = split_chunk_encoded;
+    } else if (request.direct_io) {
+        split_chunk = split_chunk_direct;
+    } else if (!request.compute_checksums) {
+        split_chunk = split_chunk_copied;
+    }
+
+    if (!parallel_for_each_index(
+            chunk_count - first_chunk, thread_count,
+            [&](std::size_t index, std::string& task_error) {
+                const std::size_t chunk_index = first_chunk + index;
+                auto chunk = chunk_ends.empty() ? make_fixed_chunk(request, manifest, chunk_index)
+                                                : make_cdc_chunk(manifest, chunk_ends, chunk_index);
+                return split_chunk(context, chunk, task_error) && recorder.record(std::move(chunk), task_error);
+            },
+            error)) {
+        return false;
+    }
+
+    if (stream_digest) {
+        manifest.source_checksum = source_hasher.hex();
+    }
+    return true;
+}
+
+bool split_async(const SplitRequest& request,
+                 humpty::models::Manifest& manifest,
+                 ChunkRecorder& recorder,
+                 std::size_t first_chunk,
+                 std::string& error) {
+    FileHandle input;
+    std::size_t chunk_count = 0;
+    if (!open_input(request, manifest, input, error) || !count_fixed_chunks(request, manifest, chunk_count, error)) {
+        return false;
+    }
+
+    const bool stream_digest = computes_stream_digest(request, manifest, first_chunk);
+    Hasher source_hasher(manifest.checksum_algorithm);
+    Hasher chunk_hasher(manifest.checksum_algorithm);
+    std::uint64_t chunk_bytes_hashed = 0;
+    struct InFlightChunk {
+        humpty::models::Chunk chunk;
+        FileHandle output;
+    };
+    std::map<std::size_t, InFlightChunk> in_flight;
+
+    AsyncCopyCallbacks callbacks;
+    callbacks.open_range = [&](std::size_t index, RangeCopy& range, std::string& range_error) {
+        auto chunk = make_fixed_chunk(request, manifest, first_chunk + index);
+        const std::filesystem::path chunk_path = request.output_dir / chunk.file_name;
+        FileHandle chunk_out;
+        if (!chunk_out.open_write(chunk_path)) {
+            range_error = "Failed to open chunk for writing: " + chunk_path.string();
+            return false;
+        }
+
+        range.source_fd = input.fd();
+        range.source_offset = chunk.offset;
+        range.target_fd = chunk_out.fd();
+        range.target_offset = 0;
+        range.length = chunk.size;
+        range.source_name = request.input_file.string();
+        range.target_name = chunk_path.string();
+        in_flight.emplace(index, InFlightChunk{std::move(chunk), std::move(chunk_out)});
+        return true;
+    };
+    callbacks.on_data = [&](std::size_t index, std::span<const std::byte> data, std::string&) {
+        chunk_hasher.update(data);
+        if (stream_digest) {
+            source_hasher.update(data);
+        }
+        chunk_bytes_hashed += data.size();
+        recorder.copied(data.size());
+        auto& chunk = in_flight.at(index).chunk;
+        if (chunk_bytes_hashed == chunk.size) {
+            chunk.checksum = chunk_hasher.hex();
+            chunk_hasher = Hasher(manifest.checksum_algorithm);
+            chunk_bytes_hashed = 0;
+        }
+        return true;
+    };
+    callbacks.on_range_done = [&](std::size_t index, std::string& range_error) {
+        const auto entry = in_flight.find(index);
+        auto chunk = std::move(entry->second.chunk);
+        in_flight.erase(entry);
+        return recorder.record(std::move(chunk), range_error);
+    };
+
+    auto backend = make_io_backend(static_cast<unsigned>(request.queue_depth));
+    if (!async_copy_ranges(*backend, chunk_count - first_chunk, request.queue_depth, kAsyncSegmentSize, callbacks,
+                           error)) {
+        return false;
+    }
+
+    if (stream_digest) {
+        manifest.source_checksum = source_hasher.hex();
+    }
+    return true;
+}
+
+bool split_pipelined(const SplitRequest& request,
+                     humpty::models::Manifest& manifest,
+                     ChunkRecorder& recorder,
+                     std::size_t first_chunk,
+                     std::string& error) {
+    FileHandle input;
+    std::size_t chunk_count = 0;
+    if (!open_input(request, manifest, input, error) || !count_fixed_chunks(request, manifest, chunk_count, error)) {
+        return false;
+    }
+    input.advise_sequential();
+
+    const bool stream_digest = computes_stream_digest(request, manifest, first_chunk);
+    std::size_t read_index = first_chunk;
+    std::uint64_t read_done = 0;
+    Hasher source_hasher(manifest.checksum_algorithm);
+    Hasher chunk_hasher(manifest.checksum_algorithm);
+    FileHandle chunk_out;
+    humpty::models::Chunk read_chunk = make_fixed_chunk(request, manifest, first_chunk);
+
+    // A chunk is recorded once both the hash and the write stage are past its
+    // last segment; whichever finishes second records it.
+    std::mutex finished_mutex;
+    std::map<std::size_t, std::pair<humpty::models::Chunk, int>> finishing;
+    auto finish_stage = [&](std::size_t index, const std::string* checksum, std::string& stage_error) {
+        std::unique_lock<std::mutex> lock(finished_mutex);
+        auto [entry, inserted] = finishing.try_emplace(index);
+        if (inserted) {
+            entry->second.first = make_fixed_chunk(request, manifest, index);
+        }
+        if (checksum != nullptr) {
+            entry->second.first.checksum = *checksum;
+        }
+        if (++entry->second.second < 2) {
+            return true;
+        }
+        auto chunk = std::move(entry->second.first);
+        finishing.erase(entry);
+        lock.unlock();
+        return recorder.record(std::move(chunk), stage_error);
+    };
+
+    PipelineStages stages;
+    stages.read = [&](std::span<std::byte> buffer, PipelineSegment& segment, bool& done, std::string& read_error) {
+        if (read_index == chunk_count) {
+            done = true;
+            return true;
+        }
+
+        const auto& chunk = read_chunk;
+        const std::uint64_t chunk_remaining = chunk.size - read_done;
+        const auto view = buffer.first(static_cast<std::size_t>(
+            (chunk_remaining < static_cast<std::uint64_t>(buffer.size())) ? chunk_remaining : buffer.size()));
+        if (!input.read_exact_at(view, chunk.offset + read_done)) {
+            read_error = "Unexpected end of input while splitting file.";
+            return false;
+        }
+
+        read_done += view.size();
+        segment.range_index = read_index;
+        segment.data = view;
+        segment.last_in_range = read_done == chunk.size;
+        if (segment.last_in_range) {
+            ++read_index;
+            read_done = 0;
+            if (read_index < chunk_count) {
+                read_chunk = make_fixed_chunk(request, manifest, read_index);
+            }
+        }
+        return true;
+    };
+    stages.hash = [&](const PipelineSegment& segment, std::string& hash_error) {
+        chunk_hasher.update(segment.data);
+        if (stream_digest) {
+            source_hasher.update(segment.data);
+        }
+        if (segment.last_in_range) {
+            const std::string checksum = chunk_hasher.hex();
+            chunk_hasher = Hasher(manifest.checksum_algorithm);
+            return finish_stage(segment.range_index, &checksum, hash_error);
+        }
+        return true;
+    };
+    stages.write = [&](const PipelineSegment& segment, std::string& write_error) {
+        const std::filesystem::path chunk_path =
+            request.output_dir /
+            humpty::models::make_chunk_filename(manifest.source_file_name, static_cast<std::uint32_t>(segment.range_index));
+        if (!chunk_out.is_open() && !chunk_out.open_write(chunk_path)) {
+            write_error = "Failed to open chunk for writing: " + chunk_path.string();
+            return false;
+        }
+        if (!chunk_out.write_all(segment.data)) {
+            write_error = "Failed writing chunk file: " + chunk_path.string();
+            return false;
+        }
+        recorder.copied(segment.data.size());
+        if (segment.last_in_range) {
+            chunk_out.close();
+            return finish_stage(segment.range_index, nullptr, write_error);
+        }
+        return true;
+    };
+
+    if (!run_pipeline(kPipelineBufferCount, kPipelineBufferSize, stages, error)) {
+        return false;
+    }
+
+    if (stream_digest) {
+        manifest.source_checksum = source_hasher.hex();
+    }
+    return true;
+}
+
+// Carries over the records of an earlier, interrupted split into `recorder`.
+// Each record must be the chunk this split would write at that index, with a
+// digest if this split computes them, and its file must still have the
+// recorded size; the digest itself is trusted rather than re-read. Stops at
+// the first record that does not hold up and reports how many were kept, and
+// whether the earlier split had finished.
+bool resume_split(const SplitRequest& request,
+                  const humpty::models::Manifest& manifest,
+                  const std::filesystem::path& manifest_path,
+                  std::size_t chunk_count,
+                  ChunkRecorder& recorder,
+                  std::size_t& first_chunk,
+                  bool& previous_complete,
+                  std::string& error) {
+    first_chunk = 0;
+    previous_complete = false;
+    humpty::models::ManifestReader reader;
+    std::string reader_error;
+    if (!std::filesystem::exists(manifest_path) || !reader.open(manifest_path, reader_error)) {
+        return true;
+    }
+
+    const auto& previous = reader.header();
+    if (previous.format_version != manifest.format_version ||
+        previous.source_file_name != manifest.source_file_name || previous.chunk_size != manifest.chunk_size ||
+        previous.source_digest != manifest.source_digest ||
+        previous.checksum_algorithm != manifest.checksum_algorithm || previous.codec != manifest.codec ||
+        (previous.complete && previous.source_size != manifest.source_size)) {
+        return true;
+    }
+    previous_complete = previous.complete;
+
+    while (first_chunk < chunk_count) {
+        humpty::models::Chunk chunk;
+        bool done = false;
+        if (!reader.next(chunk, done, reader_error) || done) {
+            break;
+        }
+
+        const auto expected = make_fixed_chunk(request, manifest, first_chunk);
+        if (chunk.index != expected.index || chunk.offset != expected.offset || chunk.size != expected.size ||
+            chunk.file_name != expected.file_name || chunk.checksum.empty() == request.compute_checksums) {
+            break;
+        }
+        std::error_code ec;
+        const auto file_size = std::filesystem::file_size(request.output_dir / chunk.file_name, ec);
+        if (ec || file_size != chunk.file_size()) {
+            break;
+        }
+
+        recorder.copied(chunk.size);
+        if (!recorder.record(std::move(chunk), error)) {
+            return false;
+        }
+        ++first_chunk;
+    }
+    return true;
+}
+
+// Loads the records of the manifest an incremental split replaces. A missing
+// or unreadable manifest, or one for another file or checksum algorithm,
+// leaves `previous` empty, so every chunk counts as changed.
+void load_previous_chunks(const humpty::models::Manifest& manifest,
+                          const std::filesystem::path& manifest_path,
+                          std::vector<humpty::models::Chunk>& previous) {
+    previous.clear();
+    const stats::ScopedTimer timer(stats::Timer::Manifest);
+    std::string error;
+    if (!std::filesystem::exists(manifest_path)) {
+        return;
+    }
+    auto old = humpty::models::read_manifest(manifest_path, error);
+    if (!old || old->source_file_name != manifest.source_file_name ||
+        old->checksum_algorithm != manifest.checksum_algorithm) {
+        return;
+    }
+    previous = std::move(old->chunks);
+}
+
+// Deletes the chunk files of a previous split that lie past the end of the
+// new input. Only names of the default pattern are touched.
+void remove_stale_chunks(const SplitRequest& request,
+                         const humpty::models::Manifest& manifest,
+                         const std::vector<humpty::models::Chunk>& previous,
+                         std::size_t chunk_count) {
+    for (const auto& chunk : previous) {
+        if (chunk.index >= chunk_count &&
+            chunk.file_name == humpty::models::make_chunk_filename(manifest.source_file_name, chunk.index)) {
+            std::error_code ec;
+            std::filesystem::remove(request.output_dir / chunk.file_name, ec);
+        }
+    }
+}
+
+}  // namespace
+
+bool split_file(const SplitRequest& request, SplitResult& result, std::string& error) {
+    result = {};
+    error.clear();
+    stats::Collection collection(request.collect_stats);
+
+    if (request.chunk_size_bytes == 0) {
+        error = "Chunk size must be greater than zero.";
+        return false;
+    }
+
+    const bool standard_input = is_standard_stream(request.input_file);
+    if (!standard_input && !std::filesystem::exists(request.input_file)) {
+        error = "Input file does not exist: " + request.input_file.string();
+        return false;
+    }
+    if (!standard_input && !std::filesystem::is_regular_file(request.input_file)) {
+        error = "Input path is not a regular file: " + request.input_file.string();
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(request.output_dir, ec);
+    if (ec) {
+        error = "Failed to create output directory: " + request.output_dir.string();
+        return false;
+    }
+
+    // Standard input's size is only known once it ends.
+    const std::uint64_t source_size = standard_input ? 0 : std::filesystem::file_size(request.input_file, ec);
+    if (ec) {
+        error = "Failed to read input size: " + request.input_file.string();
+        return false;
+    }
+
+    humpty::models::Manifest manifest;
+    manifest.source_file_name = !request.source_name.empty() ? request.source_name
+                                : standard_input             ? std::string("stdin")
+                                                             : request.input_file.filename().string();
+    manifest.source_size = source_size;
+    manifest.chunk_size = request.chunk_size_bytes;
+    manifest.source_digest = request.source_digest;
+    manifest.checksum_algorithm = request.checksum_algorithm;
+    manifest.codec = request.codec;
+    if (request.manifest_format == humpty::models::ManifestFormat::Binary) {
+        manifest.format_version = "2";
+    }
+
+    if (standard_input && (request.resume || request.incremental || request.content_defined ||
+                           !request.chunk_store.empty() || request.direct_io)) {
+        error = "Standard input is split in one pass; --resume, --incremental, --cdc, --store and --direct need a "
+                "regular file.";
+        return false;
+    }
+    if (request.direct_io && request.io_engine != IoEngine::Stream) {
+        error = "Direct I/O is only available with the stream I/O engine.";
+        return false;
+    }
+    if (request.direct_io && !is_valid_direct_buffer_size(request.direct_buffer_size)) {
+        error = "Direct I/O buffer size must be a positive multiple of 4096 bytes.";
+        return false;
+    }
+    if (!request.compute_checksums) {
+        manifest.source_digest = humpty::models::SourceDigest::Stream;
+    }
+    if (!request.chunk_store.empty()) {
+        std::filesystem::create_directories(request.chunk_store, ec);
+        if (ec) {
+            error = "Failed to create chunk store: " + request.chunk_store.string();
+            return false;
+        }
+        // Kept relative when it can be, so the output directory and the store
+        // can move together.
+        const auto store = std::filesystem::absolute(request.chunk_store).lexically_normal();
+        const auto relative = store.lexically_relative(std::filesystem::absolute(request.output_dir).lexically_normal());
+        manifest.chunk_store = relative.empty() ? store.string() : relative.string();
+    }
+    if (request.incremental && request.resume) {
+        error = "An incremental split cannot be resumed.";
+        return false;
+    }
+    if (request.incremental && (!request.compute_checksums || request.direct_io)) {
+        error = "An incremental split needs chunk checksums and buffered I/O.";
+        return false;
+    }
+
+    if (!request.chunk_store.empty() &&
+        (!request.compute_checksums || request.checksum_algorithm != humpty::models::ChecksumAlgorithm::Xxh64)) {
+        error = "A chunk store names chunks by their xxh64 digest; use --checksum xxh64.";
+        return false;
+    }
+    if (!request.chunk_store.empty() && (request.resume || request.incremental || request.direct_io)) {
+        error = "A chunk store split cannot be combined with --resume, --incremental or --direct.";
+        return false;
+    }
+    if (request.codec != humpty::models::ChunkCodec::None &&
+        (!request.chunk_store.empty() || request.incremental || request.direct_io)) {
+        error = "Compressed chunks cannot be combined with --store, --incremental or --direct.";
+        return false;
+    }
+    if (request.content_defined && request.resume) {
+        error = "A content-defined split cannot be resumed.";
+        return false;
+    }
+
+    std::size_t expected_chunks = 0;
+    std::vector<std::uint64_t> chunk_ends;
+    if (request.content_defined) {
+        const auto params =
+            make_cdc_params(request.chunk_size_bytes, request.cdc_min_bytes, request.cdc_max_bytes);
+        if (!is_valid_cdc_params(params)) {
+            error = "Content-defined chunking needs 64 bytes <= minimum < chunk size < maximum <= 256 MiB.";
+            return false;
+        }
+        FileHandle input;
+        if (!open_input(request, manifest, input, error) ||
+            !find_cdc_boundaries(input, manifest.source_size, params, request.thread_count, chunk_ends, error)) {
+            return false;
+        }
+        if (chunk_ends.size() > static_cast<std::size_t>(std::numeric_limits<std::uint32_t>::max()) + 1) {
+            error = "Too many chunks for chunk size.";
+            return false;
+        }
+        expected_chunks = chunk_ends.size();
+    } else if (!count_fixed_chunks(request, manifest, expected_chunks, error)) {
+        return false;
+    }
+
+    // Records go to disk as chunks finish, so a split that stops early
+    // leaves a partial manifest behind rather than none. That manifest is
+    // also the checkpoint a resumed split starts from; its carried-over
+    // records go to a new file that replaces it once they are on disk.
     const auto manifest_path = request.output_dir / (manifest.source_file_name + ".manifest");
-    if (!humpty::models::write_manifest(manifest, manifest_path, error)) {
+    auto writer_path = manifest_path;
+    if (request.resume) {
+        writer_path += ".resume";
+    }
+    std::vector<humpty::models::Chunk> previous;
+    if (request.incremental) {
+        load_previous_chunks(manifest, manifest_path, previous);
+    }
+    humpty::models::ManifestStreamWriter writer;
+    {
+        const stats::ScopedTimer timer(stats::Timer::Manifest);
+        if (!writer.open(writer_path, manifest, error)) {
+            return false;
+        }
+    }
+    const bool combined_digest =
+        request.compute_checksums && manifest.source_digest == humpty::models::SourceDigest::Combined;
+    ProgressReporter progress(request.progress, request.progress_interval);
+    ChunkRecorder recorder(writer, combined_digest, progress);
+
+    std::size_t first_chunk = 0;
+    // A finished split that resumes with every chunk intact keeps its
+    // manifest, whole-file checksum included.
+    bool keep_manifest = false;
+    if (request.resume) {
+        bool previous_complete = false;
+        if (!resume_split(request, manifest, manifest_path, expected_chunks, recorder, first_chunk,
+                          previous_complete, error)) {
+            return false;
+        }
+        keep_manifest = previous_complete && first_chunk == expected_chunks;
+        if (keep_manifest) {
+            std::filesystem::remove(writer_path, ec);
+        } else {
+            if (!writer.flush(true, error)) {
+                return false;
+            }
+            std::filesystem::rename(writer_path, manifest_path, ec);
+            if (ec) {
+                error = "Failed to replace manifest: " + manifest_path.string();
+                return false;
+            }
+        }
+    }
+
+    const bool positional = request.thread_count > 1 || request.io_engine != IoEngine::Stream ||
+                            !request.compute_checksums || request.direct_io;
+    collection.end_setup();
+    progress.start(manifest.source_size, expected_chunks);
+
+    std::string ordered_digest;
+    std::string ordered_error;
+    bool ordered_ok = true;
+    std::thread ordered_reader;
+    if (request.compute_checksums && manifest.source_digest == humpty::models::SourceDigest::Stream &&
+        !standard_input && !keep_manifest && !computes_stream_digest(request, manifest, first_chunk)) {
+        ordered_reader = std::thread([&] {
+            ordered_ok = hash_file_hex(request.input_file, manifest.checksum_algorithm, ordered_digest, ordered_error);
+        });
+    }
+
+    bool ok = true;
+    if (standard_input) {
+        ok = split_standard_input(request, manifest, recorder, error);
+        expected_chunks = static_cast<std::size_t>(recorder.recorded());
+    } else if (first_chunk == expected_chunks) {
+        // Everything was carried over.
+    } else if (request.incremental || request.content_defined || !request.chunk_store.empty() ||
+               request.codec != humpty::models::ChunkCodec::None) {
+        ok = split_positional(request, manifest, recorder, first_chunk, chunk_ends,
+                              request.incremental ? &previous : nullptr, error);
+    } else if (request.io_engine == IoEngine::Uring && request.compute_checksums) {
+        ok = split_async(request, manifest, recorder, first_chunk, error);
+    } else if (positional) {
+        ok = split_positional(request, manifest, recorder, first_chunk, {}, nullptr, error);
+    } else if (request.pipelined) {
+        ok = split_pipelined(request, manifest, recorder, first_chunk, error);
+    } else {
+        ok = split_sequential(request, manifest, recorder, first_chunk, error);
+    }
+    if (ordered_reader.joinable()) {
+        ordered_reader.join();
+        if (ok && !ordered_ok) {
+            error = ordered_error;
+            ok = false;
+        }
+        manifest.source_checksum = ordered_digest;
+    }
+    if (!ok) {
+        return false;
+    }
+    collection.end_data();
+
+    if (recorder.recorded() != expected_chunks) {
+        error = "Generated manifest is invalid.";
         return false;
     }
+    if (combined_digest) {
+        manifest.source_checksum = recorder.combined_digest();
+    }
+    if (!keep_manifest) {
+        const stats::ScopedTimer timer(stats::Timer::Manifest);
+        if (!writer.finish(manifest.source_size, manifest.source_checksum, error)) {
+            return false;
+        }
+    }
+    remove_stale_chunks(request, manifest, previous, expected_chunks);
 
     result.manifest_path = manifest_path;
-    result.chunk_count = manifest.chunks.size();
+    result.chunk_count = writer.chunk_count();
+    result.chunks_resumed = first_chunk;
+    result.chunks_changed = recorder.changed();
     result.total_bytes = manifest.source_size;
+    result.stored_bytes = recorder.stored_bytes();
+    collection.finish(result.stats);
+    progress.finish(manifest.source_size, expected_chunks);
     return true;
 }
 
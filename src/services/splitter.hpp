@@ -1,21 +1,75 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <string>
 
+#include "models/binary_manifest.hpp"
+#include "models/manifest.hpp"
+#include "services/direct_io.hpp"
+#include "services/file_io.hpp"
+#include "services/progress.hpp"
+#include "services/transfer_stats.hpp"
+
 namespace humpty::services {
 
 struct SplitRequest {
+    // "-" reads standard input until it ends, on one thread.
     std::filesystem::path input_file;
     std::filesystem::path output_dir;
     std::uint64_t chunk_size_bytes = 0;
+    // Source name for the manifest and the chunk file names; defaults to the
+    // input's file name, or "stdin".
+    std::string source_name;
+    std::size_t thread_count = 1;
+    humpty::models::SourceDigest source_digest = humpty::models::SourceDigest::Stream;
+    humpty::models::ChecksumAlgorithm checksum_algorithm = humpty::models::ChecksumAlgorithm::Fnv1a64;
+    IoEngine io_engine = IoEngine::Stream;
+    bool compute_checksums = true;
+    std::size_t queue_depth = 32;
+    bool pipelined = false;
+    bool direct_io = false;
+    std::size_t direct_buffer_size = kDefaultDirectBufferSize;
+    humpty::models::ManifestFormat manifest_format = humpty::models::ManifestFormat::Text;
+    // Keep the chunks that the partial manifest of an interrupted split
+    // already records.
+    bool resume = false;
+    // Compare each chunk range against the manifest already in `output_dir`
+    // and rewrite only the chunk files whose digest or size changed.
+    bool incremental = false;
+    // Cut chunks where the content says so instead of every
+    // `chunk_size_bytes`, which then becomes the average chunk size. Zero
+    // bounds default to a quarter and four times the average.
+    bool content_defined = false;
+    std::uint64_t cdc_min_bytes = 0;
+    std::uint64_t cdc_max_bytes = 0;
+    // When set, chunks go to this content-addressed store, named after their
+    // digest and size, instead of into `output_dir`; chunks the store already
+    // holds are not written again.
+    std::filesystem::path chunk_store;
+    // Compress each chunk file with this codec. Checksums still cover the
+    // uncompressed data.
+    humpty::models::ChunkCodec codec = humpty::models::ChunkCodec::None;
+    // Fill SplitResult::stats.
+    bool collect_stats = false;
+    // Called every `progress_interval` from a reporting thread while the
+    // transfer runs, and once more when it succeeds.
+    ProgressCallback progress;
+    std::chrono::milliseconds progress_interval = kDefaultProgressInterval;
 };
 
 struct SplitResult {
     std::filesystem::path manifest_path;
     std::size_t chunk_count = 0;
+    std::size_t chunks_resumed = 0;
+    std::size_t chunks_changed = 0;
     std::uint64_t total_bytes = 0;
+    // Bytes of chunk files the manifest lists; below total_bytes when the
+    // chunks are compressed.
+    std::uint64_t stored_bytes = 0;
+    // Zero unless the request set collect_stats.
+    TransferStats stats;
 };
 
 bool split_file(const SplitRequest& request, SplitResult& result, std::string& error);
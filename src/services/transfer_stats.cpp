@@ -0,0 +1,147 @@
+#include "services/transfer_stats.hpp"
+
+namespace humpty::services::stats {
+namespace {
+
+struct Counters {
+    std::atomic<std::uint64_t> read_calls{0};
+    std::atomic<std::uint64_t> write_calls{0};
+    std::atomic<std::uint64_t> open_calls{0};
+    std::atomic<std::uint64_t> bytes_read{0};
+    std::atomic<std::uint64_t> bytes_written{0};
+    std::atomic<std::uint64_t> hash_nanoseconds{0};
+    std::atomic<std::uint64_t> manifest_nanoseconds{0};
+    std::atomic<std::uint64_t> buffer_bytes{0};
+    std::atomic<std::uint64_t> peak_buffer_bytes{0};
+};
+
+Counters counters;
+
+void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+double seconds_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
+}  // namespace
+
+void count_read(std::uint64_t bytes) {
+    if (enabled()) {
+        add(counters.read_calls, 1);
+        add(counters.bytes_read, bytes);
+    }
+}
+
+void count_write(std::uint64_t bytes) {
+    if (enabled()) {
+        add(counters.write_calls, 1);
+        add(counters.bytes_written, bytes);
+    }
+}
+
+void count_open() {
+    if (enabled()) {
+        add(counters.open_calls, 1);
+    }
+}
+
+ScopedTimer::ScopedTimer(Timer timer) : timer_(timer), running_(enabled()) {
+    if (running_) {
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+ScopedTimer::~ScopedTimer() {
+    if (!running_) {
+        return;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    add(timer_ == Timer::Hash ? counters.hash_nanoseconds : counters.manifest_nanoseconds,
+        static_cast<std::uint64_t>(elapsed.count()));
+}
+
+BufferCharge::BufferCharge(std::size_t bytes) : bytes_(enabled() ? bytes : 0) {
+    if (bytes_ == 0) {
+        return;
+    }
+    const std::uint64_t live = counters.buffer_bytes.fetch_add(bytes_, std::memory_order_relaxed) + bytes_;
+    std::uint64_t peak = counters.peak_buffer_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peak_buffer_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+BufferCharge::~BufferCharge() {
+    if (bytes_ != 0) {
+        counters.buffer_bytes.fetch_sub(bytes_, std::memory_order_relaxed);
+    }
+}
+
+Collection::Collection(bool active) : active_(active) {
+    if (!active_) {
+        return;
+    }
+    if (active_collections.fetch_add(1, std::memory_order_relaxed) == 0) {
+        counters.peak_buffer_bytes.store(counters.buffer_bytes.load(std::memory_order_relaxed),
+                                         std::memory_order_relaxed);
+    }
+    start_ = take_snapshot();
+    started_ = std::chrono::steady_clock::now();
+    setup_done_ = started_;
+    data_done_ = started_;
+}
+
+Collection::~Collection() {
+    if (active_) {
+        active_collections.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void Collection::end_setup() {
+    if (active_) {
+        setup_done_ = std::chrono::steady_clock::now();
+        data_done_ = setup_done_;
+    }
+}
+
+void Collection::end_data() {
+    if (active_) {
+        data_done_ = std::chrono::steady_clock::now();
+    }
+}
+
+void Collection::finish(TransferStats& stats) const {
+    stats = {};
+    if (!active_) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const Snapshot end = take_snapshot();
+    stats.total_seconds = seconds_between(started_, now);
+    stats.setup_seconds = seconds_between(started_, setup_done_);
+    stats.data_seconds = seconds_between(setup_done_, data_done_);
+    stats.finish_seconds = seconds_between(data_done_, now);
+    stats.hash_seconds = static_cast<double>(end.hash_nanoseconds - start_.hash_nanoseconds) / 1e9;
+    stats.manifest_seconds = static_cast<double>(end.manifest_nanoseconds - start_.manifest_nanoseconds) / 1e9;
+    stats.read_calls = end.read_calls - start_.read_calls;
+    stats.write_calls = end.write_calls - start_.write_calls;
+    stats.open_calls = end.open_calls - start_.open_calls;
+    stats.bytes_read = end.bytes_read - start_.bytes_read;
+    stats.bytes_written = end.bytes_written - start_.bytes_written;
+    stats.peak_buffer_bytes = counters.peak_buffer_bytes.load(std::memory_order_relaxed);
+}
+
+Collection::Snapshot Collection::take_snapshot() {
+    Snapshot snapshot;
+    snapshot.read_calls = counters.read_calls.load(std::memory_order_relaxed);
+    snapshot.write_calls = counters.write_calls.load(std::memory_order_relaxed);
+    snapshot.open_calls = counters.open_calls.load(std::memory_order_relaxed);
+    snapshot.bytes_read = counters.bytes_read.load(std::memory_order_relaxed);
+    snapshot.bytes_written = counters.bytes_written.load(std::memory_order_relaxed);
+    snapshot.hash_nanoseconds = counters.hash_nanoseconds.load(std::memory_order_relaxed);
+    snapshot.manifest_nanoseconds = counters.manifest_nanoseconds.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+}  // namespace humpty::services::stats
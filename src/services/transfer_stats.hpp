@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace humpty::services {
+
+// What a split or join measured when its request asked for stats. The
+// phases are wall-clock: setup runs until the first chunk is copied
+// (validation, chunk planning, loading checkpoints and manifests), data
+// copies the chunks, finish checks the totals and completes the manifest.
+// Hashing and manifest times are summed over threads, so they can exceed
+// the phase they fall in.
+struct TransferStats {
+    double total_seconds = 0.0;
+    double setup_seconds = 0.0;
+    double data_seconds = 0.0;
+    double finish_seconds = 0.0;
+    double hash_seconds = 0.0;
+    double manifest_seconds = 0.0;
+    // Reads, writes and opens the transfer issued and the bytes they moved.
+    // A kernel copy counts as one read and one write, a mapped window as one
+    // read or write of its length, and a stream read or write as one call
+    // whatever the stream buffers underneath.
+    std::uint64_t read_calls = 0;
+    std::uint64_t write_calls = 0;
+    std::uint64_t open_calls = 0;
+    std::uint64_t bytes_read = 0;
+    std::uint64_t bytes_written = 0;
+    // Most bytes of I/O buffers allocated at once.
+    std::uint64_t peak_buffer_bytes = 0;
+};
+
+namespace stats {
+
+// The counters are process-wide and only move while a collection is
+// active; otherwise each hook costs one relaxed load. Work that overlaps a
+// collection from another thread is counted into it.
+inline std::atomic<int> active_collections{0};
+
+inline bool enabled() {
+    return active_collections.load(std::memory_order_relaxed) != 0;
+}
+
+void count_read(std::uint64_t bytes);
+void count_write(std::uint64_t bytes);
+void count_open();
+
+enum class Timer {
+    Hash,
+    Manifest,
+};
+
+// Adds the time between construction and destruction to `timer`.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Timer timer);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Timer timer_;
+    bool running_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Counts an I/O buffer towards the live total while it exists.
+class BufferCharge {
+public:
+    explicit BufferCharge(std::size_t bytes);
+    ~BufferCharge();
+
+    BufferCharge(const BufferCharge&) = delete;
+    BufferCharge& operator=(const BufferCharge&) = delete;
+
+private:
+    std::size_t bytes_;
+};
+
+// Collects the stats of one split or join; inactive collections do nothing.
+class Collection {
+public:
+    explicit Collection(bool active);
+    ~Collection();
+
+    Collection(const Collection&) = delete;
+    Collection& operator=(const Collection&) = delete;
+
+    void end_setup();
+    void end_data();
+    // Fills `stats` with everything counted since construction.
+    void finish(TransferStats& stats) const;
+
+private:
+    struct Snapshot {
+        std::uint64_t read_calls = 0;
+        std::uint64_t write_calls = 0;
+        std::uint64_t open_calls = 0;
+        std::uint64_t bytes_read = 0;
+        std::uint64_t bytes_written = 0;
+        std::uint64_t hash_nanoseconds = 0;
+        std::uint64_t manifest_nanoseconds = 0;
+    };
+    static Snapshot take_snapshot();
+
+    bool active_;
+    Snapshot start_;
+    std::chrono::steady_clock::time_point started_;
+    std::chrono::steady_clock::time_point setup_done_;
+    std::chrono::steady_clock::time_point data_done_;
+};
+
+}  // namespace stats
+}  // namespace humpty::services
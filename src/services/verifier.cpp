@@ -0,0 +1,177 @@
+#include "services/verifier.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <optional>
+#include <span>
+
+#include "models/manifest.hpp"
+#include "services/checksums.hpp"
+#include "services/chunk_codec.hpp"
+#include "services/file_io.hpp"
+#include "services/workers.hpp"
+
+namespace humpty::services {
+namespace {
+
+constexpr std::size_t kBufferSize = 1024 * 1024;
+
+// Reads one chunk file through, passing its data on to `source_hasher` when
+// set. Returns false with `reason` describing what is wrong with the chunk.
+bool check_chunk(const humpty::models::Chunk& chunk,
+                 const std::filesystem::path& chunk_dir,
+                 humpty::models::ChecksumAlgorithm algorithm,
+                 std::vector<std::byte>& buffer,
+                 Hasher* source_hasher,
+                 std::uint64_t& bytes_read,
+                 std::string& reason) {
+    const auto chunk_path = chunk_dir / chunk.file_name;
+    FileHandle chunk_in;
+    if (!chunk_in.open_read(chunk_path)) {
+        std::error_code ec;
+        reason = std::filesystem::exists(chunk_path, ec) ? "cannot be opened" : "missing";
+        return false;
+    }
+    std::uint64_t file_size = 0;
+    if (!chunk_in.size(file_size)) {
+        reason = "cannot be read";
+        return false;
+    }
+    if (file_size != chunk.file_size()) {
+        reason = "size is " + std::to_string(file_size) + " bytes, expected " + std::to_string(chunk.file_size());
+        return false;
+    }
+    chunk_in.advise_sequential();
+
+    Hasher chunk_hasher(algorithm);
+    const auto consume = [&](std::span<const std::byte> data) {
+        chunk_hasher.update(data);
+        if (source_hasher != nullptr) {
+            source_hasher->update(data);
+        }
+    };
+    if (chunk.codec != humpty::models::ChunkCodec::None) {
+        std::string decode_error;
+        if (!decode_chunk_file(
+                chunk_in, chunk,
+                [&](std::span<const std::byte> block, std::string&) {
+                    consume(block);
+                    return true;
+                },
+                decode_error)) {
+            reason = "encoded data is corrupt";
+            return false;
+        }
+    } else {
+        for (std::uint64_t done = 0; done < chunk.size;) {
+            const auto view = std::span<std::byte>(
+                buffer.data(), static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size - done, buffer.size())));
+            if (!chunk_in.read_exact_at(view, done)) {
+                reason = "cannot be read";
+                return false;
+            }
+            consume(view);
+            done += view.size();
+        }
+    }
+    bytes_read += file_size;
+
+    if (!chunk.checksum.empty() && chunk_hasher.hex() != chunk.checksum) {
+        reason = "checksum mismatch";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool verify_chunk_set(const VerifyRequest& request, VerifyResult& result, std::string& error) {
+    result = {};
+    error.clear();
+
+    const auto manifest = humpty::models::read_manifest(request.manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    if (!manifest->complete) {
+        error = "Manifest is incomplete; the split that wrote it did not finish.";
+        return false;
+    }
+
+    const auto& chunks = manifest->chunks;
+    std::vector<std::size_t> by_offset(chunks.size());
+    std::iota(by_offset.begin(), by_offset.end(), std::size_t{0});
+    std::sort(by_offset.begin(), by_offset.end(),
+              [&](std::size_t a, std::size_t b) { return chunks[a].offset < chunks[b].offset; });
+    std::uint64_t covered = 0;
+    for (const auto position : by_offset) {
+        if (chunks[position].offset != covered) {
+            break;
+        }
+        covered += chunks[position].size;
+    }
+    if (covered != manifest->source_size) {
+        error = "Manifest chunks do not cover the source without gaps.";
+        return false;
+    }
+
+    const bool check_source = request.verify_source && !manifest->source_checksum.empty();
+    const bool stream_hash = check_source && manifest->source_digest == humpty::models::SourceDigest::Stream;
+    Hasher source_hasher(manifest->checksum_algorithm);
+    const auto chunk_dir = humpty::models::chunk_directory(*manifest, request.manifest_path);
+
+    // Each task writes only its own slot, so faults need no lock.
+    std::vector<std::optional<std::string>> reasons(chunks.size());
+    std::atomic<std::uint64_t> bytes_read{0};
+    parallel_for_each_index(
+        chunks.size(), stream_hash ? 1 : request.thread_count,
+        [&](std::size_t task, std::string&) {
+            std::vector<std::byte> buffer(kBufferSize);
+            const std::size_t position = stream_hash ? by_offset[task] : task;
+            std::uint64_t chunk_bytes = 0;
+            std::string reason;
+            if (!check_chunk(chunks[position], chunk_dir, manifest->checksum_algorithm, buffer,
+                             stream_hash ? &source_hasher : nullptr, chunk_bytes, reason)) {
+                reasons[position] = std::move(reason);
+            }
+            bytes_read.fetch_add(chunk_bytes, std::memory_order_relaxed);
+            return true;
+        },
+        error);
+
+    result.chunks_checked = chunks.size();
+    result.bytes_read = bytes_read.load();
+    for (std::size_t position = 0; position < chunks.size(); ++position) {
+        if (reasons[position]) {
+            result.faults.push_back({chunks[position].index, chunks[position].file_name, *reasons[position]});
+        }
+    }
+    if (!result.faults.empty()) {
+        error = std::to_string(result.faults.size()) + " of " + std::to_string(chunks.size()) +
+                " chunks failed verification.";
+        return false;
+    }
+
+    if (check_source) {
+        std::string actual;
+        if (stream_hash) {
+            actual = source_hasher.hex();
+        } else {
+            // The chunk checksums were each checked against the data above.
+            ChunkDigestCombiner combiner;
+            for (const auto& chunk : chunks) {
+                combiner.add(chunk.offset, chunk.size, chunk.checksum);
+            }
+            actual = combiner.hex();
+        }
+        if (actual != manifest->source_checksum) {
+            error = "Source checksum mismatch.";
+            return false;
+        }
+        result.source_verified = true;
+    }
+    return true;
+}
+
+}  // namespace humpty::services
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace humpty::services {
+
+struct VerifyRequest {
+    std::filesystem::path manifest_path;
+    std::size_t thread_count = 1;
+    // Also check the whole-file digest. A stream digest can only be rebuilt
+    // in source order, so the chunks are then read on one thread.
+    bool verify_source = false;
+};
+
+struct ChunkFault {
+    std::uint32_t index = 0;
+    std::string file_name;
+    std::string reason;
+};
+
+struct VerifyResult {
+    std::size_t chunks_checked = 0;
+    // Bytes read from chunk files.
+    std::uint64_t bytes_read = 0;
+    bool source_verified = false;
+    // Every chunk that failed, in manifest order.
+    std::vector<ChunkFault> faults;
+};
+
+// Checks a chunk set against its manifest without joining it: each chunk
+// file must exist, have the recorded length and match its checksum. Every
+// chunk is checked even after one fails; the call fails if any did, or if
+// the requested whole-file digest does not match.
+bool verify_chunk_set(const VerifyRequest& request, VerifyResult& result, std::string& error);
+
+}  // namespace humpty::services
@@ -0,0 +1,55 @@
+#include "services/workers.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace humpty::services {
+
+bool parallel_for_each_index(std::size_t count,
+                             std::size_t thread_count,
+                             const std::function<bool(std::size_t index, std::string& error)>& task,
+                             std::string& error) {
+    std::atomic<std::size_t> next_index{0};
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::string first_error;
+
+    auto worker = [&]() {
+        std::string task_error;
+        while (!failed.load(std::memory_order_relaxed)) {
+            const std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count) {
+                return;
+            }
+            if (!task(index, task_error)) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!failed.exchange(true)) {
+                    first_error = task_error;
+                }
+                return;
+            }
+        }
+    };
+
+    const std::size_t workers = std::clamp<std::size_t>(thread_count, 1, std::max<std::size_t>(count, 1));
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (std::size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (failed.load()) {
+        error = first_error;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace humpty::services
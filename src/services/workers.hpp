@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace humpty::services {
+
+// Runs task(index, error) for every index in [0, count) on up to thread_count
+// threads. Indices are handed out in ascending order; the first failure stops
+// the remaining work and its error is reported.
+bool parallel_for_each_index(std::size_t count,
+                             std::size_t thread_count,
+                             const std::function<bool(std::size_t index, std::string& error)>& task,
+                             std::string& error);
+
+}  // namespace humpty::services
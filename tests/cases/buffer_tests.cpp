@@ -0,0 +1,252 @@
+#include "test_decls.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/buffer_transfer.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 3 * 1024 * 1024 + 1234;
+constexpr std::uint64_t kChunkSize = 256 * 1024;
+
+// Keeps chunks in memory, as an embedding service would, and notes whether
+// each view pointed into the source rather than at a copy of it.
+class MemoryChunks : public services::ChunkSink, public services::ChunkSource {
+public:
+    explicit MemoryChunks(std::span<const std::byte> source) : source_(source) {}
+
+    bool put(const models::Chunk& chunk, std::span<const std::byte> data, std::string&) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (data.data() != source_.data() + chunk.offset) {
+            copied_views_ = true;
+        }
+        chunks_[chunk.index].assign(data.begin(), data.end());
+        return true;
+    }
+
+    bool read(const models::Chunk& chunk, std::span<std::byte> out, std::string& error) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto found = chunks_.find(chunk.index);
+        if (found == chunks_.end() || found->second.size() != out.size()) {
+            error = "No chunk " + std::to_string(chunk.index);
+            return false;
+        }
+        std::memcpy(out.data(), found->second.data(), out.size());
+        return true;
+    }
+
+    std::vector<std::byte>& chunk(std::uint32_t index) { return chunks_[index]; }
+    [[nodiscard]] bool copied_views() const { return copied_views_; }
+
+private:
+    std::span<const std::byte> source_;
+    std::mutex mutex_;
+    std::map<std::uint32_t, std::vector<std::byte>> chunks_;
+    bool copied_views_ = false;
+};
+
+bool same_chunks(const models::Manifest& actual, const models::Manifest& expected, std::string& error) {
+    if (!check(actual.chunks.size() == expected.chunks.size() && actual.source_size == expected.source_size &&
+                   actual.source_checksum == expected.source_checksum,
+               "A buffer split should match split_file", error)) {
+        return false;
+    }
+    for (std::size_t i = 0; i < actual.chunks.size(); ++i) {
+        const auto& a = actual.chunks[i];
+        const auto& b = expected.chunks[i];
+        if (!check(a.index == b.index && a.offset == b.offset && a.size == b.size && a.file_name == b.file_name &&
+                       a.checksum == b.checksum,
+                   "Buffer split chunk differs from split_file: " + b.file_name, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool split_to_disk(const std::filesystem::path& input_path,
+                   const std::filesystem::path& output_dir,
+                   services::SplitRequest request,
+                   models::Manifest& manifest,
+                   std::string& error) {
+    request.input_file = input_path;
+    request.output_dir = output_dir;
+    services::SplitResult result;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    auto loaded = models::read_manifest(result.manifest_path, error);
+    if (!loaded) {
+        return false;
+    }
+    manifest = std::move(*loaded);
+    return true;
+}
+
+}  // namespace
+
+bool run_buffer_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("buffer");
+    const auto input = make_test_data(kInputSize);
+    const auto input_path = temp_dir / "input.bin";
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    services::SplitRequest file_request;
+    file_request.chunk_size_bytes = kChunkSize;
+    models::Manifest on_disk;
+    if (!split_to_disk(input_path, temp_dir / "fixed", file_request, on_disk, error)) {
+        return false;
+    }
+
+    for (const std::size_t threads : {1, 4}) {
+        services::BufferSplitRequest split;
+        split.source_name = "input.bin";
+        split.chunk_size_bytes = kChunkSize;
+        split.thread_count = threads;
+        MemoryChunks chunks(input);
+        models::Manifest manifest;
+        if (!services::split_buffer(split, input, chunks, manifest, error) ||
+            !same_chunks(manifest, on_disk, error) ||
+            !check(!chunks.copied_views(), "A buffer split should hand out views of the source", error)) {
+            return false;
+        }
+
+        services::BufferJoinRequest join;
+        join.thread_count = threads;
+        std::vector<std::byte> output(input.size());
+        if (!services::join_buffer(join, manifest, chunks, output, error) ||
+            !check(output == input, "A buffer join should rebuild the source", error)) {
+            return false;
+        }
+
+        // Each chunk is checked against the manifest.
+        chunks.chunk(3)[17] ^= std::byte{0x40};
+        std::string join_error;
+        if (!check(!services::join_buffer(join, manifest, chunks, output, join_error) &&
+                       join_error.find("checksum mismatch") != std::string::npos,
+                   "A buffer join should reject a corrupt chunk", error)) {
+            return false;
+        }
+        join.verify_checksums = false;
+        if (!check(services::join_buffer(join, manifest, chunks, output, join_error) && output != input,
+                   "A buffer join without verification should copy the chunks as they are", error)) {
+            return false;
+        }
+    }
+
+    services::BufferSplitRequest empty;
+    empty.source_name = "empty.bin";
+    empty.chunk_size_bytes = kChunkSize;
+    MemoryChunks no_chunks({});
+    models::Manifest empty_manifest;
+    std::string empty_error;
+    if (!check(!services::split_buffer(empty, {}, no_chunks, empty_manifest, empty_error) &&
+                   empty_manifest.chunks.empty(),
+               "A buffer split of an empty source should be rejected", error)) {
+        return false;
+    }
+
+    // Content-defined cuts and a combined digest match split_file too.
+    file_request.content_defined = true;
+    file_request.source_digest = models::SourceDigest::Combined;
+    if (!split_to_disk(input_path, temp_dir / "cdc", file_request, on_disk, error)) {
+        return false;
+    }
+    services::BufferSplitRequest cdc;
+    cdc.source_name = "input.bin";
+    cdc.chunk_size_bytes = kChunkSize;
+    cdc.content_defined = true;
+    cdc.source_digest = models::SourceDigest::Combined;
+    cdc.thread_count = 3;
+    MemoryChunks cdc_chunks(input);
+    models::Manifest cdc_manifest;
+    if (!services::split_buffer(cdc, input, cdc_chunks, cdc_manifest, error) ||
+        !same_chunks(cdc_manifest, on_disk, error)) {
+        return false;
+    }
+    std::vector<std::byte> output(input.size());
+    if (!services::join_buffer({}, cdc_manifest, cdc_chunks, output, error) ||
+        !check(output == input, "A buffer join should check a combined digest", error)) {
+        return false;
+    }
+
+    // The directory implementations read and write split_file's layout:
+    // a buffer split written out joins with join_file, and compressed chunks
+    // from split_file join into a buffer.
+    const auto written_dir = temp_dir / "written";
+    std::filesystem::create_directories(written_dir);
+    services::BufferSplitRequest split;
+    split.source_name = "input.bin";
+    split.chunk_size_bytes = kChunkSize;
+    split.thread_count = 2;
+    services::DirectoryChunkSink sink(written_dir);
+    models::Manifest written;
+    if (!services::split_buffer(split, input, sink, written, error) ||
+        !models::write_manifest(written, written_dir / "input.bin.manifest", error)) {
+        return false;
+    }
+    services::JoinRequest join_request;
+    join_request.manifest_path = written_dir / "input.bin.manifest";
+    join_request.output_file = temp_dir / "joined.bin";
+    services::JoinResult join_result;
+    std::vector<std::byte> joined;
+    if (!services::join_file(join_request, join_result, error) ||
+        !read_bytes(join_request.output_file, joined, error) ||
+        !check(joined == input, "Chunks from a DirectoryChunkSink should join with join_file", error)) {
+        return false;
+    }
+
+    file_request = {};
+    file_request.chunk_size_bytes = kChunkSize;
+    file_request.codec = models::ChunkCodec::Lz4;
+    models::Manifest compressed;
+    if (!split_to_disk(input_path, temp_dir / "lz4", file_request, compressed, error)) {
+        return false;
+    }
+    services::DirectoryChunkSource source(temp_dir / "lz4");
+    std::fill(output.begin(), output.end(), std::byte{0});
+    services::BufferJoinRequest join;
+    join.thread_count = 4;
+    if (!services::join_buffer(join, compressed, source, output, error) ||
+        !check(output == input, "A DirectoryChunkSource should decode compressed chunks", error)) {
+        return false;
+    }
+
+    // A split without checksums joins with verification left on.
+    file_request.codec = models::ChunkCodec::None;
+    file_request.compute_checksums = false;
+    models::Manifest unhashed;
+    if (!split_to_disk(input_path, temp_dir / "unhashed", file_request, unhashed, error)) {
+        return false;
+    }
+    services::DirectoryChunkSource unhashed_source(temp_dir / "unhashed");
+    std::fill(output.begin(), output.end(), std::byte{0});
+    if (!services::join_buffer(join, unhashed, unhashed_source, output, error) ||
+        !check(output == input, "A buffer join should skip chunks without checksums", error)) {
+        return false;
+    }
+
+    std::filesystem::remove(temp_dir / "lz4" / compressed.chunks[2].file_name);
+    std::string join_error;
+    if (!check(!services::join_buffer(join, compressed, source, output, join_error),
+               "A buffer join should fail when a chunk file is missing", error)) {
+        return false;
+    }
+    output.resize(output.size() - 1);
+    return check(!services::join_buffer(join, compressed, source, output, join_error),
+                 "A buffer join should reject an output of the wrong size", error);
+}
+
+}  // namespace humpty::tests
@@ -0,0 +1,148 @@
+#include "test_decls.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/content_chunking.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 1024 * 1024;
+constexpr std::uint64_t kAverageSize = 4096;
+
+// make_test_data() repeats every 256 bytes, which would give content-defined
+// cuts nothing to find; this takes the high bits of the generator instead.
+std::vector<std::byte> make_varied_data(std::size_t size) {
+    std::vector<std::byte> data(size);
+    std::uint32_t state = 0x9E3779B9U;
+    for (auto& byte : data) {
+        state = (state * 1664525U) + 1013904223U;
+        byte = static_cast<std::byte>(state >> 24);
+    }
+    return data;
+}
+
+bool split_cdc(const std::filesystem::path& input_file,
+               const std::filesystem::path& output_dir,
+               std::size_t thread_count,
+               models::Manifest& manifest,
+               std::string& error) {
+    services::SplitRequest request;
+    request.input_file = input_file;
+    request.output_dir = output_dir;
+    request.chunk_size_bytes = kAverageSize;
+    request.content_defined = true;
+    request.thread_count = thread_count;
+    services::SplitResult result;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    auto read = models::read_manifest(result.manifest_path, error);
+    if (!read) {
+        return false;
+    }
+    manifest = std::move(*read);
+    return true;
+}
+
+bool check_chunk_bounds(const models::Manifest& manifest, std::string& error) {
+    const auto params = services::make_cdc_params(kAverageSize, 0, 0);
+    std::uint64_t offset = 0;
+    for (std::size_t i = 0; i < manifest.chunks.size(); ++i) {
+        const auto& chunk = manifest.chunks[i];
+        const bool last = i + 1 == manifest.chunks.size();
+        if (!check(chunk.offset == offset && chunk.size <= params.maximum && (last || chunk.size >= params.minimum),
+                   "Content-defined chunk out of bounds: " + std::to_string(i), error)) {
+            return false;
+        }
+        offset += chunk.size;
+    }
+    return check(offset == manifest.source_size, "Content-defined chunks do not cover the input", error);
+}
+
+}  // namespace
+
+bool run_cdc_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("cdc");
+    auto input = make_varied_data(kInputSize);
+    const auto input_path = temp_dir / "input.bin";
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    models::Manifest serial;
+    models::Manifest parallel;
+    if (!split_cdc(input_path, temp_dir / "serial", 1, serial, error) ||
+        !split_cdc(input_path, temp_dir / "parallel", 4, parallel, error) || !check_chunk_bounds(serial, error)) {
+        return false;
+    }
+    if (!check(serial.chunks.size() > kInputSize / (2 * kAverageSize) &&
+                   serial.chunks.size() < kInputSize / (kAverageSize / 2),
+               "Content-defined chunks are far from the average size", error)) {
+        return false;
+    }
+
+    // Segments scanned concurrently must stitch into exactly the serial cuts.
+    bool same_cuts = serial.chunks.size() == parallel.chunks.size();
+    for (std::size_t i = 0; same_cuts && i < serial.chunks.size(); ++i) {
+        same_cuts = serial.chunks[i].offset == parallel.chunks[i].offset &&
+                    serial.chunks[i].checksum == parallel.chunks[i].checksum;
+    }
+    if (!check(same_cuts, "Parallel boundary scan differs from the serial one", error)) {
+        return false;
+    }
+
+    services::JoinRequest join_request;
+    join_request.manifest_path = temp_dir / "parallel" / "input.bin.manifest";
+    join_request.output_file = temp_dir / "joined.bin";
+    services::JoinResult join_result;
+    if (!services::join_file(join_request, join_result, error)) {
+        return false;
+    }
+    std::vector<std::byte> output;
+    if (!read_bytes(join_request.output_file, output, error) ||
+        !check(output == input, "Join of a content-defined split does not match the input", error)) {
+        return false;
+    }
+
+    // A few bytes inserted near the start only disturb the chunks around them.
+    input.insert(input.begin() + 10000, 7, std::byte{0x42});
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+    models::Manifest shifted;
+    if (!split_cdc(input_path, temp_dir / "shifted", 1, shifted, error) || !check_chunk_bounds(shifted, error)) {
+        return false;
+    }
+    std::set<std::string> before;
+    for (const auto& chunk : serial.chunks) {
+        before.insert(chunk.checksum);
+    }
+    const auto shared = std::count_if(shifted.chunks.begin(), shifted.chunks.end(),
+                                      [&](const models::Chunk& chunk) { return before.contains(chunk.checksum); });
+    if (!check(static_cast<std::size_t>(shared) + 3 >= shifted.chunks.size(),
+               "An insertion changed chunks far away from it", error)) {
+        return false;
+    }
+
+    services::SplitRequest invalid;
+    invalid.input_file = input_path;
+    invalid.output_dir = temp_dir / "invalid";
+    invalid.chunk_size_bytes = kAverageSize;
+    invalid.content_defined = true;
+    invalid.cdc_min_bytes = 2 * kAverageSize;
+    services::SplitResult invalid_result;
+    std::string invalid_error;
+    return check(!services::split_file(invalid, invalid_result, invalid_error),
+                 "A minimum above the average should be rejected", error);
+}
+
+}  // namespace humpty::tests
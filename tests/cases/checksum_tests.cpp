@@ -0,0 +1,174 @@
+#include "test_decls.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/checksums.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+std::span<const std::byte> as_bytes(std::string_view text) {
+    return std::as_bytes(std::span(text.data(), text.size()));
+}
+
+bool check_known_vectors(std::string& error) {
+    if (!check(services::crc32c(as_bytes("123456789")) == 0xE3069283U, "crc32c check value mismatch", error)) {
+        return false;
+    }
+    if (!check(services::crc32c_portable(as_bytes("123456789")) == 0xE3069283U,
+               "portable crc32c check value mismatch", error)) {
+        return false;
+    }
+    if (!check(services::xxh64(as_bytes("")) == 0xEF46DB3751D8E999ULL, "xxh64 empty input mismatch", error)) {
+        return false;
+    }
+    if (!check(services::xxh64(as_bytes("abc")) == 0x44BC2CF5AD770999ULL, "xxh64 'abc' mismatch", error)) {
+        return false;
+    }
+    return check(services::xxh64(as_bytes("Nobody inspects the spammish repetition")) == 0xFBCEA83C8A378BF1ULL,
+                 "xxh64 long input mismatch", error);
+}
+
+bool check_kernels_agree(std::string& error) {
+    const auto data = make_test_data(40000);
+    const auto all = std::span<const std::byte>(data);
+
+    for (const std::size_t offset : {0, 1, 3, 7}) {
+        for (const std::size_t length : {0, 5, 6143, 6144, 6145, 30001}) {
+            const auto view = all.subspan(offset, length);
+            const std::uint32_t expected = services::crc32c_portable(view);
+            if (!check(services::crc32c(view) == expected,
+                       "crc32c kernel " + std::string(services::crc32c_kernel_name()) +
+                           " disagrees with portable at length " + std::to_string(length),
+                       error)) {
+                return false;
+            }
+
+            const auto head = view.subspan(0, length / 3);
+            const auto rest = view.subspan(length / 3);
+            if (!check(services::crc32c(rest, services::crc32c(head)) == expected, "chained crc32c mismatch",
+                       error)) {
+                return false;
+            }
+
+            for (const auto algorithm : {models::ChecksumAlgorithm::Fnv1a64, models::ChecksumAlgorithm::Crc32c,
+                                         models::ChecksumAlgorithm::Xxh64}) {
+                services::Hasher whole(algorithm);
+                whole.update(view);
+
+                services::Hasher pieces(algorithm);
+                std::size_t done = 0;
+                std::size_t step = 1;
+                while (done < view.size()) {
+                    const std::size_t take = std::min(step, view.size() - done);
+                    pieces.update(view.subspan(done, take));
+                    done += take;
+                    step = (step * 3) + 1;
+                }
+
+                if (!check(whole.hex() == pieces.hex(),
+                           "Incremental " + std::string(models::checksum_algorithm_name(algorithm)) +
+                               " differs from one-shot",
+                           error)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool check_roundtrip(models::ChecksumAlgorithm algorithm, std::string& error) {
+    const std::string name(models::checksum_algorithm_name(algorithm));
+    const auto temp_dir = make_temp_dir("checksums-" + name);
+    const auto input_path = temp_dir / "input.bin";
+    const auto joined_path = temp_dir / "joined.bin";
+
+    const auto input = make_test_data(150000);
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    services::SplitRequest split_request;
+    split_request.input_file = input_path;
+    split_request.output_dir = temp_dir / "chunks";
+    split_request.chunk_size_bytes = 40000;
+    split_request.checksum_algorithm = algorithm;
+
+    services::SplitResult split_result;
+    if (!services::split_file(split_request, split_result, error)) {
+        return false;
+    }
+
+    std::string manifest_error;
+    const auto manifest = models::read_manifest(split_result.manifest_path, manifest_error);
+    if (!manifest.has_value()) {
+        error = "Failed reading manifest: " + manifest_error;
+        return false;
+    }
+    if (!check(manifest->checksum_algorithm == algorithm, "Manifest did not record checksum algorithm " + name,
+               error)) {
+        return false;
+    }
+
+    std::string file_hex;
+    const auto first_chunk = split_request.output_dir / manifest->chunks.front().file_name;
+    if (!services::hash_file_hex(first_chunk, algorithm, file_hex, error)) {
+        return false;
+    }
+    if (!check(file_hex == manifest->chunks.front().checksum, "hash_file_hex disagrees with split " + name,
+               error)) {
+        return false;
+    }
+    if (!services::hash_file_hex(first_chunk, algorithm, file_hex, error, services::IoEngine::Mmap)) {
+        return false;
+    }
+    if (!check(file_hex == manifest->chunks.front().checksum, "Mapped hash_file_hex disagrees with split " + name,
+               error)) {
+        return false;
+    }
+
+    services::JoinRequest join_request;
+    join_request.manifest_path = split_result.manifest_path;
+    join_request.output_file = joined_path;
+
+    services::JoinResult join_result;
+    if (!services::join_file(join_request, join_result, error)) {
+        return false;
+    }
+
+    std::vector<std::byte> output;
+    if (!read_bytes(joined_path, output, error)) {
+        return false;
+    }
+    return check(output == input, "Joined output mismatch with checksum " + name, error);
+}
+
+}  // namespace
+
+bool run_checksum_tests(std::string& error) {
+    if (!check_known_vectors(error) || !check_kernels_agree(error)) {
+        return false;
+    }
+
+    for (const auto algorithm : {models::ChecksumAlgorithm::Fnv1a64, models::ChecksumAlgorithm::Crc32c,
+                                 models::ChecksumAlgorithm::Xxh64}) {
+        if (!check_roundtrip(algorithm, error)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace humpty::tests
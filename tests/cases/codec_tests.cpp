@@ -0,0 +1,177 @@
+#include "test_decls.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/chunk_codec.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::uint64_t kChunkSize = 2 * 1024 * 1024 + 4096;
+
+// Log-like lines compress well but, unlike make_test_data(), are not one
+// short period repeated.
+std::vector<std::byte> make_log_data(std::size_t size) {
+    std::vector<std::byte> data;
+    data.reserve(size);
+    std::uint32_t state = 0x2545F491U;
+    while (data.size() < size) {
+        state = (state * 1664525U) + 1013904223U;
+        const std::string line = "2026-10-18T12:00:" + std::to_string(state % 60) + " worker=" +
+                                 std::to_string((state >> 8) % 16) + " request served in " +
+                                 std::to_string((state >> 16) % 1000) + "ms\n";
+        for (const char c : line) {
+            if (data.size() < size) {
+                data.push_back(static_cast<std::byte>(c));
+            }
+        }
+    }
+    return data;
+}
+
+std::vector<std::byte> make_noise_data(std::size_t size) {
+    std::vector<std::byte> data(size);
+    std::uint32_t state = 0x9E3779B9U;
+    for (auto& byte : data) {
+        state = (state * 1664525U) + 1013904223U;
+        byte = static_cast<std::byte>(state >> 24);
+    }
+    return data;
+}
+
+bool split_lz4(const std::filesystem::path& input_file,
+               const std::filesystem::path& output_dir,
+               models::ManifestFormat format,
+               services::SplitResult& result,
+               std::string& error) {
+    services::SplitRequest request;
+    request.input_file = input_file;
+    request.output_dir = output_dir;
+    request.chunk_size_bytes = kChunkSize;
+    request.codec = models::ChunkCodec::Lz4;
+    request.manifest_format = format;
+    request.thread_count = 3;
+    return services::split_file(request, result, error);
+}
+
+bool join_matches(const std::filesystem::path& manifest_path,
+                  const std::filesystem::path& output_file,
+                  const std::vector<std::byte>& expected,
+                  std::string& error) {
+    services::JoinRequest request;
+    request.manifest_path = manifest_path;
+    request.output_file = output_file;
+    request.thread_count = 2;
+    services::JoinResult result;
+    if (!services::join_file(request, result, error)) {
+        return false;
+    }
+    std::vector<std::byte> output;
+    if (!read_bytes(output_file, output, error)) {
+        return false;
+    }
+    return check(output == expected, "Join of compressed chunks does not match the input", error);
+}
+
+bool check_stored_sizes(const models::Manifest& manifest,
+                        const std::filesystem::path& chunk_dir,
+                        std::string& error) {
+    for (const auto& chunk : manifest.chunks) {
+        if (!check(chunk.codec == models::ChunkCodec::Lz4 &&
+                       std::filesystem::file_size(chunk_dir / chunk.file_name) == chunk.stored_size,
+                   "Manifest stored size does not match chunk file: " + chunk.file_name, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+bool run_codec_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("codec");
+
+    const auto logs = make_log_data(5 * 1024 * 1024 + 777);
+    if (!write_bytes(temp_dir / "logs.txt", logs, error)) {
+        return false;
+    }
+    services::SplitResult result;
+    if (!split_lz4(temp_dir / "logs.txt", temp_dir / "logs", models::ManifestFormat::Text, result, error)) {
+        return false;
+    }
+    if (!check(result.stored_bytes < result.total_bytes / 2, "Compressible chunks should shrink", error)) {
+        return false;
+    }
+    auto manifest = models::read_manifest(result.manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    if (!check(manifest->codec == models::ChunkCodec::Lz4 && manifest->chunks.size() == 3,
+               "Text manifest should record the codec", error) ||
+        !check_stored_sizes(*manifest, temp_dir / "logs", error) ||
+        !join_matches(result.manifest_path, temp_dir / "logs.out", logs, error)) {
+        return false;
+    }
+
+    // Blocks that do not compress are stored as they are, behind a frame
+    // header each.
+    const auto noise = make_noise_data(3 * 1024 * 1024);
+    if (!write_bytes(temp_dir / "noise.bin", noise, error)) {
+        return false;
+    }
+    if (!split_lz4(temp_dir / "noise.bin", temp_dir / "noise", models::ManifestFormat::Binary, result, error)) {
+        return false;
+    }
+    manifest = models::read_manifest(result.manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    const std::uint64_t frames = (kChunkSize + services::kCodecBlockSize - 1) / services::kCodecBlockSize +
+                                 ((noise.size() - kChunkSize) + services::kCodecBlockSize - 1) /
+                                     services::kCodecBlockSize;
+    if (!check(result.stored_bytes == noise.size() + frames * services::kCodecFrameHeaderSize,
+               "Incompressible blocks should be stored raw", error) ||
+        !check(manifest->codec == models::ChunkCodec::Lz4, "Binary manifest should record the codec", error) ||
+        !check_stored_sizes(*manifest, temp_dir / "noise", error) ||
+        !join_matches(result.manifest_path, temp_dir / "noise.out", noise, error)) {
+        return false;
+    }
+
+    // A damaged frame must fail the join rather than produce bad output.
+    std::vector<std::byte> chunk_file;
+    const auto logs_chunk = temp_dir / "logs" / models::make_chunk_filename("logs.txt", 1);
+    if (!read_bytes(logs_chunk, chunk_file, error)) {
+        return false;
+    }
+    chunk_file[chunk_file.size() / 2] ^= std::byte{0x40};
+    if (!write_bytes(logs_chunk, chunk_file, error)) {
+        return false;
+    }
+    services::JoinRequest join_request;
+    join_request.manifest_path = temp_dir / "logs" / "logs.txt.manifest";
+    join_request.output_file = temp_dir / "damaged.out";
+    services::JoinResult join_result;
+    std::string join_error;
+    if (!check(!services::join_file(join_request, join_result, join_error),
+               "Join should reject a damaged compressed chunk", error)) {
+        return false;
+    }
+
+    services::SplitRequest invalid;
+    invalid.input_file = temp_dir / "logs.txt";
+    invalid.output_dir = temp_dir / "logs";
+    invalid.chunk_size_bytes = kChunkSize;
+    invalid.codec = models::ChunkCodec::Lz4;
+    invalid.incremental = true;
+    std::string invalid_error;
+    return check(!services::split_file(invalid, result, invalid_error),
+                 "Compressed chunks with --incremental should be rejected", error);
+}
+
+}  // namespace humpty::tests
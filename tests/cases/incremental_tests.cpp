@@ -0,0 +1,128 @@
+#include "test_decls.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 90000;
+constexpr std::uint64_t kChunkSize = 16384;
+
+bool join_matches(const std::filesystem::path& manifest_path,
+                  const std::filesystem::path& output_file,
+                  const std::vector<std::byte>& expected,
+                  std::string& error) {
+    services::JoinRequest request;
+    request.manifest_path = manifest_path;
+    request.output_file = output_file;
+    services::JoinResult result;
+    if (!services::join_file(request, result, error)) {
+        return false;
+    }
+    std::vector<std::byte> output;
+    if (!read_bytes(output_file, output, error)) {
+        return false;
+    }
+    return check(output == expected, "Join after an incremental split does not match the input", error);
+}
+
+}  // namespace
+
+bool run_incremental_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("incremental");
+    auto input = make_test_data(kInputSize);
+    const auto input_path = temp_dir / "input.bin";
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    services::SplitRequest request;
+    request.input_file = input_path;
+    request.output_dir = temp_dir / "chunks";
+    request.chunk_size_bytes = kChunkSize;
+    services::SplitResult result;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+
+    const auto chunk_path = [&](std::uint32_t index) {
+        return request.output_dir / models::make_chunk_filename("input.bin", index);
+    };
+    const auto old_time = std::filesystem::last_write_time(chunk_path(0)) - std::chrono::hours(1);
+    for (std::uint32_t index = 0; index < result.chunk_count; ++index) {
+        std::filesystem::last_write_time(chunk_path(index), old_time);
+    }
+
+    // One byte of chunk 2 changes; everything else must be left alone.
+    input[2 * kChunkSize + 7] ^= std::byte{0x5A};
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+    request.incremental = true;
+    request.thread_count = 3;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    if (!check(result.chunks_changed == 1 && result.chunk_count == 6,
+               "Incremental split should rewrite exactly the modified chunk", error)) {
+        return false;
+    }
+    if (!check(std::filesystem::last_write_time(chunk_path(0)) == old_time &&
+                   std::filesystem::last_write_time(chunk_path(5)) == old_time &&
+                   std::filesystem::last_write_time(chunk_path(2)) != old_time,
+               "Incremental split touched the wrong chunk files", error)) {
+        return false;
+    }
+
+    auto manifest = models::read_manifest(result.manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    for (const auto& chunk : manifest->chunks) {
+        if (!check(chunk.changed == (chunk.index == 2), "Manifest does not mark the changed chunk", error)) {
+            return false;
+        }
+    }
+    if (!join_matches(result.manifest_path, temp_dir / "joined.bin", input, error)) {
+        return false;
+    }
+
+    // A shorter input changes the size of its new last chunk and leaves
+    // chunk files behind that the new manifest no longer lists.
+    input.resize(2 * kChunkSize + 100);
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+    request.manifest_format = models::ManifestFormat::Binary;
+    request.thread_count = 1;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    if (!check(result.chunks_changed == 1 && result.chunk_count == 3,
+               "Incremental split of a shorter input should rewrite only the new last chunk", error)) {
+        return false;
+    }
+    if (!check(!std::filesystem::exists(chunk_path(3)) && !std::filesystem::exists(chunk_path(5)),
+               "Incremental split should remove chunk files past the new end", error)) {
+        return false;
+    }
+    manifest = models::read_manifest(result.manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    if (!check(!manifest->chunks[0].changed && manifest->chunks[2].changed,
+               "Binary manifest does not mark the changed chunk", error)) {
+        return false;
+    }
+    return join_matches(result.manifest_path, temp_dir / "joined-short.bin", input, error);
+}
+
+}  // namespace humpty::tests
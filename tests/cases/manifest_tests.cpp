@@ -0,0 +1,343 @@
+#include "test_decls.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "models/binary_manifest.hpp"
+#include "models/manifest.hpp"
+#include "models/manifest_reader.hpp"
+#include "models/manifest_writer.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+models::Manifest make_sample_manifest() {
+    models::Manifest manifest;
+    manifest.format_version = "2";
+    manifest.source_file_name = "sample.bin";
+    manifest.source_size = 250;
+    manifest.chunk_size = 100;
+    manifest.source_checksum = "0123456789abcdef";
+    manifest.source_digest = models::SourceDigest::Combined;
+    manifest.checksum_algorithm = models::ChecksumAlgorithm::Crc32c;
+
+    for (std::uint32_t i = 0; i < 3; ++i) {
+        models::Chunk chunk;
+        chunk.index = i;
+        chunk.offset = static_cast<std::uint64_t>(i) * 100;
+        chunk.size = (i == 2) ? 50 : 100;
+        chunk.file_name = models::make_chunk_filename(manifest.source_file_name, i);
+        chunk.checksum = "00c0ffee";
+        manifest.chunks.push_back(chunk);
+    }
+    // Entries the record layout cannot hold inline go through the string table.
+    manifest.chunks[1].file_name = "renamed chunk.bin";
+    manifest.chunks[2].checksum = "not-a-digest";
+    return manifest;
+}
+
+bool same_chunks(const models::Manifest& expected, const models::Manifest& actual) {
+    if (expected.chunks.size() != actual.chunks.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < expected.chunks.size(); ++i) {
+        const auto& a = expected.chunks[i];
+        const auto& b = actual.chunks[i];
+        if (a.index != b.index || a.offset != b.offset || a.size != b.size || a.file_name != b.file_name ||
+            a.checksum != b.checksum) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool run_text_manifest_tests(const std::filesystem::path& temp_dir, std::string& error) {
+    auto manifest = make_sample_manifest();
+    manifest.format_version = "1";
+    manifest.source_file_name = "odd \"name\" \\ here.bin";
+    manifest.chunks[0].file_name = models::make_chunk_filename(manifest.source_file_name, 0);
+
+    const auto text_path = temp_dir / "text.manifest";
+    if (!models::write_manifest(manifest, text_path, error)) {
+        return false;
+    }
+    const auto loaded = models::read_manifest(text_path, error);
+    if (!loaded.has_value()) {
+        return false;
+    }
+    if (!check(loaded->source_file_name == manifest.source_file_name && same_chunks(manifest, *loaded),
+               "Text manifest with quoted names did not roundtrip", error)) {
+        return false;
+    }
+
+    // Sparse indices go through the sort-based uniqueness check.
+    manifest.chunks[2].index = 4000000000U;
+    if (!check(manifest.is_valid(), "Sparse unique chunk indices should be valid", error)) {
+        return false;
+    }
+    manifest.chunks[2].index = 0;
+    if (!check(!manifest.is_valid(), "Duplicate chunk indices should be invalid", error)) {
+        return false;
+    }
+    return true;
+}
+
+bool read_all_chunks(models::ManifestReader& reader, std::vector<models::Chunk>& chunks, std::string& error) {
+    for (;;) {
+        models::Chunk chunk;
+        bool done = false;
+        if (!reader.next(chunk, done, error)) {
+            return false;
+        }
+        if (done) {
+            return true;
+        }
+        chunks.push_back(std::move(chunk));
+    }
+}
+
+// The reader must know the totals before the first record, whether they sit
+// in the trailer or, in older manifests, ahead of the records.
+bool run_manifest_reader_tests(const std::filesystem::path& temp_dir, std::string& error) {
+    auto manifest = make_sample_manifest();
+    manifest.format_version = "1";
+    const auto trailer_path = temp_dir / "reader.manifest";
+    if (!models::write_manifest(manifest, trailer_path, error)) {
+        return false;
+    }
+
+    const auto legacy_path = temp_dir / "legacy.manifest";
+    {
+        std::ofstream out(legacy_path, std::ios::binary);
+        out << "version 1\nsource_file \"sample.bin\"\nsource_size 250\nchunk_size 100\n"
+               "source_checksum \"0123456789abcdef\"\nsource_digest combined\nchecksum_algorithm crc32c\n"
+               "chunks 3\n";
+        for (const auto& chunk : manifest.chunks) {
+            out << "chunk " << chunk.index << ' ' << chunk.offset << ' ' << chunk.size << " \"" << chunk.file_name
+                << "\" \"" << chunk.checksum << "\"\n";
+        }
+    }
+
+    for (const auto& path : {trailer_path, legacy_path}) {
+        models::ManifestReader reader;
+        if (!reader.open(path, error)) {
+            return false;
+        }
+        const auto& header = reader.header();
+        if (!check(header.complete && header.source_size == 250 && header.source_checksum == manifest.source_checksum &&
+                       reader.chunk_count() == 3,
+                   "Manifest reader should know the totals before the first record: " + path.filename().string(),
+                   error)) {
+            return false;
+        }
+
+        models::Manifest streamed = header;
+        if (!read_all_chunks(reader, streamed.chunks, error)) {
+            return false;
+        }
+        if (!check(same_chunks(manifest, streamed), "Manifest reader returned the wrong records", error)) {
+            return false;
+        }
+    }
+
+    // Manifests written in one go could leave out the `chunks` line, down to
+    // the newline after the last record.
+    const auto uncounted_path = temp_dir / "uncounted.manifest";
+    {
+        std::ofstream out(uncounted_path, std::ios::binary);
+        out << "version 1\nsource_file \"sample.bin\"\nsource_size 250\nchunk_size 100\n"
+               "source_checksum \"0123456789abcdef\"\nsource_digest combined\nchecksum_algorithm crc32c\n";
+        for (const auto& chunk : manifest.chunks) {
+            out << (chunk.index == 0 ? "" : "\n") << "chunk " << chunk.index << ' ' << chunk.offset << ' '
+                << chunk.size << " \"" << chunk.file_name << "\" \"" << chunk.checksum << '"';
+        }
+    }
+    const auto uncounted = models::read_manifest(uncounted_path, error);
+    if (!uncounted || !check(uncounted->complete && same_chunks(manifest, *uncounted),
+                             "A manifest without a chunks line should read as complete", error)) {
+        return false;
+    }
+
+    // A declared count that disagrees with the records only shows at the end.
+    {
+        std::ofstream out(legacy_path, std::ios::binary | std::ios::app);
+        out << "chunk 3 300 1 \"extra.bin\" \"\"\n";
+    }
+    models::ManifestReader reader;
+    std::vector<models::Chunk> chunks;
+    std::string count_error;
+    if (!reader.open(legacy_path, error)) {
+        return false;
+    }
+    return check(!read_all_chunks(reader, chunks, count_error) && chunks.size() == 4,
+                 "Manifest reader should report a chunk count mismatch after the last record", error);
+}
+
+// Simulates a split that stopped part way: the trailer never reached the
+// disk and the last record was torn.
+bool run_partial_manifest_tests(const std::filesystem::path& temp_dir, std::string& error) {
+    auto manifest = make_sample_manifest();
+    manifest.format_version = "1";
+    const auto text_path = temp_dir / "partial.manifest";
+    if (!models::write_manifest(manifest, text_path, error)) {
+        return false;
+    }
+
+    std::string text;
+    {
+        std::ifstream in(text_path, std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const auto trailer = text.find("source_size ");
+    if (!check(trailer != std::string::npos && text.rfind("chunks ") > trailer,
+               "Streamed text manifest should end with its totals", error)) {
+        return false;
+    }
+    text.resize(trailer - 5);
+    {
+        std::ofstream out(text_path, std::ios::binary | std::ios::trunc);
+        out << text;
+    }
+
+    const auto partial = models::read_manifest(text_path, error);
+    if (!partial.has_value()) {
+        return false;
+    }
+    manifest.chunks.pop_back();
+    if (!check(!partial->complete && same_chunks(manifest, *partial),
+               "Partial text manifest should keep only its whole records", error)) {
+        return false;
+    }
+
+    services::JoinRequest join_request;
+    join_request.manifest_path = text_path;
+    join_request.output_file = temp_dir / "partial.bin";
+    services::JoinResult join_result;
+    std::string join_error;
+    if (!check(!services::join_file(join_request, join_result, join_error),
+               "Join should refuse an incomplete manifest", error)) {
+        return false;
+    }
+
+    const auto binary_path = temp_dir / "partial-binary.manifest";
+    {
+        models::ManifestStreamWriter writer;
+        if (!writer.open(binary_path, make_sample_manifest(), error)) {
+            return false;
+        }
+    }
+    const auto binary_partial = models::read_manifest(binary_path, error);
+    if (!binary_partial.has_value()) {
+        return false;
+    }
+    return check(!binary_partial->complete && binary_partial->chunks.empty() &&
+                     binary_partial->source_file_name == "sample.bin",
+                 "Unfinished binary manifest should read back as partial", error);
+}
+
+}  // namespace
+
+bool run_manifest_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("manifest");
+    if (!run_text_manifest_tests(temp_dir, error) || !run_manifest_reader_tests(temp_dir, error) ||
+        !run_partial_manifest_tests(temp_dir, error)) {
+        return false;
+    }
+
+    const auto binary_path = temp_dir / "sample.manifest";
+    const auto manifest = make_sample_manifest();
+    if (!models::write_manifest(manifest, binary_path, error)) {
+        return false;
+    }
+    if (!check(models::is_binary_manifest(binary_path), "Version 2 manifest should be written as binary", error)) {
+        return false;
+    }
+
+    const auto loaded = models::read_manifest(binary_path, error);
+    if (!loaded.has_value()) {
+        return false;
+    }
+    if (!check(loaded->source_file_name == manifest.source_file_name && loaded->source_size == manifest.source_size &&
+                   loaded->chunk_size == manifest.chunk_size && loaded->source_checksum == manifest.source_checksum &&
+                   loaded->source_digest == manifest.source_digest &&
+                   loaded->checksum_algorithm == manifest.checksum_algorithm,
+               "Binary manifest header fields did not roundtrip", error)) {
+        return false;
+    }
+    if (!check(same_chunks(manifest, *loaded), "Binary manifest chunk entries did not roundtrip", error)) {
+        return false;
+    }
+
+    models::ManifestView view;
+    if (!view.open(binary_path, error)) {
+        return false;
+    }
+    models::Chunk chunk;
+    if (!check(view.chunk_count() == 3 && view.chunk_at(2, chunk) && chunk.offset == 200 && chunk.size == 50,
+               "ManifestView random access returned the wrong chunk", error)) {
+        return false;
+    }
+    if (!check(!view.chunk_at(3, chunk), "ManifestView should reject out-of-range positions", error)) {
+        return false;
+    }
+    view.close();
+
+    std::vector<std::byte> bytes;
+    if (!read_bytes(binary_path, bytes, error)) {
+        return false;
+    }
+    bytes.resize(models::kBinaryManifestHeaderSize + models::kBinaryManifestRecordSize);
+    const auto truncated_path = temp_dir / "truncated.manifest";
+    if (!write_bytes(truncated_path, bytes, error)) {
+        return false;
+    }
+    std::string truncated_error;
+    if (!check(!models::read_manifest(truncated_path, truncated_error).has_value(),
+               "Truncated binary manifest should be rejected", error)) {
+        return false;
+    }
+
+    const auto input_path = temp_dir / "input.bin";
+    const auto input = make_test_data(90000);
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    services::SplitRequest split_request;
+    split_request.input_file = input_path;
+    split_request.output_dir = temp_dir / "chunks";
+    split_request.chunk_size_bytes = 16384;
+    split_request.manifest_format = models::ManifestFormat::Binary;
+
+    services::SplitResult split_result;
+    if (!services::split_file(split_request, split_result, error)) {
+        return false;
+    }
+    if (!check(models::is_binary_manifest(split_result.manifest_path), "Split should write a binary manifest",
+               error)) {
+        return false;
+    }
+
+    services::JoinRequest join_request;
+    join_request.manifest_path = split_result.manifest_path;
+    join_request.output_file = temp_dir / "joined.bin";
+
+    services::JoinResult join_result;
+    if (!services::join_file(join_request, join_result, error)) {
+        return false;
+    }
+
+    std::vector<std::byte> output;
+    if (!read_bytes(join_request.output_file, output, error)) {
+        return false;
+    }
+    return check(output == input, "Join from a binary manifest does not match the input", error);
+}
+
+}  // namespace humpty::tests
@@ -0,0 +1,183 @@
+#include "test_decls.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/checksums.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+
+bool run_parallel_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("parallel");
+    const auto input_path = temp_dir / "input.bin";
+    const auto serial_dir = temp_dir / "serial";
+    const auto parallel_dir = temp_dir / "parallel";
+    const auto joined_path = temp_dir / "joined.bin";
+
+    const auto input = make_test_data(300001);
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    services::SplitRequest serial_request;
+    serial_request.input_file = input_path;
+    serial_request.output_dir = serial_dir;
+    serial_request.chunk_size_bytes = 40000;
+    serial_request.source_digest = models::SourceDigest::Combined;
+
+    services::SplitResult serial_result;
+    if (!services::split_file(serial_request, serial_result, error)) {
+        return false;
+    }
+
+    services::SplitRequest parallel_request = serial_request;
+    parallel_request.output_dir = parallel_dir;
+    parallel_request.thread_count = 4;
+
+    services::SplitResult parallel_result;
+    if (!services::split_file(parallel_request, parallel_result, error)) {
+        return false;
+    }
+
+    if (!check(parallel_result.chunk_count == serial_result.chunk_count, "Parallel split chunk count mismatch",
+               error)) {
+        return false;
+    }
+
+    std::string manifest_error;
+    const auto serial_manifest = models::read_manifest(serial_result.manifest_path, manifest_error);
+    const auto parallel_manifest = models::read_manifest(parallel_result.manifest_path, manifest_error);
+    if (!serial_manifest.has_value() || !parallel_manifest.has_value()) {
+        error = "Failed reading manifest: " + manifest_error;
+        return false;
+    }
+
+    if (!check(!parallel_manifest->source_checksum.empty() &&
+                   parallel_manifest->source_checksum == serial_manifest->source_checksum,
+               "Parallel split combined source checksum mismatch", error)) {
+        return false;
+    }
+
+    // A parallel split reads the input once more in order for a stream digest.
+    services::SplitRequest stream_request = parallel_request;
+    stream_request.output_dir = temp_dir / "stream";
+    stream_request.source_digest = models::SourceDigest::Stream;
+    services::SplitResult stream_result;
+    if (!services::split_file(stream_request, stream_result, error)) {
+        return false;
+    }
+    std::string expected_digest;
+    const auto stream_manifest = models::read_manifest(stream_result.manifest_path, error);
+    if (!stream_manifest.has_value() ||
+        !services::hash_file_hex(input_path, models::ChecksumAlgorithm::Fnv1a64, expected_digest, error) ||
+        !check(stream_manifest->source_checksum == expected_digest,
+               "A parallel split should record the stream source checksum", error)) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < serial_manifest->chunks.size(); ++i) {
+        const auto& expected = serial_manifest->chunks[i];
+        const auto& actual = parallel_manifest->chunks[i];
+        if (!check(actual.index == expected.index && actual.offset == expected.offset &&
+                       actual.size == expected.size && actual.checksum == expected.checksum,
+                   "Parallel split chunk entry mismatch at index " + std::to_string(i), error)) {
+            return false;
+        }
+
+        std::vector<std::byte> serial_bytes;
+        std::vector<std::byte> parallel_bytes;
+        if (!read_bytes(serial_dir / expected.file_name, serial_bytes, error) ||
+            !read_bytes(parallel_dir / actual.file_name, parallel_bytes, error)) {
+            return false;
+        }
+        if (!check(serial_bytes == parallel_bytes, "Parallel chunk contents differ: " + actual.file_name, error)) {
+            return false;
+        }
+    }
+
+    services::JoinRequest join_request;
+    join_request.manifest_path = parallel_result.manifest_path;
+    join_request.output_file = joined_path;
+    join_request.thread_count = 4;
+
+    services::JoinResult join_result;
+    if (!services::join_file(join_request, join_result, error)) {
+        return false;
+    }
+
+    std::vector<std::byte> output;
+    if (!read_bytes(joined_path, output, error)) {
+        return false;
+    }
+    if (!check(output == input, "Parallel join output does not match original input", error)) {
+        return false;
+    }
+
+    const auto corrupt_chunk = parallel_dir / parallel_manifest->chunks.back().file_name;
+    std::vector<std::byte> corrupt_bytes;
+    if (!read_bytes(corrupt_chunk, corrupt_bytes, error)) {
+        return false;
+    }
+    corrupt_bytes.front() ^= std::byte{0x01};
+    if (!write_bytes(corrupt_chunk, corrupt_bytes, error)) {
+        return false;
+    }
+
+    if (services::join_file(join_request, join_result, error)) {
+        error = "Parallel join should fail when a chunk checksum is corrupted";
+        return false;
+    }
+    if (!check(error.find("checksum mismatch") != std::string::npos, "Expected checksum mismatch error", error)) {
+        return false;
+    }
+
+    join_request.thread_count = 1;
+    join_request.pipelined = true;
+    if (services::join_file(join_request, join_result, error)) {
+        error = "Pipelined join should fail when a chunk checksum is corrupted";
+        return false;
+    }
+    if (!check(error.find("checksum mismatch") != std::string::npos, "Expected pipelined checksum mismatch error",
+               error)) {
+        return false;
+    }
+
+    // A stream digest from a serial split is checked by a parallel join too.
+    services::SplitRequest stream_serial = serial_request;
+    stream_serial.output_dir = temp_dir / "stream-serial";
+    stream_serial.source_digest = models::SourceDigest::Stream;
+    services::SplitResult stream_serial_result;
+    if (!services::split_file(stream_serial, stream_serial_result, error)) {
+        return false;
+    }
+    join_request = {};
+    join_request.manifest_path = stream_serial_result.manifest_path;
+    join_request.output_file = temp_dir / "stream-joined.bin";
+    join_request.thread_count = 4;
+    std::vector<std::byte> stream_output;
+    if (!services::join_file(join_request, join_result, error) ||
+        !read_bytes(join_request.output_file, stream_output, error) ||
+        !check(stream_output == input, "Parallel join of a stream-digest manifest does not match the input", error)) {
+        return false;
+    }
+
+    auto stream_serial_manifest = models::read_manifest(join_request.manifest_path, error);
+    if (!stream_serial_manifest.has_value()) {
+        return false;
+    }
+    stream_serial_manifest->source_checksum.back() = stream_serial_manifest->source_checksum.back() == '0' ? '1' : '0';
+    if (!models::write_manifest(*stream_serial_manifest, join_request.manifest_path, error)) {
+        return false;
+    }
+    std::string join_error;
+    return check(!services::join_file(join_request, join_result, join_error) &&
+                     join_error.find("Source checksum mismatch") != std::string::npos,
+                 "A parallel join should check a stream source checksum", error);
+}
+
+}  // namespace humpty::tests
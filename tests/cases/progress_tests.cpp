@@ -0,0 +1,195 @@
+#include "test_decls.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "models/chunk.hpp"
+#include "services/joiner.hpp"
+#include "services/progress.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 1024 * 1024 + 99;
+constexpr std::uint64_t kChunkSize = 128 * 1024;
+constexpr std::size_t kChunkCount = 9;
+constexpr std::chrono::milliseconds kInterval{5};
+constexpr std::size_t kBigChunkSize = 32 * 1024 * 1024;
+
+// Keeps every report; callbacks arrive on the reporting thread.
+class Reports {
+public:
+    services::ProgressCallback callback() {
+        return [this](const services::Progress& progress) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            reports_.push_back(progress);
+        };
+    }
+
+    std::vector<services::Progress> take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::exchange(reports_, {});
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<services::Progress> reports_;
+};
+
+bool check_finished(const std::vector<services::Progress>& reports, std::string_view what, std::string& error) {
+    const std::string prefix(what);
+    if (!check(!reports.empty() && reports.back().finished, prefix + " should end with a finished report", error)) {
+        return false;
+    }
+    for (std::size_t i = 0; i + 1 < reports.size(); ++i) {
+        if (!check(!reports[i].finished && reports[i].bytes_done <= reports[i + 1].bytes_done,
+                   prefix + " reports should only move forward", error)) {
+            return false;
+        }
+    }
+    const auto& last = reports.back();
+    return check(last.bytes_done == kInputSize && last.bytes_total == kInputSize,
+                 prefix + " should report every byte", error) &&
+           check(last.chunks_done == kChunkCount && last.chunks_total == kChunkCount,
+                 prefix + " should report every chunk", error) &&
+           check(last.eta_seconds == 0.0 && last.elapsed_seconds >= 0.0, prefix + " should finish with no time left",
+                 error);
+}
+
+bool run_reporter_tests(std::string& error) {
+    Reports reports;
+    services::ProgressReporter reporter(reports.callback(), kInterval);
+    // Carried over before the start, as a resume does.
+    reporter.add(300);
+    reporter.start(1000, 4);
+    reporter.add(200);
+
+    // Nothing moves now, yet reports keep coming and show the stall.
+    std::this_thread::sleep_for(kInterval * 20);
+    auto seen = reports.take();
+    if (!check(seen.size() >= 2, "A reporter should report every interval, even when stalled", error) ||
+        !check(seen.back().bytes_done == 500 && seen.back().chunks_done == 2 && seen.back().bytes_total == 1000,
+               "A reporter should count what was added", error) ||
+        !check(seen.back().stalled_seconds > 0.0 && seen.back().current_bytes_per_second == 0.0,
+               "A stalled reporter should say so", error) ||
+        !check(seen.back().eta_seconds > 0.0, "A reporter with a total should estimate the time left", error)) {
+        return false;
+    }
+    // Only the 200 bytes added after the start count towards the average.
+    const auto& last = seen.back();
+    if (!check(last.average_bytes_per_second * last.elapsed_seconds < 201.0,
+               "Bytes carried over should not count towards the throughput", error)) {
+        return false;
+    }
+
+    // Bytes move within a chunk; the chunk counts once it is done.
+    reporter.add_bytes(250);
+    std::this_thread::sleep_for(kInterval * 4);
+    seen = reports.take();
+    if (!check(!seen.empty() && seen.back().bytes_done == 750 && seen.back().chunks_done == 2,
+               "Bytes should count before their chunk finishes", error)) {
+        return false;
+    }
+
+    reporter.add_bytes(250);
+    reporter.add_chunk();
+    reporter.finish(1000, 3);
+    seen = reports.take();
+    return check(seen.size() == 1 && seen.back().finished && seen.back().bytes_done == 1000 &&
+                     seen.back().chunks_done == 3 && seen.back().chunks_total == 3,
+                 "finish() should make one last report with the final totals", error);
+}
+
+}  // namespace
+
+bool run_progress_tests(std::string& error) {
+    if (!run_reporter_tests(error)) {
+        return false;
+    }
+
+    const auto temp_dir = make_temp_dir("progress");
+    const auto input = make_test_data(kInputSize);
+    const auto input_path = temp_dir / "input.bin";
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    Reports reports;
+    for (const std::size_t threads : {1, 3}) {
+        services::SplitRequest split;
+        split.input_file = input_path;
+        split.output_dir = temp_dir / "chunks";
+        split.chunk_size_bytes = kChunkSize;
+        split.thread_count = threads;
+        split.progress = reports.callback();
+        split.progress_interval = kInterval;
+        services::SplitResult split_result;
+        if (!services::split_file(split, split_result, error) ||
+            !check_finished(reports.take(), "A split", error)) {
+            return false;
+        }
+
+        services::JoinRequest join;
+        join.manifest_path = split_result.manifest_path;
+        join.output_file = temp_dir / "joined.bin";
+        join.thread_count = threads;
+        join.progress = reports.callback();
+        join.progress_interval = kInterval;
+        services::JoinResult join_result;
+        if (!services::join_file(join, join_result, error) || !check_finished(reports.take(), "A join", error)) {
+            return false;
+        }
+    }
+
+    // A chunk much larger than a copy block shows progress before it is done.
+    const auto big_input = make_test_data(kBigChunkSize);
+    if (!write_bytes(temp_dir / "big.bin", big_input, error)) {
+        return false;
+    }
+    services::SplitRequest big_split;
+    big_split.input_file = temp_dir / "big.bin";
+    big_split.output_dir = temp_dir / "big";
+    big_split.chunk_size_bytes = kBigChunkSize;
+    big_split.progress = reports.callback();
+    big_split.progress_interval = std::chrono::milliseconds{1};
+    services::SplitResult big_result;
+    if (!services::split_file(big_split, big_result, error)) {
+        return false;
+    }
+    bool partial = false;
+    for (const auto& progress : reports.take()) {
+        partial = partial || (progress.chunks_done == 0 && progress.bytes_done > 0);
+    }
+    if (!check(partial, "Progress should move within a chunk", error)) {
+        return false;
+    }
+
+    // A failed join stops reporting without claiming to have finished.
+    std::filesystem::remove(temp_dir / "chunks" / models::make_chunk_filename("input.bin", 4));
+    services::JoinRequest join;
+    join.manifest_path = temp_dir / "chunks" / "input.bin.manifest";
+    join.output_file = temp_dir / "broken.bin";
+    join.progress = reports.callback();
+    join.progress_interval = kInterval;
+    services::JoinResult join_result;
+    std::string join_error;
+    if (!check(!services::join_file(join, join_result, join_error), "A join missing a chunk should fail", error)) {
+        return false;
+    }
+    for (const auto& progress : reports.take()) {
+        if (!check(!progress.finished, "A failed join should not report that it finished", error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace humpty::tests
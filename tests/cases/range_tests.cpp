@@ -0,0 +1,114 @@
+#include "test_decls.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "services/range_reader.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 5 * 1024 * 1024 + 321;
+constexpr std::uint64_t kChunkSize = 2 * 1024 * 1024 + 1000;
+
+bool split_input(const std::filesystem::path& input_file,
+                 const std::filesystem::path& output_dir,
+                 models::ChunkCodec codec,
+                 std::filesystem::path& manifest_path,
+                 std::string& error) {
+    services::SplitRequest request;
+    request.input_file = input_file;
+    request.output_dir = output_dir;
+    request.chunk_size_bytes = kChunkSize;
+    request.codec = codec;
+    request.thread_count = 2;
+    services::SplitResult result;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    manifest_path = result.manifest_path;
+    return true;
+}
+
+// Ranges inside one chunk, across chunk and block boundaries, and at both
+// ends of the source, read in an order that revisits chunks.
+bool check_ranges(const std::filesystem::path& manifest_path,
+                  const std::vector<std::byte>& input,
+                  std::string& error) {
+    services::RangeReader reader;
+    if (!reader.open(manifest_path, true, 2, error)) {
+        return false;
+    }
+    const std::vector<std::pair<std::uint64_t, std::size_t>> ranges = {
+        {0, 10},
+        {kChunkSize - 5, 10},
+        {1024 * 1024 - 3, 7},
+        {kInputSize - 100, 100},
+        {12345, 3 * 1024 * 1024},
+        {kChunkSize + 1024 * 1024 + 17, 33},
+        {7, 1},
+        {0, kInputSize},
+    };
+    for (const auto& [offset, length] : ranges) {
+        std::vector<std::byte> buffer(length);
+        if (!reader.read(offset, buffer, error)) {
+            return false;
+        }
+        const auto begin = input.begin() + static_cast<std::ptrdiff_t>(offset);
+        if (!check(std::equal(buffer.begin(), buffer.end(), begin),
+                   "Range read differs from the input at offset " + std::to_string(offset), error)) {
+            return false;
+        }
+    }
+
+    std::vector<std::byte> past_end(2);
+    std::string range_error;
+    return check(!reader.read(kInputSize - 1, past_end, range_error), "A range past the end should fail", error);
+}
+
+}  // namespace
+
+bool run_range_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("range");
+    const auto input = make_test_data(kInputSize);
+    const auto input_path = temp_dir / "input.bin";
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    std::filesystem::path plain_manifest;
+    std::filesystem::path lz4_manifest;
+    if (!split_input(input_path, temp_dir / "plain", models::ChunkCodec::None, plain_manifest, error) ||
+        !check_ranges(plain_manifest, input, error) ||
+        !split_input(input_path, temp_dir / "lz4", models::ChunkCodec::Lz4, lz4_manifest, error) ||
+        !check_ranges(lz4_manifest, input, error)) {
+        return false;
+    }
+
+    // A damaged chunk goes unnoticed by reads elsewhere but fails a
+    // verifying read that touches it.
+    const auto chunk_path = temp_dir / "plain" / models::make_chunk_filename("input.bin", 1);
+    std::vector<std::byte> chunk;
+    if (!read_bytes(chunk_path, chunk, error)) {
+        return false;
+    }
+    chunk[100] ^= std::byte{0x01};
+    if (!write_bytes(chunk_path, chunk, error)) {
+        return false;
+    }
+    services::RangeReader reader;
+    std::vector<std::byte> buffer(64);
+    std::string verify_error;
+    if (!reader.open(plain_manifest, true, services::RangeReader::kDefaultOpenChunks, error) ||
+        !reader.read(0, buffer, error)) {
+        return false;
+    }
+    return check(!reader.read(kChunkSize + 4096, buffer, verify_error),
+                 "A verifying read should reject a damaged chunk", error);
+}
+
+}  // namespace humpty::tests
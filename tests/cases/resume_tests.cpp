@@ -0,0 +1,284 @@
+#include "test_decls.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/checkpoint.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 90000;
+constexpr std::uint64_t kChunkSize = 16384;
+
+// Cuts a streamed text manifest back to its header and first `keep` records,
+// as if the split had been stopped there.
+bool truncate_manifest(const std::filesystem::path& path, std::size_t keep, std::string& error) {
+    std::string text;
+    {
+        std::ifstream in(path, std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    std::size_t end = text.find("\nchunk ");
+    for (std::size_t i = 0; i < keep && end != std::string::npos; ++i) {
+        end = text.find('\n', end + 1);
+    }
+    if (!check(end != std::string::npos, "Manifest has fewer records than expected", error)) {
+        return false;
+    }
+    text.resize(end + 1);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+    return check(out.good(), "Failed rewriting manifest: " + path.string(), error);
+}
+
+bool run_split_resume_tests(const std::filesystem::path& temp_dir,
+                            const std::vector<std::byte>& input,
+                            std::string& error) {
+    services::SplitRequest request;
+    request.input_file = temp_dir / "input.bin";
+    request.output_dir = temp_dir / "chunks";
+    request.chunk_size_bytes = kChunkSize;
+
+    services::SplitResult result;
+    if (!services::split_file(request, result, error) || !truncate_manifest(result.manifest_path, 4, error)) {
+        return false;
+    }
+
+    // Chunk 2 lost its tail, so only chunks 0 and 1 can be kept.
+    const auto kept_path = request.output_dir / models::make_chunk_filename("input.bin", 0);
+    const auto damaged_path = request.output_dir / models::make_chunk_filename("input.bin", 2);
+    std::filesystem::resize_file(damaged_path, 100);
+    const auto old_time = std::filesystem::last_write_time(kept_path) - std::chrono::hours(1);
+    std::filesystem::last_write_time(kept_path, old_time);
+
+    request.resume = true;
+    request.thread_count = 3;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    if (!check(result.chunks_resumed == 2 && result.chunk_count == 6,
+               "Resumed split should keep exactly the intact leading chunks", error)) {
+        return false;
+    }
+    const auto resumed_manifest = models::read_manifest(result.manifest_path, error);
+    if (!resumed_manifest || !check(!resumed_manifest->source_checksum.empty(),
+                                    "Resumed split should still record the source checksum", error)) {
+        return false;
+    }
+    if (!check(std::filesystem::last_write_time(kept_path) == old_time,
+               "Resumed split rewrote a chunk it should have kept", error)) {
+        return false;
+    }
+
+    services::JoinRequest join_request;
+    join_request.manifest_path = result.manifest_path;
+    join_request.output_file = temp_dir / "split-resumed.bin";
+    services::JoinResult join_result;
+    if (!services::join_file(join_request, join_result, error)) {
+        return false;
+    }
+    std::vector<std::byte> output;
+    if (!read_bytes(join_request.output_file, output, error) ||
+        !check(output == input, "Join after a resumed split does not match the input", error)) {
+        return false;
+    }
+
+    // With nothing to carry over, a resumed split hashes the whole input as usual.
+    request.output_dir = temp_dir / "fresh";
+    request.thread_count = 1;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    auto manifest = models::read_manifest(result.manifest_path, error);
+    if (!manifest || !check(result.chunks_resumed == 0 && !manifest->source_checksum.empty(),
+                            "A resumed split that starts from scratch should record the source checksum", error)) {
+        return false;
+    }
+
+    // Resuming a finished split leaves its manifest as it was.
+    std::vector<std::byte> finished;
+    if (!read_bytes(result.manifest_path, finished, error) || !services::split_file(request, result, error)) {
+        return false;
+    }
+    std::vector<std::byte> resumed;
+    if (!read_bytes(result.manifest_path, resumed, error)) {
+        return false;
+    }
+    return check(result.chunks_resumed == 6 && result.chunk_count == 6 && resumed == finished,
+                 "Resuming a finished split should keep its manifest", error);
+}
+
+bool run_join_resume_tests(const std::filesystem::path& temp_dir,
+                           const std::vector<std::byte>& input,
+                           std::string& error) {
+    services::SplitRequest split_request;
+    split_request.input_file = temp_dir / "input.bin";
+    split_request.output_dir = temp_dir / "join-chunks";
+    split_request.chunk_size_bytes = kChunkSize;
+    split_request.source_digest = models::SourceDigest::Combined;
+    services::SplitResult split_result;
+    if (!services::split_file(split_request, split_result, error)) {
+        return false;
+    }
+
+    // A corrupt chunk 3 stops the first join after chunks 0-2.
+    const auto chunk_path = [&](std::uint32_t index) {
+        return split_request.output_dir / models::make_chunk_filename("input.bin", index);
+    };
+    std::vector<std::byte> chunk3;
+    if (!read_bytes(chunk_path(3), chunk3, error)) {
+        return false;
+    }
+    auto corrupt = chunk3;
+    corrupt[10] ^= std::byte{0xFF};
+    if (!write_bytes(chunk_path(3), corrupt, error)) {
+        return false;
+    }
+
+    services::JoinRequest request;
+    request.manifest_path = split_result.manifest_path;
+    request.output_file = temp_dir / "joined.bin";
+    services::JoinResult result;
+    std::string join_error;
+    if (!check(!services::join_file(request, result, join_error), "Join of a corrupt chunk should fail",
+               error)) {
+        return false;
+    }
+    const auto checkpoint = services::join_checkpoint_path(request.output_file);
+    if (!check(std::filesystem::exists(checkpoint), "Failed join should leave its checkpoint", error)) {
+        return false;
+    }
+
+    // Chunk 0 is already in the output, so breaking it now must not matter.
+    std::vector<std::byte> chunk0;
+    if (!read_bytes(chunk_path(0), chunk0, error) || !write_bytes(chunk_path(3), chunk3, error) ||
+        !write_bytes(chunk_path(0), corrupt, error)) {
+        return false;
+    }
+
+    request.resume = true;
+    if (!services::join_file(request, result, error)) {
+        return false;
+    }
+    if (!check(result.chunks_resumed == 3, "Resumed join should skip the chunks in its checkpoint", error)) {
+        return false;
+    }
+    if (!check(!std::filesystem::exists(checkpoint), "Finished join should remove its checkpoint", error)) {
+        return false;
+    }
+
+    std::vector<std::byte> output;
+    if (!read_bytes(request.output_file, output, error) ||
+        !check(output == input, "Resumed join does not match the input", error)) {
+        return false;
+    }
+
+    // A device cannot be resumed into, so it gets no checkpoint.
+    if (!write_bytes(chunk_path(0), chunk0, error)) {
+        return false;
+    }
+    services::JoinRequest null_request;
+    null_request.manifest_path = split_result.manifest_path;
+    null_request.output_file = "/dev/null";
+    if (!services::join_file(null_request, result, error) ||
+        !check(!std::filesystem::exists(services::join_checkpoint_path(null_request.output_file)),
+               "A join to a device should not write a checkpoint", error)) {
+        return false;
+    }
+
+    // A join that fails before any chunk is written leaves no checkpoint.
+    std::filesystem::remove(chunk_path(0));
+    request.resume = false;
+    request.output_file = temp_dir / "early.bin";
+    return check(!services::join_file(request, result, join_error), "Join of a missing chunk should fail", error) &&
+           check(!std::filesystem::exists(services::join_checkpoint_path(request.output_file)),
+                 "A join that wrote nothing should not leave a checkpoint", error);
+}
+
+// A stream source checksum is checked over the whole output once a resumed
+// join has filled it, chunks kept from the first attempt included.
+bool run_stream_join_resume_tests(const std::filesystem::path& temp_dir,
+                                  const std::vector<std::byte>& input,
+                                  std::string& error) {
+    services::SplitRequest split_request;
+    split_request.input_file = temp_dir / "input.bin";
+    split_request.output_dir = temp_dir / "stream-chunks";
+    split_request.chunk_size_bytes = kChunkSize;
+    services::SplitResult split_result;
+    if (!services::split_file(split_request, split_result, error)) {
+        return false;
+    }
+
+    const auto chunk3_path = split_request.output_dir / models::make_chunk_filename("input.bin", 3);
+    std::vector<std::byte> chunk3;
+    if (!read_bytes(chunk3_path, chunk3, error)) {
+        return false;
+    }
+    auto corrupt = chunk3;
+    corrupt[10] ^= std::byte{0xFF};
+
+    services::JoinRequest request;
+    request.manifest_path = split_result.manifest_path;
+    request.output_file = temp_dir / "stream-joined.bin";
+    services::JoinResult result;
+    std::string join_error;
+    for (const bool damage_output : {false, true}) {
+        request.resume = false;
+        if (!write_bytes(chunk3_path, corrupt, error) ||
+            !check(!services::join_file(request, result, join_error), "Join of a corrupt chunk should fail",
+                   error) ||
+            !write_bytes(chunk3_path, chunk3, error)) {
+            return false;
+        }
+        if (damage_output) {
+            std::vector<std::byte> output;
+            if (!read_bytes(request.output_file, output, error)) {
+                return false;
+            }
+            output[5] ^= std::byte{0x01};
+            if (!write_bytes(request.output_file, output, error)) {
+                return false;
+            }
+        }
+
+        request.resume = true;
+        const bool joined = services::join_file(request, result, join_error);
+        if (damage_output) {
+            return check(!joined && join_error.find("Source checksum mismatch") != std::string::npos,
+                         "A resumed join should check the chunks it kept against a stream digest", error);
+        }
+        std::vector<std::byte> output;
+        if (!check(joined && result.chunks_resumed == 3, "A verified join should resume with a stream digest",
+                   error) ||
+            !read_bytes(request.output_file, output, error) ||
+            !check(output == input, "Resumed stream-digest join does not match the input", error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+bool run_resume_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("resume");
+    const auto input = make_test_data(kInputSize);
+    if (!write_bytes(temp_dir / "input.bin", input, error)) {
+        return false;
+    }
+    return run_split_resume_tests(temp_dir, input, error) && run_join_resume_tests(temp_dir, input, error) &&
+           run_stream_join_resume_tests(temp_dir, input, error);
+}
+
+}  // namespace humpty::tests
@@ -1,21 +1,34 @@
 #include "test_decls.hpp"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "services/file_io.hpp"
 #include "services/joiner.hpp"
 #include "services/splitter.hpp"
 #include "test_utils.hpp"
 
 namespace humpty::tests {
+namespace {
 
-bool run_roundtrip_tests(std::string& error) {
-    const auto temp_dir = make_temp_dir("roundtrip");
+struct RoundtripCase {
+    std::string name;
+    services::IoEngine io_engine = services::IoEngine::Stream;
+    std::size_t thread_count = 1;
+    bool checksums = true;
+    std::size_t queue_depth = 32;
+    bool pipelined = false;
+    bool direct = false;
+    std::uint64_t chunk_size = 65536;
+};
+
+bool run_roundtrip_case(const RoundtripCase& roundtrip, const std::vector<std::byte>& input, std::string& error) {
+    const auto temp_dir = make_temp_dir("roundtrip-" + roundtrip.name);
     const auto input_path = temp_dir / "input.bin";
     const auto output_dir = temp_dir / "chunks";
     const auto joined_path = temp_dir / "joined.bin";
 
-    const auto input = make_test_data(400000);
     if (!write_bytes(input_path, input, error)) {
         return false;
     }
@@ -23,20 +36,35 @@ bool run_roundtrip_tests(std::string& error) {
     services::SplitRequest split_request;
     split_request.input_file = input_path;
     split_request.output_dir = output_dir;
-    split_request.chunk_size_bytes = 65536;
+    split_request.chunk_size_bytes = roundtrip.chunk_size;
+    split_request.io_engine = roundtrip.io_engine;
+    split_request.thread_count = roundtrip.thread_count;
+    split_request.compute_checksums = roundtrip.checksums;
+    split_request.queue_depth = roundtrip.queue_depth;
+    split_request.pipelined = roundtrip.pipelined;
+    split_request.direct_io = roundtrip.direct;
+    split_request.direct_buffer_size = 16384;
 
     services::SplitResult split_result;
     if (!services::split_file(split_request, split_result, error)) {
+        error = roundtrip.name + ": " + error;
         return false;
     }
 
     services::JoinRequest join_request;
     join_request.manifest_path = split_result.manifest_path;
     join_request.output_file = joined_path;
-    join_request.verify_checksums = true;
+    join_request.verify_checksums = roundtrip.checksums;
+    join_request.io_engine = roundtrip.io_engine;
+    join_request.thread_count = roundtrip.thread_count;
+    join_request.queue_depth = roundtrip.queue_depth;
+    join_request.pipelined = roundtrip.pipelined;
+    join_request.direct_io = roundtrip.direct;
+    join_request.direct_buffer_size = 16384;
 
     services::JoinResult join_result;
     if (!services::join_file(join_request, join_result, error)) {
+        error = roundtrip.name + ": " + error;
         return false;
     }
 
@@ -45,14 +73,44 @@ bool run_roundtrip_tests(std::string& error) {
         return false;
     }
 
-    if (!check(output == input, "Joined output does not match original input", error)) {
+    if (!check(output == input, roundtrip.name + ": joined output does not match original input", error)) {
         return false;
     }
-    if (!check(join_result.total_bytes_written == input.size(), "Joined byte count mismatch", error)) {
+    if (!check(join_result.total_bytes_written == input.size(), roundtrip.name + ": joined byte count mismatch",
+               error)) {
         return false;
     }
 
     return true;
 }
 
+}  // namespace
+
+bool run_roundtrip_tests(std::string& error) {
+    const auto input = make_test_data(400000);
+
+    const std::vector<RoundtripCase> cases = {
+        {"stream", services::IoEngine::Stream, 1},
+        {"stream-threads", services::IoEngine::Stream, 3},
+        {"mmap", services::IoEngine::Mmap, 1},
+        {"mmap-threads", services::IoEngine::Mmap, 3},
+        {"kernel-copy", services::IoEngine::Stream, 1, false},
+        {"kernel-copy-threads", services::IoEngine::Stream, 3, false},
+        {"uring", services::IoEngine::Uring, 1},
+        {"uring-shallow-queue", services::IoEngine::Uring, 1, true, 2},
+        {"pipeline", services::IoEngine::Stream, 1, true, 32, true},
+        {"direct", services::IoEngine::Stream, 1, true, 32, false, true},
+        {"direct-threads-unaligned", services::IoEngine::Stream, 3, true, 32, false, true, 50001},
+        {"direct-no-checksum-unaligned", services::IoEngine::Stream, 1, false, 32, false, true, 50001},
+    };
+
+    for (const auto& roundtrip : cases) {
+        if (!run_roundtrip_case(roundtrip, input, error)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 }  // namespace humpty::tests
@@ -0,0 +1,84 @@
+#include "test_decls.hpp"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 1024 * 1024 + 99;
+constexpr std::uint64_t kChunkSize = 128 * 1024;
+constexpr std::size_t kChunkCount = 9;
+
+bool check_counted(const services::TransferStats& stats, std::string_view what, std::string& error) {
+    const std::string prefix(what);
+    return check(stats.bytes_read >= kInputSize && stats.bytes_written >= kInputSize,
+                 prefix + " should count the bytes it moved", error) &&
+           check(stats.read_calls > 0 && stats.write_calls > 0 && stats.open_calls >= kChunkCount + 1,
+                 prefix + " should count its reads, writes and opens", error) &&
+           check(stats.hash_seconds > 0.0 && stats.manifest_seconds > 0.0,
+                 prefix + " should time hashing and manifest I/O", error) &&
+           check(stats.total_seconds >= stats.setup_seconds + stats.data_seconds &&
+                     stats.data_seconds >= 0.0 && stats.finish_seconds >= 0.0,
+                 prefix + " phases should fit in the total", error);
+}
+
+}  // namespace
+
+bool run_stats_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("stats");
+    const auto input = make_test_data(kInputSize);
+    const auto input_path = temp_dir / "input.bin";
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    services::SplitRequest split;
+    split.input_file = input_path;
+    split.output_dir = temp_dir / "chunks";
+    split.chunk_size_bytes = kChunkSize;
+    services::SplitResult split_result;
+    if (!services::split_file(split, split_result, error) ||
+        !check(split_result.stats.total_seconds == 0.0 && split_result.stats.bytes_read == 0,
+               "Stats should stay empty unless requested", error)) {
+        return false;
+    }
+
+    // Each data path counts through the same hooks.
+    for (const std::size_t threads : {1, 3}) {
+        split.collect_stats = true;
+        split.thread_count = threads;
+        if (!services::split_file(split, split_result, error) ||
+            !check_counted(split_result.stats, "A split", error)) {
+            return false;
+        }
+
+        services::JoinRequest join;
+        join.manifest_path = split_result.manifest_path;
+        join.output_file = temp_dir / "joined.bin";
+        join.thread_count = threads;
+        join.collect_stats = true;
+        services::JoinResult join_result;
+        if (!services::join_file(join, join_result, error) || !check_counted(join_result.stats, "A join", error)) {
+            return false;
+        }
+        if (!check(join_result.stats.peak_buffer_bytes > 0, "A buffered join should report its buffers", error)) {
+            return false;
+        }
+    }
+
+    split.io_engine = services::IoEngine::Uring;
+    split.thread_count = 1;
+    if (!services::split_file(split, split_result, error)) {
+        return false;
+    }
+    return check_counted(split_result.stats, "An async split", error);
+}
+
+}  // namespace humpty::tests
@@ -0,0 +1,164 @@
+#include "test_decls.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "models/manifest.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 3 * 1024 * 1024 + 12345;
+constexpr std::uint64_t kChunkSize = 1024 * 1024 + 4096;
+
+// Points a standard descriptor elsewhere until destroyed.
+class RedirectedFd {
+public:
+    RedirectedFd(int target, int replacement) : target_(target), saved_(::dup(target)) {
+        ::dup2(replacement, target_);
+        ::close(replacement);
+    }
+    ~RedirectedFd() {
+        ::dup2(saved_, target_);
+        ::close(saved_);
+    }
+    RedirectedFd(const RedirectedFd&) = delete;
+    RedirectedFd& operator=(const RedirectedFd&) = delete;
+
+private:
+    int target_;
+    int saved_;
+};
+
+// Feeds `data` to the split through a pipe, which hands it over in short
+// reads, as a shell pipeline would.
+bool split_from_pipe(const std::vector<std::byte>& data,
+                     services::SplitRequest request,
+                     services::SplitResult& result,
+                     std::string& error) {
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        error = "Failed to create pipe";
+        return false;
+    }
+    std::thread writer([&data, fd = fds[1]] {
+        std::size_t done = 0;
+        while (done < data.size()) {
+            const auto put = ::write(fd, data.data() + done, std::min<std::size_t>(data.size() - done, 100000));
+            if (put <= 0) {
+                break;
+            }
+            done += static_cast<std::size_t>(put);
+        }
+        ::close(fd);
+    });
+
+    bool ok = false;
+    {
+        const RedirectedFd redirect(STDIN_FILENO, fds[0]);
+        request.input_file = "-";
+        ok = services::split_file(request, result, error);
+    }
+    writer.join();
+    return ok;
+}
+
+bool join_matches(const std::filesystem::path& manifest_path,
+                  const std::filesystem::path& output_file,
+                  const std::vector<std::byte>& expected,
+                  std::string& error) {
+    services::JoinRequest request;
+    request.manifest_path = manifest_path;
+    request.output_file = output_file;
+    services::JoinResult result;
+    if (!services::join_file(request, result, error)) {
+        return false;
+    }
+    std::vector<std::byte> output;
+    if (!read_bytes(output_file, output, error)) {
+        return false;
+    }
+    return check(output == expected, "Join of a split from standard input does not match the input", error);
+}
+
+}  // namespace
+
+bool run_stdio_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("stdio");
+    const auto input = make_test_data(kInputSize);
+
+    services::SplitRequest request;
+    request.output_dir = temp_dir / "plain";
+    request.chunk_size_bytes = kChunkSize;
+    services::SplitResult result;
+    if (!split_from_pipe(input, request, result, error)) {
+        return false;
+    }
+    auto manifest = models::read_manifest(result.manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    if (!check(result.chunk_count == 4 && result.total_bytes == kInputSize && manifest->source_size == kInputSize &&
+                   manifest->source_file_name == "stdin" &&
+                   std::filesystem::file_size(temp_dir / "plain" / "stdin.part0003") == kInputSize - 3 * kChunkSize,
+               "Split from standard input should cut full chunks and record the size at the end", error)) {
+        return false;
+    }
+    if (!join_matches(result.manifest_path, temp_dir / "plain.out", input, error)) {
+        return false;
+    }
+
+    request.output_dir = temp_dir / "lz4";
+    request.source_name = "dump.sql";
+    request.codec = models::ChunkCodec::Lz4;
+    request.manifest_format = models::ManifestFormat::Binary;
+    if (!split_from_pipe(input, request, result, error)) {
+        return false;
+    }
+    if (!check(result.manifest_path == temp_dir / "lz4" / "dump.sql.manifest" &&
+                   result.stored_bytes < result.total_bytes,
+               "Compressed split from standard input should use the given name", error)) {
+        return false;
+    }
+
+    // Joined to standard output, here a file, without leaving a checkpoint.
+    std::cout.flush();
+    const auto stdout_path = temp_dir / "stdout.bin";
+    services::JoinRequest join_request;
+    join_request.manifest_path = result.manifest_path;
+    join_request.output_file = "-";
+    services::JoinResult join_result;
+    bool joined = false;
+    {
+        const RedirectedFd redirect(STDOUT_FILENO, ::open(stdout_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+        joined = services::join_file(join_request, join_result, error);
+    }
+    if (!joined) {
+        return false;
+    }
+    std::vector<std::byte> output;
+    if (!read_bytes(stdout_path, output, error) ||
+        !check(output == input && !std::filesystem::exists("-.checkpoint"),
+               "Join to standard output does not match the input", error)) {
+        return false;
+    }
+
+    // Rejected before anything is read, so no pipe is needed.
+    request.input_file = "-";
+    request.resume = true;
+    const RedirectedFd redirect(STDIN_FILENO, ::open("/dev/null", O_RDONLY));
+    std::string resume_error;
+    return check(!services::split_file(request, result, resume_error),
+                 "A resumed split from standard input should be rejected", error);
+}
+
+}  // namespace humpty::tests
@@ -0,0 +1,120 @@
+#include "test_decls.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "models/manifest.hpp"
+#include "services/joiner.hpp"
+#include "services/splitter.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 90000;
+constexpr std::uint64_t kChunkSize = 16384;
+
+std::size_t count_files(const std::filesystem::path& dir) {
+    std::size_t count = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
+        count += entry.is_regular_file() ? 1 : 0;
+    }
+    return count;
+}
+
+bool join_matches(const std::filesystem::path& manifest_path,
+                  const std::filesystem::path& output_file,
+                  const std::vector<std::byte>& expected,
+                  std::string& error) {
+    services::JoinRequest request;
+    request.manifest_path = manifest_path;
+    request.output_file = output_file;
+    request.thread_count = 2;
+    services::JoinResult result;
+    if (!services::join_file(request, result, error)) {
+        return false;
+    }
+    std::vector<std::byte> output;
+    if (!read_bytes(output_file, output, error)) {
+        return false;
+    }
+    return check(output == expected, "Join from a chunk store does not match the input", error);
+}
+
+}  // namespace
+
+bool run_store_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("store");
+    const auto store_dir = temp_dir / "store";
+
+    // make_test_data() repeats every 256 bytes, so all five full chunks are
+    // the same and only the short last chunk differs from them.
+    auto input = make_test_data(kInputSize);
+    if (!write_bytes(temp_dir / "first.bin", input, error)) {
+        return false;
+    }
+
+    services::SplitRequest request;
+    request.input_file = temp_dir / "first.bin";
+    request.output_dir = temp_dir / "first";
+    request.chunk_size_bytes = kChunkSize;
+    request.chunk_store = store_dir;
+    request.checksum_algorithm = models::ChecksumAlgorithm::Xxh64;
+    request.thread_count = 3;
+    services::SplitResult result;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    if (!check(result.chunk_count == 6 && result.chunks_changed == 2 && count_files(store_dir) == 2,
+               "Chunk store should hold each distinct chunk once", error)) {
+        return false;
+    }
+    auto manifest = models::read_manifest(result.manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    if (!check(manifest->chunk_store == "../store" &&
+                   manifest->chunks[1].file_name ==
+                       models::make_store_object_name(manifest->chunks[1].checksum, kChunkSize),
+               "Manifest should name chunks by digest inside a relative store path", error)) {
+        return false;
+    }
+    if (!join_matches(result.manifest_path, temp_dir / "first.out", input, error)) {
+        return false;
+    }
+
+    // A second artifact that differs in one chunk adds only that chunk.
+    input[2 * kChunkSize + 5] ^= std::byte{0x33};
+    if (!write_bytes(temp_dir / "second.bin", input, error)) {
+        return false;
+    }
+    request.input_file = temp_dir / "second.bin";
+    request.output_dir = temp_dir / "second";
+    request.manifest_format = models::ManifestFormat::Binary;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    if (!check(result.chunks_changed == 1 && count_files(store_dir) == 3,
+               "Second split should store only the chunk that differs", error)) {
+        return false;
+    }
+    manifest = models::read_manifest(result.manifest_path, error);
+    if (!manifest) {
+        return false;
+    }
+    if (!check(manifest->chunk_store == "../store" && manifest->chunks[2].changed && !manifest->chunks[3].changed,
+               "Binary manifest should keep the store path and the changed flags", error)) {
+        return false;
+    }
+    if (!join_matches(result.manifest_path, temp_dir / "second.out", input, error)) {
+        return false;
+    }
+
+    request.checksum_algorithm = models::ChecksumAlgorithm::Crc32c;
+    std::string store_error;
+    return check(!services::split_file(request, result, store_error),
+                 "A chunk store split with 32-bit digests should be rejected", error);
+}
+
+}  // namespace humpty::tests
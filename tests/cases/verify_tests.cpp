@@ -0,0 +1,113 @@
+#include "test_decls.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "services/splitter.hpp"
+#include "services/verifier.hpp"
+#include "test_utils.hpp"
+
+namespace humpty::tests {
+namespace {
+
+constexpr std::size_t kInputSize = 3 * 1024 * 1024 + 77;
+constexpr std::uint64_t kChunkSize = 256 * 1024;
+
+bool split_input(const std::filesystem::path& input_file,
+                 const std::filesystem::path& output_dir,
+                 models::SourceDigest digest,
+                 models::ChunkCodec codec,
+                 std::filesystem::path& manifest_path,
+                 std::string& error) {
+    services::SplitRequest request;
+    request.input_file = input_file;
+    request.output_dir = output_dir;
+    request.chunk_size_bytes = kChunkSize;
+    request.source_digest = digest;
+    request.codec = codec;
+    services::SplitResult result;
+    if (!services::split_file(request, result, error)) {
+        return false;
+    }
+    manifest_path = result.manifest_path;
+    return true;
+}
+
+bool verify_clean(const std::filesystem::path& manifest_path, std::size_t thread_count, std::string& error) {
+    services::VerifyRequest request;
+    request.manifest_path = manifest_path;
+    request.thread_count = thread_count;
+    request.verify_source = true;
+    services::VerifyResult result;
+    if (!services::verify_chunk_set(request, result, error)) {
+        return false;
+    }
+    return check(result.source_verified && result.faults.empty() && result.chunks_checked == 13,
+                 "A clean chunk set should verify with its source digest", error);
+}
+
+bool flip_byte(const std::filesystem::path& path, std::size_t position, std::string& error) {
+    std::vector<std::byte> data;
+    if (!read_bytes(path, data, error)) {
+        return false;
+    }
+    data[position] ^= std::byte{0x40};
+    return write_bytes(path, data, error);
+}
+
+}  // namespace
+
+bool run_verify_tests(std::string& error) {
+    const auto temp_dir = make_temp_dir("verify");
+    const auto input = make_test_data(kInputSize);
+    const auto input_path = temp_dir / "input.bin";
+    if (!write_bytes(input_path, input, error)) {
+        return false;
+    }
+
+    std::filesystem::path combined_manifest;
+    std::filesystem::path stream_manifest;
+    std::filesystem::path lz4_manifest;
+    if (!split_input(input_path, temp_dir / "combined", models::SourceDigest::Combined, models::ChunkCodec::None,
+                     combined_manifest, error) ||
+        !split_input(input_path, temp_dir / "stream", models::SourceDigest::Stream, models::ChunkCodec::None,
+                     stream_manifest, error) ||
+        !split_input(input_path, temp_dir / "lz4", models::SourceDigest::Combined, models::ChunkCodec::Lz4,
+                     lz4_manifest, error) ||
+        !verify_clean(combined_manifest, 4, error) || !verify_clean(stream_manifest, 4, error) ||
+        !verify_clean(lz4_manifest, 3, error)) {
+        return false;
+    }
+
+    // A missing, a truncated and a corrupted chunk are all reported.
+    const auto dir = temp_dir / "combined";
+    std::filesystem::remove(dir / models::make_chunk_filename("input.bin", 2));
+    std::filesystem::resize_file(dir / models::make_chunk_filename("input.bin", 5), 1000);
+    if (!flip_byte(dir / models::make_chunk_filename("input.bin", 11), 4096, error)) {
+        return false;
+    }
+    services::VerifyRequest request;
+    request.manifest_path = combined_manifest;
+    request.thread_count = 4;
+    services::VerifyResult result;
+    std::string verify_error;
+    if (!check(!services::verify_chunk_set(request, result, verify_error), "A damaged chunk set should fail",
+               error) ||
+        !check(result.faults.size() == 3 && result.faults[0].index == 2 && result.faults[0].reason == "missing" &&
+                   result.faults[1].index == 5 && result.faults[2].index == 11 &&
+                   result.faults[2].reason == "checksum mismatch",
+               "Every damaged chunk should be reported in order", error)) {
+        return false;
+    }
+
+    if (!flip_byte(temp_dir / "lz4" / models::make_chunk_filename("input.bin", 7), 100, error)) {
+        return false;
+    }
+    request.manifest_path = lz4_manifest;
+    return check(!services::verify_chunk_set(request, result, verify_error) && result.faults.size() == 1 &&
+                     result.faults[0].index == 7,
+                 "A corrupted compressed chunk should be reported", error);
+}
+
+}  // namespace humpty::tests
@@ -8,5 +8,19 @@ bool run_splitter_tests(std::string& error);
 bool run_joiner_tests(std::string& error);
 bool run_roundtrip_tests(std::string& error);
 bool run_urandom_tests(std::string& error);
+bool run_parallel_tests(std::string& error);
+bool run_checksum_tests(std::string& error);
+bool run_manifest_tests(std::string& error);
+bool run_resume_tests(std::string& error);
+bool run_incremental_tests(std::string& error);
+bool run_cdc_tests(std::string& error);
+bool run_store_tests(std::string& error);
+bool run_codec_tests(std::string& error);
+bool run_stdio_tests(std::string& error);
+bool run_range_tests(std::string& error);
+bool run_verify_tests(std::string& error);
+bool run_stats_tests(std::string& error);
+bool run_progress_tests(std::string& error);
+bool run_buffer_tests(std::string& error);
 
 }  // namespace humpty::tests
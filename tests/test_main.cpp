@@ -19,9 +19,58 @@ bool run_case(std::string_view name, std::string& error) {
     if (name == "urandom") {
         return humpty::tests::run_urandom_tests(error);
     }
+    if (name == "parallel") {
+        return humpty::tests::run_parallel_tests(error);
+    }
+    if (name == "checksums") {
+        return humpty::tests::run_checksum_tests(error);
+    }
+    if (name == "manifest") {
+        return humpty::tests::run_manifest_tests(error);
+    }
+    if (name == "resume") {
+        return humpty::tests::run_resume_tests(error);
+    }
+    if (name == "incremental") {
+        return humpty::tests::run_incremental_tests(error);
+    }
+    if (name == "cdc") {
+        return humpty::tests::run_cdc_tests(error);
+    }
+    if (name == "store") {
+        return humpty::tests::run_store_tests(error);
+    }
+    if (name == "codec") {
+        return humpty::tests::run_codec_tests(error);
+    }
+    if (name == "stdio") {
+        return humpty::tests::run_stdio_tests(error);
+    }
+    if (name == "range") {
+        return humpty::tests::run_range_tests(error);
+    }
+    if (name == "verify") {
+        return humpty::tests::run_verify_tests(error);
+    }
+    if (name == "stats") {
+        return humpty::tests::run_stats_tests(error);
+    }
+    if (name == "progress") {
+        return humpty::tests::run_progress_tests(error);
+    }
+    if (name == "buffer") {
+        return humpty::tests::run_buffer_tests(error);
+    }
     if (name == "all") {
         return humpty::tests::run_splitter_tests(error) && humpty::tests::run_joiner_tests(error) &&
-               humpty::tests::run_roundtrip_tests(error) && humpty::tests::run_urandom_tests(error);
+               humpty::tests::run_roundtrip_tests(error) && humpty::tests::run_urandom_tests(error) &&
+               humpty::tests::run_parallel_tests(error) && humpty::tests::run_checksum_tests(error) &&
+               humpty::tests::run_manifest_tests(error) && humpty::tests::run_resume_tests(error) &&
+               humpty::tests::run_incremental_tests(error) && humpty::tests::run_cdc_tests(error) &&
+               humpty::tests::run_store_tests(error) && humpty::tests::run_codec_tests(error) &&
+               humpty::tests::run_stdio_tests(error) && humpty::tests::run_range_tests(error) &&
+               humpty::tests::run_verify_tests(error) && humpty::tests::run_stats_tests(error) &&
+               humpty::tests::run_progress_tests(error) && humpty::tests::run_buffer_tests(error);
     }
     error = "Unknown test case: " + std::string(name);
     return false;
@@ -40,7 +89,7 @@ int main(int argc, char* argv[]) {
             continue;
         }
         if (token == "--help" || token == "-h") {
-            std::cout << "Usage: humpty_tests [--case|-c <all|splitter|joiner|roundtrip|urandom>]\n";
+            std::cout << "Usage: humpty_tests [--case|-c <all|splitter|joiner|roundtrip|urandom|parallel|checksums|manifest|resume|incremental|cdc|store|codec|stdio|range|verify|stats|progress|buffer>]\n";
             return 0;
         }
         std::cerr << "Unknown argument: " << token << "\n";
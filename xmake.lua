@@ -9,6 +9,9 @@ target("humpty_lib")
     add_files("src/**.cpp")
     remove_files("src/main.cpp")
     add_includedirs("src", {public = true})
+    if is_plat("linux") then
+        add_syslinks("pthread", {public = true})
+    end
 
 target("humpty")
     set_kind("binary")
@@ -21,3 +24,9 @@ target("humpty_tests")
     add_files("tests/**.cpp")
     add_deps("humpty_lib")
     add_includedirs("src", "tests")
+
+target("humpty_bench")
+    set_kind("binary")
+    add_files("bench/**.cpp")
+    add_deps("humpty_lib")
+    add_includedirs("src", "tests", "bench")